@@ -0,0 +1,66 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Allocator used when AGG_CUSTOM_ALLOCATOR is defined. It allocates the same
+// way as the default one (see agg_basics.h), but also counts allocations,
+// so it's possible to tell how many allocations an operation needs.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_ALLOCATOR_INCLUDED
+#define AGG_ALLOCATOR_INCLUDED
+
+#include <atomic>
+
+namespace agg
+{
+    //------------------------------------------------------allocation_counter
+    inline std::atomic<unsigned long long>& allocation_counter()
+    {
+        static std::atomic<unsigned long long> counter(0);
+        return counter;
+    }
+
+    //--------------------------------------------------------allocation_count
+    // Returns the number of allocations done by pod_allocator and
+    // obj_allocator so far (in all threads).
+    inline unsigned long long allocation_count()
+    {
+        return allocation_counter().load(std::memory_order_relaxed);
+    }
+
+    //------------------------------------------------------------pod_allocator
+    template<class T> struct pod_allocator
+    {
+        static T* allocate(unsigned num)
+        {
+            allocation_counter().fetch_add(1, std::memory_order_relaxed);
+            return new T [num];
+        }
+        static void deallocate(T* ptr, unsigned) { delete [] ptr; }
+    };
+
+    //------------------------------------------------------------obj_allocator
+    template<class T> struct obj_allocator
+    {
+        static T* allocate()
+        {
+            allocation_counter().fetch_add(1, std::memory_order_relaxed);
+            return new T;
+        }
+        static void deallocate(T* ptr) { delete ptr; }
+    };
+}
+
+#endif
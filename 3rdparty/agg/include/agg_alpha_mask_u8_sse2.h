@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Gray8 alpha masks (one byte per mask pixel) with vectorized horizontal
+// spans. scanline_u8_am calls combine_hspan() once per span, which is where
+// alpha_mask_u8 spends its time, one multiply per cover. Here the covers are
+// combined 16 at a time by SSE2 (with a scalar fallback):
+//
+//     cover = (255 + cover * mask) >> 8
+//
+// The results are identical to alpha_mask_gray8 and amask_no_clip_gray8,
+// both classes are drop-in replacements for them.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_ALPHA_MASK_U8_SSE2_INCLUDED
+#define AGG_ALPHA_MASK_U8_SSE2_INCLUDED
+
+#include <string.h>
+#include "agg_alpha_mask_u8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_ALPHA_MASK_U8_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //--------------------------------------------------alpha_mask_combine_u8
+    // covers[i] = (255 + covers[i] * mask[i]) >> 8, for i in [0, count).
+    inline void alpha_mask_combine_u8(int8u* covers, const int8u* mask, unsigned count)
+    {
+#ifdef AGG_ALPHA_MASK_U8_SSE2
+        __m128i zero = _mm_setzero_si128();
+        __m128i c255 = _mm_set1_epi16(255);
+
+        // 255 + 255 * 255 fits 16 bits, the shift is logical.
+        while(count >= 16)
+        {
+            __m128i c = _mm_loadu_si128((const __m128i*)covers);
+            __m128i m = _mm_loadu_si128((const __m128i*)mask);
+            __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(m, zero));
+            __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(m, zero));
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, c255), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, c255), 8);
+            _mm_storeu_si128((__m128i*)covers, _mm_packus_epi16(lo, hi));
+            covers += 16;
+            mask += 16;
+            count -= 16;
+        }
+
+        if(count >= 8)
+        {
+            __m128i c = _mm_loadl_epi64((const __m128i*)covers);
+            __m128i m = _mm_loadl_epi64((const __m128i*)mask);
+            __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(m, zero));
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, c255), 8);
+            _mm_storel_epi64((__m128i*)covers, _mm_packus_epi16(lo, lo));
+            covers += 8;
+            mask += 8;
+            count -= 8;
+        }
+#endif
+        while(count--)
+        {
+            *covers = int8u((255 + unsigned(*covers) * unsigned(*mask)) >> 8);
+            ++covers;
+            ++mask;
+        }
+    }
+
+
+    //---------------------------------------------------alpha_mask_gray8_sse2
+    // Clips to the mask buffer, pixels outside of it are 0.
+    class alpha_mask_gray8_sse2 : public alpha_mask_gray8
+    {
+    public:
+        typedef alpha_mask_gray8 base_type;
+
+        alpha_mask_gray8_sse2() : m_rbuf(0) {}
+        explicit alpha_mask_gray8_sse2(rendering_buffer& rbuf) :
+            base_type(rbuf), m_rbuf(&rbuf) {}
+
+        void attach(rendering_buffer& rbuf)
+        {
+            base_type::attach(rbuf);
+            m_rbuf = &rbuf;
+        }
+
+        //--------------------------------------------------------------------
+        void fill_hspan(int x, int y, cover_type* dst, int num_pix) const
+        {
+            int count = clip_hspan(x, y, dst, num_pix);
+            if(count) memcpy(dst + x_clipped(x) - x, m_rbuf->row_ptr(y) + x_clipped(x), count);
+        }
+
+        //--------------------------------------------------------------------
+        void combine_hspan(int x, int y, cover_type* dst, int num_pix) const
+        {
+            int count = clip_hspan(x, y, dst, num_pix);
+            if(count)
+            {
+                alpha_mask_combine_u8(dst + x_clipped(x) - x,
+                                      m_rbuf->row_ptr(y) + x_clipped(x),
+                                      unsigned(count));
+            }
+        }
+
+    private:
+        alpha_mask_gray8_sse2(const alpha_mask_gray8_sse2&);
+        const alpha_mask_gray8_sse2& operator = (const alpha_mask_gray8_sse2&);
+
+        static int x_clipped(int x) { return x < 0 ? 0 : x; }
+
+        //--------------------------------------------------------------------
+        // Zeroes the covers outside of the mask and returns the number of
+        // covers inside of it, which start at x_clipped(x).
+        int clip_hspan(int x, int y, cover_type* dst, int num_pix) const
+        {
+            int w = int(m_rbuf->width());
+            int x1 = x_clipped(x);
+            int x2 = x + num_pix < w ? x + num_pix : w;
+
+            if(y < 0 || y >= int(m_rbuf->height()) || x1 >= x2)
+            {
+                memset(dst, 0, num_pix * sizeof(cover_type));
+                return 0;
+            }
+
+            if(x1 > x) memset(dst, 0, (x1 - x) * sizeof(cover_type));
+            if(x2 < x + num_pix) memset(dst + x2 - x, 0, (x + num_pix - x2) * sizeof(cover_type));
+            return x2 - x1;
+        }
+
+        rendering_buffer* m_rbuf;
+    };
+
+
+    //-----------------------------------------------amask_no_clip_gray8_sse2
+    // The spans must be inside of the mask buffer.
+    class amask_no_clip_gray8_sse2 : public amask_no_clip_gray8
+    {
+    public:
+        typedef amask_no_clip_gray8 base_type;
+
+        amask_no_clip_gray8_sse2() : m_rbuf(0) {}
+        explicit amask_no_clip_gray8_sse2(rendering_buffer& rbuf) :
+            base_type(rbuf), m_rbuf(&rbuf) {}
+
+        void attach(rendering_buffer& rbuf)
+        {
+            base_type::attach(rbuf);
+            m_rbuf = &rbuf;
+        }
+
+        //--------------------------------------------------------------------
+        void fill_hspan(int x, int y, cover_type* dst, int num_pix) const
+        {
+            memcpy(dst, m_rbuf->row_ptr(y) + x, num_pix);
+        }
+
+        //--------------------------------------------------------------------
+        void combine_hspan(int x, int y, cover_type* dst, int num_pix) const
+        {
+            alpha_mask_combine_u8(dst, m_rbuf->row_ptr(y) + x, unsigned(num_pix));
+        }
+
+    private:
+        amask_no_clip_gray8_sse2(const amask_no_clip_gray8_sse2&);
+        const amask_no_clip_gray8_sse2& operator = (const amask_no_clip_gray8_sse2&);
+
+        rendering_buffer* m_rbuf;
+    };
+
+}
+
+#endif
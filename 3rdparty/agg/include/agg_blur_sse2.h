@@ -0,0 +1,237 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Stack blur of 32-bit RGBA images that keeps all 4 channel sums in a single
+// SSE2 register (with a scalar fallback). The result is identical to
+// stack_blur_rgba32() from agg_blur.h.
+//
+// The horizontal and vertical passes are exposed separately and work on a
+// range of rows or columns, so a caller can split each pass into bands and
+// run them in parallel (all bands of one pass must finish before the other
+// pass starts).
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_BLUR_SSE2_INCLUDED
+#define AGG_BLUR_SSE2_INCLUDED
+
+#include <string.h>
+#include "agg_array.h"
+#include "agg_blur.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_BLUR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //-------------------------------------------------stack_blur_line_rgba32
+    // Blurs len pixels starting at p, step bytes apart, in place. The stack
+    // must provide space for radius * 2 + 1 pixels.
+    inline void stack_blur_line_rgba32(int8u* p, int step, unsigned len,
+                                       unsigned radius, int32u* stack)
+    {
+        unsigned div = radius * 2 + 1;
+        unsigned lm = len - 1;
+        unsigned mul_sum = stack_blur_tables<int>::g_stack_blur8_mul[radius];
+        unsigned shr_sum = stack_blur_tables<int>::g_stack_blur8_shr[radius];
+        unsigned i, x, xp;
+
+        const int8u* src = p;
+        int8u* dst = p;
+
+#ifdef AGG_BLUR_SSE2
+        __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        __m128i sum_in = zero;
+        __m128i sum_out = zero;
+        __m128i mul = _mm_set1_epi32(int(mul_sum));
+        __m128i shr = _mm_cvtsi32_si128(int(shr_sum));
+
+        #define AGG_BLUR_UNPACK(v) \
+            _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(int(v)), zero), zero)
+
+        for(i = 0; i <= radius; i++)
+        {
+            int32u v;
+            memcpy(&v, src, 4);
+            stack[i] = v;
+
+            // Components and i + 1 both fit into 16 bits.
+            __m128i c = AGG_BLUR_UNPACK(v);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(c, _mm_set1_epi32(int(i + 1))));
+            sum_out = _mm_add_epi32(sum_out, c);
+        }
+        for(i = 1; i <= radius; i++)
+        {
+            if(i <= lm) src += step;
+
+            int32u v;
+            memcpy(&v, src, 4);
+            stack[i + radius] = v;
+
+            __m128i c = AGG_BLUR_UNPACK(v);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(c, _mm_set1_epi32(int(radius + 1 - i))));
+            sum_in = _mm_add_epi32(sum_in, c);
+        }
+#else
+        unsigned sum[4] = { 0 };
+        unsigned sum_in[4] = { 0 };
+        unsigned sum_out[4] = { 0 };
+        unsigned c;
+
+        for(i = 0; i <= radius; i++)
+        {
+            memcpy(&stack[i], src, 4);
+            for(c = 0; c < 4; c++)
+            {
+                sum[c] += src[c] * (i + 1);
+                sum_out[c] += src[c];
+            }
+        }
+        for(i = 1; i <= radius; i++)
+        {
+            if(i <= lm) src += step;
+            memcpy(&stack[i + radius], src, 4);
+            for(c = 0; c < 4; c++)
+            {
+                sum[c] += src[c] * (radius + 1 - i);
+                sum_in[c] += src[c];
+            }
+        }
+#endif
+
+        unsigned stack_ptr = radius;
+        xp = radius;
+        if(xp > lm) xp = lm;
+        src = p + int(xp) * step;
+
+        for(x = 0; x < len; x++)
+        {
+            unsigned stack_start = stack_ptr + div - radius;
+            if(stack_start >= div) stack_start -= div;
+
+#ifdef AGG_BLUR_SSE2
+            // (sum * mul_sum) >> shr_sum doesn't fit 32 bits in general, the
+            // products are computed in 64 bits, 2 components at a time.
+            __m128i lo = _mm_srl_epi64(_mm_mul_epu32(sum, mul), shr);
+            __m128i hi = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(sum, 32), mul), shr);
+            __m128i r  = _mm_or_si128(lo, _mm_slli_epi64(hi, 32));
+            r = _mm_packs_epi32(r, r);
+            int32u v = int32u(_mm_cvtsi128_si32(_mm_packus_epi16(r, r)));
+            memcpy(dst, &v, 4);
+            dst += step;
+
+            sum = _mm_sub_epi32(sum, sum_out);
+            sum_out = _mm_sub_epi32(sum_out, AGG_BLUR_UNPACK(stack[stack_start]));
+
+            if(xp < lm)
+            {
+                src += step;
+                ++xp;
+            }
+
+            memcpy(&v, src, 4);
+            stack[stack_start] = v;
+            sum_in = _mm_add_epi32(sum_in, AGG_BLUR_UNPACK(v));
+            sum = _mm_add_epi32(sum, sum_in);
+
+            if(++stack_ptr >= div) stack_ptr = 0;
+            __m128i s = AGG_BLUR_UNPACK(stack[stack_ptr]);
+            sum_out = _mm_add_epi32(sum_out, s);
+            sum_in = _mm_sub_epi32(sum_in, s);
+#else
+            for(c = 0; c < 4; c++)
+            {
+                dst[c] = int8u((sum[c] * mul_sum) >> shr_sum);
+                sum[c] -= sum_out[c];
+            }
+            dst += step;
+
+            const int8u* s = (const int8u*)&stack[stack_start];
+            for(c = 0; c < 4; c++) sum_out[c] -= s[c];
+
+            if(xp < lm)
+            {
+                src += step;
+                ++xp;
+            }
+
+            memcpy(&stack[stack_start], src, 4);
+            for(c = 0; c < 4; c++)
+            {
+                sum_in[c] += src[c];
+                sum[c] += sum_in[c];
+            }
+
+            if(++stack_ptr >= div) stack_ptr = 0;
+            s = (const int8u*)&stack[stack_ptr];
+            for(c = 0; c < 4; c++)
+            {
+                sum_out[c] += s[c];
+                sum_in[c] -= s[c];
+            }
+#endif
+        }
+
+#ifdef AGG_BLUR_SSE2
+        #undef AGG_BLUR_UNPACK
+#endif
+    }
+
+    //-------------------------------------------------stack_blur_rgba32_x_sse2
+    // Horizontal pass over rows [y1, y2).
+    template<class Img>
+    void stack_blur_rgba32_x_sse2(Img& img, unsigned rx, unsigned y1, unsigned y2)
+    {
+        if(rx == 0 || img.width() == 0) return;
+        if(rx > 254) rx = 254;
+
+        pod_array<int32u> stack(rx * 2 + 1);
+        for(unsigned y = y1; y < y2; y++)
+        {
+            stack_blur_line_rgba32(img.pix_ptr(0, y), Img::pix_width,
+                                   img.width(), rx, &stack[0]);
+        }
+    }
+
+    //-------------------------------------------------stack_blur_rgba32_y_sse2
+    // Vertical pass over columns [x1, x2).
+    template<class Img>
+    void stack_blur_rgba32_y_sse2(Img& img, unsigned ry, unsigned x1, unsigned x2)
+    {
+        if(ry == 0 || img.height() == 0) return;
+        if(ry > 254) ry = 254;
+
+        pod_array<int32u> stack(ry * 2 + 1);
+        for(unsigned x = x1; x < x2; x++)
+        {
+            stack_blur_line_rgba32(img.pix_ptr(x, 0), img.stride(),
+                                   img.height(), ry, &stack[0]);
+        }
+    }
+
+    //---------------------------------------------------stack_blur_rgba32_sse2
+    template<class Img>
+    void stack_blur_rgba32_sse2(Img& img, unsigned rx, unsigned ry)
+    {
+        stack_blur_rgba32_x_sse2(img, rx, 0, img.height());
+        stack_blur_rgba32_y_sse2(img, ry, 0, img.width());
+    }
+
+}
+
+#endif
@@ -32,6 +32,28 @@ namespace agg
     };
 
 
+    //---------------------------------------------------------------vcgen_ref
+    // Forwards the generator interface to an external generator. It allows
+    // to create conv_adaptor_vcgen per path while keeping one generator, and
+    // its vertex storage, alive for all of them.
+    template<class Generator> class vcgen_ref
+    {
+    public:
+        vcgen_ref() : m_generator(0) {}
+        explicit vcgen_ref(Generator& g) : m_generator(&g) {}
+        void attach(Generator& g) { m_generator = &g; }
+
+        void remove_all() { m_generator->remove_all(); }
+        void add_vertex(double x, double y, unsigned cmd) { m_generator->add_vertex(x, y, cmd); }
+
+        void rewind(unsigned path_id) { m_generator->rewind(path_id); }
+        unsigned vertex(double* x, double* y) { return m_generator->vertex(x, y); }
+
+    private:
+        Generator* m_generator;
+    };
+
+
     //------------------------------------------------------conv_adaptor_vcgen
     template<class VertexSource, 
              class Generator, 
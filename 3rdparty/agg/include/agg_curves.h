@@ -28,7 +28,8 @@ namespace agg
     enum curve_approximation_method_e
     {
         curve_inc,
-        curve_div
+        curve_div,
+        curve_fd
     };
     
     //--------------------------------------------------------------curve3_inc
@@ -163,6 +164,72 @@ namespace agg
 
 
 
+    //--------------------------------------------------------------curve3_fd
+    // Flattens the curve into uniformly spaced steps. The number of steps is
+    // estimated up-front by Wang's formula, so the distance to the real curve
+    // never exceeds the tolerance (0.5 / approximation_scale), and the points
+    // are evaluated by forward differencing (x and y at once if SSE2 is
+    // available). Angle tolerance and cusp limit are not used.
+    class curve3_fd
+    {
+    public:
+        curve3_fd() :
+            m_approximation_scale(1.0),
+            m_count(0)
+        {}
+
+        curve3_fd(double x1, double y1, 
+                  double x2, double y2, 
+                  double x3, double y3) :
+            m_approximation_scale(1.0),
+            m_count(0)
+        { 
+            init(x1, y1, x2, y2, x3, y3);
+        }
+
+        void reset() { m_points.clear(); m_count = 0; }
+        void init(double x1, double y1, 
+                  double x2, double y2, 
+                  double x3, double y3);
+
+        void approximation_method(curve_approximation_method_e) {}
+        curve_approximation_method_e approximation_method() const { return curve_fd; }
+
+        void approximation_scale(double s) { m_approximation_scale = s; }
+        double approximation_scale() const { return m_approximation_scale;  }
+
+        void angle_tolerance(double) {}
+        double angle_tolerance() const { return 0.0; }
+
+        void cusp_limit(double) {}
+        double cusp_limit() const { return 0.0; }
+
+        void rewind(unsigned)
+        {
+            m_count = 0;
+        }
+
+        unsigned vertex(double* x, double* y)
+        {
+            if(m_count >= m_points.size()) return path_cmd_stop;
+            const point_d& p = m_points[m_count++];
+            *x = p.x;
+            *y = p.y;
+            return (m_count == 1) ? path_cmd_move_to : path_cmd_line_to;
+        }
+
+    private:
+        double              m_approximation_scale;
+        unsigned            m_count;
+        pod_vector<point_d> m_points;
+    };
+
+
+
+
+
+
+
     //-------------------------------------------------------------curve4_points
     struct curve4_points
     {
@@ -470,6 +537,77 @@ namespace agg
     };
 
 
+    //-------------------------------------------------------------curve4_fd
+    // See curve3_fd.
+    class curve4_fd
+    {
+    public:
+        curve4_fd() : 
+            m_approximation_scale(1.0),
+            m_count(0)
+        {}
+
+        curve4_fd(double x1, double y1, 
+                  double x2, double y2, 
+                  double x3, double y3,
+                  double x4, double y4) :
+            m_approximation_scale(1.0),
+            m_count(0)
+        { 
+            init(x1, y1, x2, y2, x3, y3, x4, y4);
+        }
+
+        curve4_fd(const curve4_points& cp) :
+            m_approximation_scale(1.0),
+            m_count(0)
+        { 
+            init(cp[0], cp[1], cp[2], cp[3], cp[4], cp[5], cp[6], cp[7]);
+        }
+
+        void reset() { m_points.clear(); m_count = 0; }
+        void init(double x1, double y1, 
+                  double x2, double y2, 
+                  double x3, double y3,
+                  double x4, double y4);
+
+        void init(const curve4_points& cp)
+        {
+            init(cp[0], cp[1], cp[2], cp[3], cp[4], cp[5], cp[6], cp[7]);
+        }
+
+        void approximation_method(curve_approximation_method_e) {}
+        curve_approximation_method_e approximation_method() const { return curve_fd; }
+
+        void approximation_scale(double s) { m_approximation_scale = s; }
+        double approximation_scale() const { return m_approximation_scale;  }
+
+        void angle_tolerance(double) {}
+        double angle_tolerance() const { return 0.0; }
+
+        void cusp_limit(double) {}
+        double cusp_limit() const { return 0.0; }
+
+        void rewind(unsigned)
+        {
+            m_count = 0;
+        }
+
+        unsigned vertex(double* x, double* y)
+        {
+            if(m_count >= m_points.size()) return path_cmd_stop;
+            const point_d& p = m_points[m_count++];
+            *x = p.x;
+            *y = p.y;
+            return (m_count == 1) ? path_cmd_move_to : path_cmd_line_to;
+        }
+
+    private:
+        double              m_approximation_scale;
+        unsigned            m_count;
+        pod_vector<point_d> m_points;
+    };
+
+
     //-----------------------------------------------------------------curve3
     class curve3
     {
@@ -487,6 +625,7 @@ namespace agg
         { 
             m_curve_inc.reset();
             m_curve_div.reset();
+            m_curve_fd.reset();
         }
 
         void init(double x1, double y1, 
@@ -498,6 +637,11 @@ namespace agg
                 m_curve_inc.init(x1, y1, x2, y2, x3, y3);
             }
             else
+            if(m_approximation_method == curve_fd) 
+            {
+                m_curve_fd.init(x1, y1, x2, y2, x3, y3);
+            }
+            else
             {
                 m_curve_div.init(x1, y1, x2, y2, x3, y3);
             }
@@ -517,6 +661,7 @@ namespace agg
         { 
             m_curve_inc.approximation_scale(s);
             m_curve_div.approximation_scale(s);
+            m_curve_fd.approximation_scale(s);
         }
 
         double approximation_scale() const 
@@ -551,6 +696,11 @@ namespace agg
                 m_curve_inc.rewind(path_id);
             }
             else
+            if(m_approximation_method == curve_fd) 
+            {
+                m_curve_fd.rewind(path_id);
+            }
+            else
             {
                 m_curve_div.rewind(path_id);
             }
@@ -562,12 +712,17 @@ namespace agg
             {
                 return m_curve_inc.vertex(x, y);
             }
+            if(m_approximation_method == curve_fd) 
+            {
+                return m_curve_fd.vertex(x, y);
+            }
             return m_curve_div.vertex(x, y);
         }
 
     private:
         curve3_inc m_curve_inc;
         curve3_div m_curve_div;
+        curve3_fd  m_curve_fd;
         curve_approximation_method_e m_approximation_method;
     };
 
@@ -599,6 +754,7 @@ namespace agg
         { 
             m_curve_inc.reset();
             m_curve_div.reset();
+            m_curve_fd.reset();
         }
 
         void init(double x1, double y1, 
@@ -611,6 +767,11 @@ namespace agg
                 m_curve_inc.init(x1, y1, x2, y2, x3, y3, x4, y4);
             }
             else
+            if(m_approximation_method == curve_fd) 
+            {
+                m_curve_fd.init(x1, y1, x2, y2, x3, y3, x4, y4);
+            }
+            else
             {
                 m_curve_div.init(x1, y1, x2, y2, x3, y3, x4, y4);
             }
@@ -635,6 +796,7 @@ namespace agg
         { 
             m_curve_inc.approximation_scale(s);
             m_curve_div.approximation_scale(s);
+            m_curve_fd.approximation_scale(s);
         }
         double approximation_scale() const { return m_curve_inc.approximation_scale(); }
 
@@ -665,6 +827,11 @@ namespace agg
                 m_curve_inc.rewind(path_id);
             }
             else
+            if(m_approximation_method == curve_fd) 
+            {
+                m_curve_fd.rewind(path_id);
+            }
+            else
             {
                 m_curve_div.rewind(path_id);
             }
@@ -676,12 +843,17 @@ namespace agg
             {
                 return m_curve_inc.vertex(x, y);
             }
+            if(m_approximation_method == curve_fd) 
+            {
+                return m_curve_fd.vertex(x, y);
+            }
             return m_curve_div.vertex(x, y);
         }
 
     private:
         curve4_inc m_curve_inc;
         curve4_div m_curve_div;
+        curve4_fd  m_curve_fd;
         curve_approximation_method_e m_approximation_method;
     };
 
@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Gamma correction of coverage values in bulk. rasterizer_scanline_aa looks
+// up every cover in its gamma table as cells are swept. Here the gamma is
+// applied to the covers of a whole scanline after it has been swept by
+// rasterizer_scanline_aa_nogamma, 16 covers at a time:
+//
+//     cover = uround(pow(cover / 255, gamma) * 255)
+//
+// The SSE2 version computes the power as exp2(gamma * log2(x)) by short
+// polynomials, without a table. The result matches gamma_power applied by
+// rasterizer_scanline_aa, except for rare values that are very close to
+// a rounding boundary, which can differ by 1.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_GAMMA_COVERS_SSE2_INCLUDED
+#define AGG_GAMMA_COVERS_SSE2_INCLUDED
+
+#include <math.h>
+#include "agg_basics.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_GAMMA_COVERS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //--------------------------------------------------gamma_power_covers_sse2
+    class gamma_power_covers_sse2
+    {
+    public:
+        explicit gamma_power_covers_sse2(double g=1.0) { gamma(g); }
+
+        void gamma(double g)
+        {
+            m_gamma = g;
+            for(unsigned i = 0; i < 256; i++)
+            {
+                m_table[i] = int8u(uround(pow(double(i) / 255.0, g) * 255.0));
+            }
+        }
+
+        double gamma() const { return m_gamma; }
+
+        // Scalar reference, the same as the gamma table of the rasterizer.
+        int8u operator [] (unsigned cover) const { return m_table[cover]; }
+
+        //--------------------------------------------------------------------
+        void apply(int8u* covers, unsigned len) const
+        {
+#ifdef AGG_GAMMA_COVERS_SSE2
+            if(m_gamma == 1.0) return;
+
+            __m128i zero = _mm_setzero_si128();
+            __m128  g    = _mm_set1_ps(float(m_gamma));
+
+            while(len >= 16)
+            {
+                __m128i c   = _mm_loadu_si128((const __m128i*)covers);
+                __m128i c16 = _mm_unpacklo_epi8(c, zero);
+                __m128i r0  = _mm_packs_epi32(pow4(_mm_unpacklo_epi16(c16, zero), g),
+                                              pow4(_mm_unpackhi_epi16(c16, zero), g));
+                c16 = _mm_unpackhi_epi8(c, zero);
+                __m128i r1  = _mm_packs_epi32(pow4(_mm_unpacklo_epi16(c16, zero), g),
+                                              pow4(_mm_unpackhi_epi16(c16, zero), g));
+                _mm_storeu_si128((__m128i*)covers, _mm_packus_epi16(r0, r1));
+                covers += 16;
+                len -= 16;
+            }
+#endif
+            while(len--)
+            {
+                *covers = m_table[*covers];
+                covers++;
+            }
+        }
+
+    private:
+#ifdef AGG_GAMMA_COVERS_SSE2
+        //--------------------------------------------------------------------
+        // Four 32-bit covers in, four 32-bit gamma corrected covers out.
+        static __m128i pow4(__m128i c, __m128 g)
+        {
+            __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(1.0f / 255.0f));
+
+            // log2(x) = e + log2(m), m in [sqrt(0.5), sqrt(2)).
+            __m128i xi = _mm_castps_si128(x);
+            __m128i e  = _mm_sub_epi32(_mm_srli_epi32(xi, 23), _mm_set1_epi32(127));
+            __m128  m  = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(xi, _mm_set1_epi32(0x007FFFFF)),
+                                                       _mm_set1_epi32(0x3F800000)));
+            __m128  big = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+            m = _mm_sub_ps(m, _mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))));
+            e = _mm_sub_epi32(e, _mm_castps_si128(big));
+
+            // ln(m) = 2 * atanh(t), t = (m - 1) / (m + 1), |t| < 0.172.
+            __m128 t  = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+            __m128 t2 = _mm_mul_ps(t, t);
+            __m128 p  = _mm_add_ps(_mm_mul_ps(t2, _mm_set1_ps(1.0f / 7.0f)), _mm_set1_ps(1.0f / 5.0f));
+            p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f / 3.0f));
+            p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f));
+            __m128 l = _mm_add_ps(_mm_cvtepi32_ps(e),
+                                  _mm_mul_ps(_mm_mul_ps(p, t), _mm_set1_ps(2.88539008f))); // 2 / ln(2)
+
+            // exp2(y) = 2^n * exp(f * ln(2)), f in [-0.5, 0.5].
+            __m128  y = _mm_max_ps(_mm_mul_ps(l, g), _mm_set1_ps(-100.0f));
+            __m128i n = _mm_cvtps_epi32(y);
+            __m128  f = _mm_mul_ps(_mm_sub_ps(y, _mm_cvtepi32_ps(n)), _mm_set1_ps(0.69314718f));
+            __m128  q = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(1.0f / 720.0f)), _mm_set1_ps(1.0f / 120.0f));
+            q = _mm_add_ps(_mm_mul_ps(q, f), _mm_set1_ps(1.0f / 24.0f));
+            q = _mm_add_ps(_mm_mul_ps(q, f), _mm_set1_ps(1.0f / 6.0f));
+            q = _mm_add_ps(_mm_mul_ps(q, f), _mm_set1_ps(0.5f));
+            q = _mm_add_ps(_mm_mul_ps(q, f), _mm_set1_ps(1.0f));
+            q = _mm_add_ps(_mm_mul_ps(q, f), _mm_set1_ps(1.0f));
+
+            // 2^n by the exponent bits, n < -126 flushes to zero.
+            __m128i nb = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+            __m128  sc = _mm_and_ps(_mm_castsi128_ps(nb),
+                                    _mm_castsi128_ps(_mm_cmpgt_epi32(n, _mm_set1_epi32(-127))));
+            __m128  r  = _mm_mul_ps(_mm_mul_ps(q, sc), _mm_set1_ps(255.0f));
+
+            // Cover 0 stays 0 (log2 of 0 isn't finite).
+            __m128i ri = _mm_cvttps_epi32(_mm_add_ps(r, _mm_set1_ps(0.5f)));
+            return _mm_andnot_si128(_mm_cmpeq_epi32(c, _mm_setzero_si128()), ri);
+        }
+#endif
+
+        double m_gamma;
+        int8u  m_table[256];
+    };
+
+
+    //-----------------------------------------------------rasterizer_gamma_covers
+    // Scanline source adaptor that applies GammaCovers to all covers of each
+    // swept scanline. The scanline must own its covers (scanline_p8,
+    // scanline_u8, ...), the covers of a scanline are stored in a single
+    // array, so they are processed as one block.
+    template<class Rasterizer, class GammaCovers> class rasterizer_gamma_covers
+    {
+    public:
+        rasterizer_gamma_covers(Rasterizer& ras, const GammaCovers& gamma) :
+            m_ras(&ras), m_gamma(&gamma) {}
+
+        bool rewind_scanlines() { return m_ras->rewind_scanlines(); }
+
+        int min_x() const { return m_ras->min_x(); }
+        int min_y() const { return m_ras->min_y(); }
+        int max_x() const { return m_ras->max_x(); }
+        int max_y() const { return m_ras->max_y(); }
+
+        template<class Scanline> bool sweep_scanline(Scanline& sl)
+        {
+            if(!m_ras->sweep_scanline(sl)) return false;
+
+            unsigned num_spans = sl.num_spans();
+            typename Scanline::const_iterator span = sl.begin();
+            const int8u* first = span->covers;
+
+            // A solid span (negative length) keeps a single cover.
+            span += num_spans - 1;
+            const int8u* last = span->covers + (span->len < 0 ? 1 : span->len);
+
+            m_gamma->apply(const_cast<int8u*>(first), unsigned(last - first));
+            return true;
+        }
+
+    private:
+        Rasterizer*        m_ras;
+        const GammaCovers* m_gamma;
+    };
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Glyph cache that can be shared by several rendering threads. Unlike
+// font_cache from agg_font_cache_manager.h it doesn't belong to a single
+// font engine, glyphs are identified by a font id (see glyph_font_id()) and
+// a glyph code.
+//
+// Glyph records are immutable once inserted and stay alive until the cache
+// is destroyed. The table uses open addressing with linear probing, slots
+// are atomic pointers that change only once (from null to a record), so
+// find_glyph() never locks and never retries. If two threads insert the
+// same glyph at the same time the first one wins and the other one gets
+// the winner's record back (its own record is destroyed).
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_GLYPH_CACHE_SHARED_INCLUDED
+#define AGG_GLYPH_CACHE_SHARED_INCLUDED
+
+#include <atomic>
+#include <new>
+#include <string.h>
+#include "agg_font_cache_manager.h"
+
+namespace agg
+{
+
+    //----------------------------------------------------------glyph_font_id
+    // Hashes a font signature (font name, size, hinting, ...) to a font id.
+    inline int32u glyph_font_id(const char* font_signature)
+    {
+        int32u h = 2166136261u;
+        while(*font_signature)
+        {
+            h ^= int8u(*font_signature++);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+
+    //-----------------------------------------------------------shared_glyph
+    struct shared_glyph
+    {
+        int32u          font_id;
+        unsigned        glyph_code;
+        unsigned        glyph_index;
+        int8u*          data;
+        unsigned        data_size;
+        glyph_data_type data_type;
+        rect_i          bounds;
+        double          advance_x;
+        double          advance_y;
+    };
+
+
+    //-----------------------------------------------------glyph_cache_shared
+    class glyph_cache_shared
+    {
+    public:
+        //--------------------------------------------------------------------
+        ~glyph_cache_shared()
+        {
+            for(unsigned i = 0; i < m_capacity; i++)
+            {
+                destroy_glyph(m_slots[i].load(std::memory_order_relaxed));
+            }
+            delete [] m_slots;
+        }
+
+        //--------------------------------------------------------------------
+        // The capacity is rounded up to a power of 2. At most 3/4 of it is
+        // used, inserts fail when the table is full.
+        explicit glyph_cache_shared(unsigned capacity=4096) :
+            m_capacity(16),
+            m_num_glyphs(0),
+            m_memory_size(0)
+        {
+            while(m_capacity < capacity) m_capacity <<= 1;
+            m_max_glyphs = m_capacity - m_capacity / 4;
+            m_slots = new std::atomic<shared_glyph*>[m_capacity];
+            for(unsigned i = 0; i < m_capacity; i++)
+            {
+                m_slots[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Lock-free, can be called from any thread at any time.
+        const shared_glyph* find_glyph(int32u font_id, unsigned glyph_code) const
+        {
+            unsigned mask = m_capacity - 1;
+            unsigned i = hash(font_id, glyph_code) & mask;
+            for(;;)
+            {
+                const shared_glyph* gl = m_slots[i].load(std::memory_order_acquire);
+                if(gl == 0) return 0;
+                if(gl->font_id == font_id && gl->glyph_code == glyph_code) return gl;
+                i = (i + 1) & mask;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        // Allocates a glyph record with data_size bytes of data that is not
+        // visible to other threads until it's passed to insert_glyph().
+        static shared_glyph* create_glyph(int32u          font_id,
+                                          unsigned        glyph_code,
+                                          unsigned        glyph_index,
+                                          unsigned        data_size,
+                                          glyph_data_type data_type,
+                                          const rect_i&   bounds,
+                                          double          advance_x,
+                                          double          advance_y)
+        {
+            int8u* mem = new int8u[sizeof(shared_glyph) + data_size];
+            shared_glyph* glyph = new(mem) shared_glyph;
+
+            glyph->font_id     = font_id;
+            glyph->glyph_code  = glyph_code;
+            glyph->glyph_index = glyph_index;
+            glyph->data        = mem + sizeof(shared_glyph);
+            glyph->data_size   = data_size;
+            glyph->data_type   = data_type;
+            glyph->bounds      = bounds;
+            glyph->advance_x   = advance_x;
+            glyph->advance_y   = advance_y;
+            return glyph;
+        }
+
+        //--------------------------------------------------------------------
+        static void destroy_glyph(shared_glyph* glyph)
+        {
+            if(glyph) delete [] (int8u*)glyph;
+        }
+
+        //--------------------------------------------------------------------
+        // Publishes a record created by create_glyph() and takes its
+        // ownership. Returns the record that is in the cache, which is not
+        // the given one if another thread inserted the same glyph first.
+        // Returns 0 if the cache is full, the record is still owned by the
+        // caller in that case.
+        const shared_glyph* insert_glyph(shared_glyph* glyph)
+        {
+            unsigned mask = m_capacity - 1;
+            unsigned i = hash(glyph->font_id, glyph->glyph_code) & mask;
+            for(;;)
+            {
+                shared_glyph* gl = m_slots[i].load(std::memory_order_acquire);
+                if(gl == 0)
+                {
+                    if(m_num_glyphs.fetch_add(1, std::memory_order_relaxed) >= m_max_glyphs)
+                    {
+                        m_num_glyphs.fetch_sub(1, std::memory_order_relaxed);
+                        return 0;
+                    }
+
+                    if(m_slots[i].compare_exchange_strong(gl, glyph,
+                                                          std::memory_order_acq_rel,
+                                                          std::memory_order_acquire))
+                    {
+                        m_memory_size.fetch_add(sizeof(shared_glyph) + glyph->data_size,
+                                                std::memory_order_relaxed);
+                        return glyph;
+                    }
+
+                    // Lost the slot, gl is now what the other thread stored.
+                    m_num_glyphs.fetch_sub(1, std::memory_order_relaxed);
+                }
+
+                if(gl->font_id == glyph->font_id && gl->glyph_code == glyph->glyph_code)
+                {
+                    destroy_glyph(glyph);
+                    return gl;
+                }
+                i = (i + 1) & mask;
+            }
+        }
+
+        //--------------------------------------------------------------------
+        unsigned capacity() const { return m_capacity; }
+        unsigned num_glyphs() const { return m_num_glyphs.load(std::memory_order_relaxed); }
+
+        // Size of all glyph records and their data in bytes (the table
+        // itself is not included).
+        size_t memory_size() const { return m_memory_size.load(std::memory_order_relaxed); }
+
+    private:
+        //--------------------------------------------------------------------
+        glyph_cache_shared(const glyph_cache_shared&);
+        const glyph_cache_shared& operator = (const glyph_cache_shared&);
+
+        //--------------------------------------------------------------------
+        static unsigned hash(int32u font_id, unsigned glyph_code)
+        {
+            int32u h = font_id ^ (int32u(glyph_code) * 0x9E3779B1u);
+            h ^= h >> 16;
+            h *= 0x85EBCA6Bu;
+            h ^= h >> 13;
+            return h;
+        }
+
+        std::atomic<shared_glyph*>* m_slots;
+        unsigned                    m_capacity;
+        unsigned                    m_max_glyphs;
+        std::atomic<unsigned>       m_num_glyphs;
+        std::atomic<size_t>         m_memory_size;
+    };
+
+}
+
+#endif
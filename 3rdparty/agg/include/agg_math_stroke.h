@@ -73,7 +73,7 @@ namespace agg
         void miter_limit(double ml) { m_miter_limit = ml; }
         void miter_limit_theta(double t);
         void inner_miter_limit(double ml) { m_inner_miter_limit = ml; }
-        void approximation_scale(double as) { m_approx_scale = as; }
+        void approximation_scale(double as) { m_approx_scale = as; calc_arc_step(); }
 
         double width() const { return m_width * 2.0; }
         double miter_limit() const { return m_miter_limit; }
@@ -93,6 +93,8 @@ namespace agg
                        double len2);
 
     private:
+        void calc_arc_step();
+
         AGG_INLINE void add_vertex(VertexConsumer& vc, double x, double y)
         {
             vc.add(coord_type(x, y));
@@ -120,6 +122,10 @@ namespace agg
         double       m_miter_limit;
         double       m_inner_miter_limit;
         double       m_approx_scale;
+        double       m_arc_step;
+        int          m_cap_steps;
+        double       m_cap_cos;
+        double       m_cap_sin;
         line_cap_e   m_line_cap;
         line_join_e  m_line_join;
         inner_join_e m_inner_join;
@@ -138,6 +144,7 @@ namespace agg
         m_line_join(miter_join),
         m_inner_join(inner_miter)
     {
+        calc_arc_step();
     }
 
     //-----------------------------------------------------------------------
@@ -155,6 +162,21 @@ namespace agg
             m_width_sign = 1;
         }
         m_width_eps = m_width / 1024.0;
+        calc_arc_step();
+    }
+
+    //-----------------------------------------------------------------------
+    // Round joins and caps are generated by rotating the offset vector, the
+    // angle step only depends on the width and the approximation scale, so
+    // it's calculated once here instead of for every join and cap.
+    template<class VC> void math_stroke<VC>::calc_arc_step()
+    { 
+        m_arc_step = acos(m_width_abs / (m_width_abs + 0.125 / m_approx_scale)) * 2;
+        m_cap_steps = int(pi / m_arc_step);
+
+        double da = pi / (m_cap_steps + 1);
+        m_cap_cos = cos(da);
+        m_cap_sin = sin(da) * m_width_sign;
     }
 
     //-----------------------------------------------------------------------
@@ -170,37 +192,28 @@ namespace agg
                                    double dx1, double dy1, 
                                    double dx2, double dy2)
     {
-        double a1 = atan2(dy1 * m_width_sign, dx1 * m_width_sign);
-        double a2 = atan2(dy2 * m_width_sign, dx2 * m_width_sign);
-        double da = a1 - a2;
-        int i, n;
+        // Angle swept from (dx1, dy1) to (dx2, dy2), counter-clockwise
+        // for positive widths and clockwise for negative ones.
+        double da = atan2((dx1 * dy2 - dy1 * dx2) * m_width_sign, 
+                          dx1 * dx2 + dy1 * dy2);
+        if(da < 0) da += 2 * pi;
+
+        int i;
+        int n = int(da / m_arc_step);
 
-        da = acos(m_width_abs / (m_width_abs + 0.125 / m_approx_scale)) * 2;
+        da /= n + 1;
+        double rc = cos(da);
+        double rs = sin(da) * m_width_sign;
+        double px = dx1;
+        double py = dy1;
 
         add_vertex(vc, x + dx1, y + dy1);
-        if(m_width_sign > 0)
-        {
-            if(a1 > a2) a2 += 2 * pi;
-            n = int((a2 - a1) / da);
-            da = (a2 - a1) / (n + 1);
-            a1 += da;
-            for(i = 0; i < n; i++)
-            {
-                add_vertex(vc, x + cos(a1) * m_width, y + sin(a1) * m_width);
-                a1 += da;
-            }
-        }
-        else
+        for(i = 0; i < n; i++)
         {
-            if(a1 < a2) a2 -= 2 * pi;
-            n = int((a1 - a2) / da);
-            da = (a1 - a2) / (n + 1);
-            a1 -= da;
-            for(i = 0; i < n; i++)
-            {
-                add_vertex(vc, x + cos(a1) * m_width, y + sin(a1) * m_width);
-                a1 -= da;
-            }
+            double t = px * rc - py * rs;
+            py = px * rs + py * rc;
+            px = t;
+            add_vertex(vc, x + px, y + py);
         }
         add_vertex(vc, x + dx2, y + dy2);
     }
@@ -341,34 +354,17 @@ namespace agg
         }
         else
         {
-            double da = acos(m_width_abs / (m_width_abs + 0.125 / m_approx_scale)) * 2;
-            double a1;
             int i;
-            int n = int(pi / da);
+            double px = -dx1;
+            double py =  dy1;
 
-            da = pi / (n + 1);
-            add_vertex(vc, v0.x - dx1, v0.y + dy1);
-            if(m_width_sign > 0)
-            {
-                a1 = atan2(dy1, -dx1);
-                a1 += da;
-                for(i = 0; i < n; i++)
-                {
-                    add_vertex(vc, v0.x + cos(a1) * m_width, 
-                                   v0.y + sin(a1) * m_width);
-                    a1 += da;
-                }
-            }
-            else
+            add_vertex(vc, v0.x + px, v0.y + py);
+            for(i = 0; i < m_cap_steps; i++)
             {
-                a1 = atan2(-dy1, dx1);
-                a1 -= da;
-                for(i = 0; i < n; i++)
-                {
-                    add_vertex(vc, v0.x + cos(a1) * m_width, 
-                                   v0.y + sin(a1) * m_width);
-                    a1 -= da;
-                }
+                double t = px * m_cap_cos - py * m_cap_sin;
+                py = px * m_cap_sin + py * m_cap_cos;
+                px = t;
+                add_vertex(vc, v0.x + px, v0.y + py);
             }
             add_vertex(vc, v0.x + dx1, v0.y - dy1);
         }
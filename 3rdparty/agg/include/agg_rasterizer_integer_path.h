@@ -0,0 +1,99 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Feeds integer paths to a rasterizer without going through doubles.
+//
+// rasterizer_scanline_aa::add_path() takes double vertices, even from
+// path_storage_integer and serialized_integer_path_adaptor, and converts
+// each of them back by iround(v * poly_subpixel_scale). Paths that are
+// already quantized (map tiles, fonts stored as integers, ...) can be added
+// by the integer move_to() and line_to() of the rasterizer instead, which
+// take subpixel coordinates as they are when the rasterizer uses
+// rasterizer_sl_clip_int (the default).
+//
+// Only polygons are supported, curve control points are added as line_to.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_RASTERIZER_INTEGER_PATH_INCLUDED
+#define AGG_RASTERIZER_INTEGER_PATH_INCLUDED
+
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_path_storage_integer.h"
+
+namespace agg
+{
+
+    //-------------------------------------------------integer_to_subpixel
+    template<unsigned CoordShift> inline int integer_to_subpixel(int v)
+    {
+        return CoordShift >= unsigned(poly_subpixel_shift) ?
+            v >> (CoordShift - poly_subpixel_shift) :
+            v << (poly_subpixel_shift - CoordShift);
+    }
+
+    //-----------------------------------------------add_integer_vertices
+    // Adds num vertices of a path_storage_integer<T, CoordShift> (as
+    // serialized) translated by dx, dy subpixels. Each move_to starts a new
+    // polygon, the previous one is closed by the rasterizer.
+    template<class Rasterizer, class T, unsigned CoordShift>
+    void add_integer_vertices(Rasterizer& ras,
+                              const vertex_integer<T, CoordShift>* vertices,
+                              unsigned num, int dx, int dy)
+    {
+        for(unsigned i = 0; i < num; i++)
+        {
+            T vx = vertices[i].x;
+            T vy = vertices[i].y;
+            int x = integer_to_subpixel<CoordShift>(int(vx >> 1)) + dx;
+            int y = integer_to_subpixel<CoordShift>(int(vy >> 1)) + dy;
+
+            if((((vy & 1) << 1) | (vx & 1)) == vertex_integer<T, CoordShift>::cmd_move_to)
+            {
+                ras.move_to(x, y);
+            }
+            else
+            {
+                ras.line_to(x, y);
+            }
+        }
+    }
+
+    //-------------------------------------------add_serialized_integer_path
+    // Adds data written by path_storage_integer<T, CoordShift>::serialize().
+    template<class T, unsigned CoordShift, class Rasterizer>
+    void add_serialized_integer_path(Rasterizer& ras,
+                                     const int8u* data, unsigned size,
+                                     int dx, int dy)
+    {
+        typedef vertex_integer<T, CoordShift> vertex_type;
+
+        vertex_type v[64];
+        unsigned num = size / sizeof(vertex_type);
+
+        // The data doesn't have to be aligned, it's copied in chunks.
+        while(num)
+        {
+            unsigned n = num < 64 ? num : 64;
+            memcpy(v, data, n * sizeof(vertex_type));
+            add_integer_vertices(ras, v, n, dx, dy);
+            data += n * sizeof(vertex_type);
+            num -= n;
+        }
+    }
+
+}
+
+#endif
@@ -148,6 +148,7 @@ namespace agg
         void line_to(int x, int y);
         void move_to_d(double x, double y);
         void line_to_d(double x, double y);
+        void line_to_block_d(const double* xy, unsigned num);
         void close_polygon();
         void add_vertex(double x, double y, unsigned cmd);
 
@@ -178,6 +179,7 @@ namespace agg
 
         //--------------------------------------------------------------------
         void sort();
+        bool sorted() const { return m_outline.sorted(); }
         bool rewind_scanlines();
         bool navigate_scanline(int y);
 
@@ -377,6 +379,16 @@ namespace agg
         m_status = status_line_to;
     }
 
+    //------------------------------------------------------------------------
+    // Same as num calls of line_to_d(), xy contains interleaved points.
+    template<class Clip> 
+    void rasterizer_scanline_aa<Clip>::line_to_block_d(const double* xy, unsigned num) 
+    { 
+        if(num == 0) return;
+        m_clipper.line_to_block_d(m_outline, xy, num);
+        m_status = status_line_to;
+    }
+
     //------------------------------------------------------------------------
     template<class Clip> 
     void rasterizer_scanline_aa<Clip>::add_vertex(double x, double y, unsigned cmd)
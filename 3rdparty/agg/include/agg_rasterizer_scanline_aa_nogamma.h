@@ -151,6 +151,7 @@ namespace agg
         void line_to(int x, int y);
         void move_to_d(double x, double y);
         void line_to_d(double x, double y);
+        void line_to_block_d(const double* xy, unsigned num);
         void close_polygon();
         void add_vertex(double x, double y, unsigned cmd);
 
@@ -181,6 +182,7 @@ namespace agg
 
         //--------------------------------------------------------------------
         void sort();
+        bool sorted() const { return m_outline.sorted(); }
         bool rewind_scanlines();
         bool navigate_scanline(int y);
 
@@ -379,6 +381,16 @@ namespace agg
         m_status = status_line_to;
     }
 
+    //------------------------------------------------------------------------
+    // Same as num calls of line_to_d(), xy contains interleaved points.
+    template<class Clip> 
+    void rasterizer_scanline_aa_nogamma<Clip>::line_to_block_d(const double* xy, unsigned num) 
+    { 
+        if(num == 0) return;
+        m_clipper.line_to_block_d(m_outline, xy, num);
+        m_status = status_line_to;
+    }
+
     //------------------------------------------------------------------------
     template<class Clip> 
     void rasterizer_scanline_aa_nogamma<Clip>::add_vertex(double x, double y, unsigned cmd)
@@ -295,6 +295,52 @@ namespace agg
             m_y1 = y2;
         }
 
+        //--------------------------------------------------------------------
+        // Same as num calls of line_to() with upscaled interleaved points
+        // of xy (num must not be zero). If all points of the block are in
+        // the clip box the segments are passed to the rasterizer directly,
+        // which produces the same cells as line_to() as nothing is clipped.
+        template<class Rasterizer>
+        void line_to_block_d(Rasterizer& ras, const double* xy, unsigned num)
+        {
+            unsigned i;
+            if(m_clipping)
+            {
+                unsigned f = m_f1;
+                for(i = 0; i < num; i++)
+                {
+                    f |= clipping_flags(Conv::upscale(xy[i * 2]),
+                                        Conv::upscale(xy[i * 2 + 1]),
+                                        m_clip_box);
+                }
+
+                if(f)
+                {
+                    for(i = 0; i < num; i++)
+                    {
+                        line_to(ras, Conv::upscale(xy[i * 2]),
+                                     Conv::upscale(xy[i * 2 + 1]));
+                    }
+                    return;
+                }
+            }
+
+            int x1 = Conv::xi(m_x1);
+            int y1 = Conv::yi(m_y1);
+            for(i = 0; i < num; i++)
+            {
+                coord_type x2 = Conv::upscale(xy[i * 2]);
+                coord_type y2 = Conv::upscale(xy[i * 2 + 1]);
+                int ix2 = Conv::xi(x2);
+                int iy2 = Conv::yi(y2);
+                ras.line(x1, y1, ix2, iy2);
+                x1 = ix2;
+                y1 = iy2;
+                m_x1 = x2;
+                m_y1 = y2;
+            }
+        }
+
 
     private:
         rect_type        m_clip_box;
@@ -328,6 +374,16 @@ namespace agg
             m_y1 = y2;
         }
 
+        template<class Rasterizer>
+        void line_to_block_d(Rasterizer& ras, const double* xy, unsigned num)
+        {
+            for(unsigned i = 0; i < num; i++)
+            {
+                line_to(ras, conv_type::upscale(xy[i * 2]),
+                             conv_type::upscale(xy[i * 2 + 1]));
+            }
+        }
+
     private:
         int m_x1, m_y1;
     };
@@ -0,0 +1,318 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Span combine functors of the scanline boolean algebra that compute the
+// resulting covers 16 at a time with SSE2 (with a scalar fallback). The
+// generated scanlines are identical to the ones generated by
+// sbool_intersect_spans_aa, sbool_unite_spans_aa and sbool_xor_spans_aa
+// (linear formula), only 8-bit covers are supported.
+//
+// The shape functions (sbool_*_shapes_aa_sse2) work on whole scanline
+// generators. To run them in parallel split the target into horizontal
+// bands and give each band its own generators clipped to it (clip_box()),
+// bands don't share any state.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2_INCLUDED
+#define AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2_INCLUDED
+
+#include "agg_scanline_boolean_algebra.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //---------------------------------------------sbool_intersect_covers_sse2
+    struct sbool_intersect_covers_sse2
+    {
+        enum { skip_zero = 0 };
+
+        static AGG_INLINE unsigned calculate(unsigned a, unsigned b)
+        {
+            unsigned cover = a * b;
+            return (cover == 255 * 255) ? 255 : (cover >> 8);
+        }
+
+#ifdef AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2
+        // a and b are 8 covers extended to 16 bits.
+        static AGG_INLINE __m128i calculate(__m128i a, __m128i b)
+        {
+            __m128i cover = _mm_mullo_epi16(a, b);
+            __m128i full  = _mm_cmpeq_epi16(cover, _mm_set1_epi16(short(255 * 255)));
+            return _mm_or_si128(_mm_srli_epi16(cover, 8), _mm_srli_epi16(full, 8));
+        }
+#endif
+
+        // Handles a solid span combined with an AA one, returns false if
+        // the covers have to be combined one by one.
+        template<class Scanline>
+        static AGG_INLINE bool combine_solid(Scanline& sl, int x, unsigned len,
+                                             unsigned solid, const int8u* covers)
+        {
+            if(solid != 255) return false;
+            sl.add_cells(x, len, covers);
+            return true;
+        }
+    };
+
+    //-------------------------------------------------sbool_unite_covers_sse2
+    struct sbool_unite_covers_sse2
+    {
+        enum { skip_zero = 0 };
+
+        static AGG_INLINE unsigned calculate(unsigned a, unsigned b)
+        {
+            unsigned cover = 255 * 255 - (255 - a) * (255 - b);
+            return (cover == 255 * 255) ? 255 : (cover >> 8);
+        }
+
+#ifdef AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2
+        static AGG_INLINE __m128i calculate(__m128i a, __m128i b)
+        {
+            __m128i mask  = _mm_set1_epi16(255);
+            __m128i full  = _mm_set1_epi16(short(255 * 255));
+            __m128i cover = _mm_sub_epi16(full, _mm_mullo_epi16(_mm_sub_epi16(mask, a),
+                                                               _mm_sub_epi16(mask, b)));
+            full = _mm_cmpeq_epi16(cover, full);
+            return _mm_or_si128(_mm_srli_epi16(cover, 8), _mm_srli_epi16(full, 8));
+        }
+#endif
+
+        template<class Scanline>
+        static AGG_INLINE bool combine_solid(Scanline& sl, int x, unsigned len,
+                                             unsigned solid, const int8u*)
+        {
+            if(solid != 255) return false;
+            sl.add_span(x, len, 255);
+            return true;
+        }
+    };
+
+    //---------------------------------------------------sbool_xor_covers_sse2
+    // The "linear" XOR, see sbool_xor_formula_linear.
+    struct sbool_xor_covers_sse2
+    {
+        enum { skip_zero = 1 };
+
+        static AGG_INLINE unsigned calculate(unsigned a, unsigned b)
+        {
+            return sbool_xor_formula_linear<>::calculate(a, b);
+        }
+
+#ifdef AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2
+        static AGG_INLINE __m128i calculate(__m128i a, __m128i b)
+        {
+            // a + b if it's not greater than 255, 510 - (a + b) otherwise.
+            __m128i cover = _mm_add_epi16(a, b);
+            return _mm_min_epi16(cover, _mm_sub_epi16(_mm_set1_epi16(510), cover));
+        }
+#endif
+
+        template<class Scanline>
+        static AGG_INLINE bool combine_solid(Scanline&, int, unsigned,
+                                             unsigned, const int8u*)
+        {
+            return false;
+        }
+    };
+
+    //------------------------------------------------sbool_combine_covers_sse2
+    // Combines len covers into dst. A zero inc1/inc2 means the cover is the
+    // same for all cells (solid span). Returns true if any resulting cover
+    // is zero.
+    template<class CoverOp>
+    bool sbool_combine_covers_sse2(const int8u* covers1, unsigned inc1,
+                                   const int8u* covers2, unsigned inc2,
+                                   int8u* dst, unsigned len)
+    {
+        unsigned i = 0;
+        unsigned any_zero = 0;
+
+#ifdef AGG_SCANLINE_BOOLEAN_ALGEBRA_SSE2
+        __m128i zero = _mm_setzero_si128();
+        __m128i solid1 = _mm_set1_epi8(char(*covers1));
+        __m128i solid2 = _mm_set1_epi8(char(*covers2));
+        __m128i zero_mask = zero;
+
+        for(; i + 16 <= len; i += 16)
+        {
+            __m128i c1 = inc1 ? _mm_loadu_si128((const __m128i*)(covers1 + i)) : solid1;
+            __m128i c2 = inc2 ? _mm_loadu_si128((const __m128i*)(covers2 + i)) : solid2;
+
+            __m128i lo = CoverOp::calculate(_mm_unpacklo_epi8(c1, zero), _mm_unpacklo_epi8(c2, zero));
+            __m128i hi = CoverOp::calculate(_mm_unpackhi_epi8(c1, zero), _mm_unpackhi_epi8(c2, zero));
+            __m128i r  = _mm_packus_epi16(lo, hi);
+
+            zero_mask = _mm_or_si128(zero_mask, _mm_cmpeq_epi8(r, zero));
+            _mm_storeu_si128((__m128i*)(dst + i), r);
+        }
+        any_zero = unsigned(_mm_movemask_epi8(zero_mask));
+#endif
+
+        for(; i < len; i++)
+        {
+            unsigned cover = CoverOp::calculate(covers1[i * inc1], covers2[i * inc2]);
+            dst[i] = int8u(cover);
+            any_zero |= cover == 0;
+        }
+        return any_zero != 0;
+    }
+
+    //---------------------------------------------------sbool_combine_spans_aa_sse2
+    // Functor.
+    // Combines two spans by CoverOp, see the sbool_*_covers_sse2 structs.
+    // The result is added to the "sl" scanline.
+    //------------------
+    template<class Scanline1,
+             class Scanline2,
+             class Scanline,
+             class CoverOp>
+    struct sbool_combine_spans_aa_sse2
+    {
+        enum { chunk_size = 256 };
+
+        void operator () (const typename Scanline1::const_iterator& span1,
+                          const typename Scanline2::const_iterator& span2,
+                          int x, unsigned len,
+                          Scanline& sl) const
+        {
+            const int8u* covers1 = span1->covers;
+            const int8u* covers2 = span2->covers;
+            unsigned inc1 = span1->len > 0;
+            unsigned inc2 = span2->len > 0;
+
+            if(inc1 && span1->x < x) covers1 += x - span1->x;
+            if(inc2 && span2->x < x) covers2 += x - span2->x;
+
+            if(!inc1 && !inc2)
+            {
+                unsigned cover = CoverOp::calculate(*covers1, *covers2);
+                if(cover || !CoverOp::skip_zero) sl.add_span(x, len, cover);
+                return;
+            }
+
+            if(!inc1 && CoverOp::combine_solid(sl, x, len, *covers1, covers2)) return;
+            if(!inc2 && CoverOp::combine_solid(sl, x, len, *covers2, covers1)) return;
+
+            // Edge spans are mostly a few cells long, not worth the setup.
+            if(len < 16)
+            {
+                do
+                {
+                    unsigned cover = CoverOp::calculate(*covers1, *covers2);
+                    if(cover || !CoverOp::skip_zero) sl.add_cell(x, cover);
+                    covers1 += inc1;
+                    covers2 += inc2;
+                    ++x;
+                }
+                while(--len);
+                return;
+            }
+
+            int8u buf[chunk_size];
+            while(len)
+            {
+                unsigned n = len < unsigned(chunk_size) ? len : unsigned(chunk_size);
+                bool any_zero = sbool_combine_covers_sse2<CoverOp>(covers1, inc1, covers2, inc2, buf, n);
+
+                if(!CoverOp::skip_zero || !any_zero)
+                {
+                    sl.add_cells(x, n, buf);
+                }
+                else
+                {
+                    // Add only the runs of non-zero covers.
+                    unsigned i = 0;
+                    while(i < n)
+                    {
+                        while(i < n && buf[i] == 0) i++;
+                        unsigned start = i;
+                        while(i < n && buf[i] != 0) i++;
+                        if(i > start) sl.add_cells(x + int(start), i - start, buf + start);
+                    }
+                }
+
+                covers1 += n * inc1;
+                covers2 += n * inc2;
+                x += int(n);
+                len -= n;
+            }
+        }
+    };
+
+    //----------------------------------------------sbool_intersect_shapes_aa_sse2
+    // See sbool_intersect_shapes_aa.
+    template<class ScanlineGen1,
+             class ScanlineGen2,
+             class Scanline1,
+             class Scanline2,
+             class Scanline,
+             class Renderer>
+    void sbool_intersect_shapes_aa_sse2(ScanlineGen1& sg1, ScanlineGen2& sg2,
+                                        Scanline1& sl1, Scanline2& sl2,
+                                        Scanline& sl, Renderer& ren)
+    {
+        sbool_combine_spans_aa_sse2<Scanline1, Scanline2, Scanline,
+                                    sbool_intersect_covers_sse2> combine_functor;
+        sbool_intersect_shapes(sg1, sg2, sl1, sl2, sl, ren, combine_functor);
+    }
+
+    //--------------------------------------------------sbool_unite_shapes_aa_sse2
+    // See sbool_unite_shapes_aa.
+    template<class ScanlineGen1,
+             class ScanlineGen2,
+             class Scanline1,
+             class Scanline2,
+             class Scanline,
+             class Renderer>
+    void sbool_unite_shapes_aa_sse2(ScanlineGen1& sg1, ScanlineGen2& sg2,
+                                    Scanline1& sl1, Scanline2& sl2,
+                                    Scanline& sl, Renderer& ren)
+    {
+        sbool_add_span_aa<Scanline1, Scanline> add_functor1;
+        sbool_add_span_aa<Scanline2, Scanline> add_functor2;
+        sbool_combine_spans_aa_sse2<Scanline1, Scanline2, Scanline,
+                                    sbool_unite_covers_sse2> combine_functor;
+        sbool_unite_shapes(sg1, sg2, sl1, sl2, sl, ren,
+                           add_functor1, add_functor2, combine_functor);
+    }
+
+    //----------------------------------------------------sbool_xor_shapes_aa_sse2
+    // See sbool_xor_shapes_aa.
+    template<class ScanlineGen1,
+             class ScanlineGen2,
+             class Scanline1,
+             class Scanline2,
+             class Scanline,
+             class Renderer>
+    void sbool_xor_shapes_aa_sse2(ScanlineGen1& sg1, ScanlineGen2& sg2,
+                                  Scanline1& sl1, Scanline2& sl2,
+                                  Scanline& sl, Renderer& ren)
+    {
+        sbool_add_span_aa<Scanline1, Scanline> add_functor1;
+        sbool_add_span_aa<Scanline2, Scanline> add_functor2;
+        sbool_combine_spans_aa_sse2<Scanline1, Scanline2, Scanline,
+                                    sbool_xor_covers_sse2> combine_functor;
+        sbool_unite_shapes(sg1, sg2, sl1, sl2, sl, ren,
+                           add_functor1, add_functor2, combine_functor);
+    }
+
+}
+
+#endif
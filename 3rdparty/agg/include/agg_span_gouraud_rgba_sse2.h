@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Gouraud span generator for rgba8 that interpolates all 4 components in
+// a single SSE2 register and writes 4 pixels per step (with a scalar
+// fallback).
+//
+// span_gouraud_rgba clamps the components only at both ends of a span and
+// relies on the interpolators not to overflow in the middle. Here every
+// pixel is clamped by the saturating packs, which gives the same colors
+// when nothing overflows, so the result is identical to
+// span_gouraud_rgba<rgba8>.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SPAN_GOURAUD_RGBA_SSE2_INCLUDED
+#define AGG_SPAN_GOURAUD_RGBA_SSE2_INCLUDED
+
+#include <stdlib.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_color_rgba.h"
+#include "agg_span_gouraud.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_SPAN_GOURAUD_RGBA_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //===============================================span_gouraud_rgba8_sse2
+    class span_gouraud_rgba8_sse2 : public span_gouraud<rgba8>
+    {
+    public:
+        typedef rgba8 color_type;
+        typedef span_gouraud<color_type> base_type;
+        typedef base_type::coord_type coord_type;
+        enum subpixel_scale_e
+        {
+            subpixel_shift = 4,
+            subpixel_scale = 1 << subpixel_shift
+        };
+
+        // The same as dda_line_interpolator<14>.
+        enum fraction_e { fraction_shift = 14 };
+
+    private:
+        //--------------------------------------------------------------------
+        // Interpolates the components and x along one edge of the triangle.
+        struct rgba_calc
+        {
+            void init(const coord_type& c1, const coord_type& c2)
+            {
+                m_x1  = c1.x - 0.5;
+                m_y1  = c1.y - 0.5;
+                m_dx  = c2.x - c1.x;
+                double dy = c2.y - c1.y;
+                m_1dy = (dy < 1e-5) ? 1e5 : 1.0 / dy;
+                m_c1[0] = c1.color.r;
+                m_c1[1] = c1.color.g;
+                m_c1[2] = c1.color.b;
+                m_c1[3] = c1.color.a;
+                m_dc[0] = c2.color.r - m_c1[0];
+                m_dc[1] = c2.color.g - m_c1[1];
+                m_dc[2] = c2.color.b - m_c1[2];
+                m_dc[3] = c2.color.a - m_c1[3];
+            }
+
+            void calc(double y)
+            {
+                double k = (y - m_y1) * m_1dy;
+                if(k < 0.0) k = 0.0;
+                if(k > 1.0) k = 1.0;
+                for(unsigned i = 0; i < 4; i++)
+                {
+                    m_c[i] = m_c1[i] + iround(m_dc[i] * k);
+                }
+                m_x = iround((m_x1 + m_dx * k) * subpixel_scale);
+            }
+
+            double m_x1;
+            double m_y1;
+            double m_dx;
+            double m_1dy;
+            int    m_c1[4];
+            int    m_dc[4];
+            int    m_c[4];
+            int    m_x;
+        };
+
+    public:
+        //--------------------------------------------------------------------
+        span_gouraud_rgba8_sse2() {}
+        span_gouraud_rgba8_sse2(const color_type& c1,
+                                const color_type& c2,
+                                const color_type& c3,
+                                double x1, double y1,
+                                double x2, double y2,
+                                double x3, double y3,
+                                double d = 0) :
+            base_type(c1, c2, c3, x1, y1, x2, y2, x3, y3, d)
+        {}
+
+        //--------------------------------------------------------------------
+        void prepare()
+        {
+            coord_type coord[3];
+            base_type::arrange_vertices(coord);
+
+            m_y2 = int(coord[1].y);
+
+            m_swap = cross_product(coord[0].x, coord[0].y,
+                                   coord[2].x, coord[2].y,
+                                   coord[1].x, coord[1].y) < 0.0;
+
+            m_rgba1.init(coord[0], coord[2]);
+            m_rgba2.init(coord[0], coord[1]);
+            m_rgba3.init(coord[1], coord[2]);
+        }
+
+        //--------------------------------------------------------------------
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            m_rgba1.calc(y);
+            const rgba_calc* pc1 = &m_rgba1;
+            const rgba_calc* pc2 = &m_rgba2;
+
+            if(y <= m_y2)
+            {
+                m_rgba2.calc(y + m_rgba2.m_1dy);
+            }
+            else
+            {
+                m_rgba3.calc(y - m_rgba3.m_1dy);
+                pc2 = &m_rgba3;
+            }
+
+            if(m_swap)
+            {
+                const rgba_calc* t = pc2;
+                pc2 = pc1;
+                pc1 = t;
+            }
+
+            int nlen = abs(pc2->m_x - pc1->m_x);
+            if(nlen <= 0) nlen = 1;
+
+            // Interpolators rolled back to x, their values are y + (dy >> 14)
+            // and dy advances by inc each subpixel (wraps like the scalar one).
+            int start = pc1->m_x - (x << subpixel_shift);
+            int inc[4];
+            int dy[4];
+            for(unsigned i = 0; i < 4; i++)
+            {
+                inc[i] = ((pc2->m_c[i] - pc1->m_c[i]) << fraction_shift) / nlen;
+                dy[i]  = int(0u - unsigned(inc[i]) * unsigned(start));
+            }
+
+#ifdef AGG_SPAN_GOURAUD_RGBA_SSE2
+            __m128i c   = _mm_loadu_si128((const __m128i*)pc1->m_c);
+            __m128i d0  = _mm_loadu_si128((const __m128i*)dy);
+            __m128i i1  = _mm_slli_epi32(_mm_loadu_si128((const __m128i*)inc), subpixel_shift);
+            __m128i i4  = _mm_slli_epi32(i1, 2);
+            __m128i d1  = _mm_add_epi32(d0, i1);
+            __m128i d2  = _mm_add_epi32(d1, i1);
+            __m128i d3  = _mm_add_epi32(d2, i1);
+
+            while(len >= 4)
+            {
+                __m128i v0 = _mm_add_epi32(c, _mm_srai_epi32(d0, fraction_shift));
+                __m128i v1 = _mm_add_epi32(c, _mm_srai_epi32(d1, fraction_shift));
+                __m128i v2 = _mm_add_epi32(c, _mm_srai_epi32(d2, fraction_shift));
+                __m128i v3 = _mm_add_epi32(c, _mm_srai_epi32(d3, fraction_shift));
+                _mm_storeu_si128((__m128i*)span,
+                                 _mm_packus_epi16(_mm_packs_epi32(v0, v1),
+                                                  _mm_packs_epi32(v2, v3)));
+                d0 = _mm_add_epi32(d0, i4);
+                d1 = _mm_add_epi32(d1, i4);
+                d2 = _mm_add_epi32(d2, i4);
+                d3 = _mm_add_epi32(d3, i4);
+                span += 4;
+                len -= 4;
+            }
+
+            while(len)
+            {
+                __m128i v = _mm_add_epi32(c, _mm_srai_epi32(d0, fraction_shift));
+                v = _mm_packs_epi32(v, v);
+                int32u p = int32u(_mm_cvtsi128_si32(_mm_packus_epi16(v, v)));
+                memcpy((int8u*)span, &p, 4);
+                d0 = _mm_add_epi32(d0, i1);
+                ++span;
+                --len;
+            }
+#else
+            int8u* p = (int8u*)span;
+            while(len)
+            {
+                for(unsigned i = 0; i < 4; i++)
+                {
+                    int v = pc1->m_c[i] + (dy[i] >> fraction_shift);
+                    p[i] = int8u(v < 0 ? 0 : v > 255 ? 255 : v);
+                    dy[i] = int(unsigned(dy[i]) + (unsigned(inc[i]) << subpixel_shift));
+                }
+                p += 4;
+                --len;
+            }
+#endif
+        }
+
+    private:
+        bool      m_swap;
+        int       m_y2;
+        rgba_calc m_rgba1;
+        rgba_calc m_rgba2;
+        rgba_calc m_rgba3;
+    };
+
+}
+
+#endif
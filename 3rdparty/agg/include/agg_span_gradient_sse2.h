@@ -0,0 +1,344 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Gradient span generators that evaluate 4 pixels per step with SSE2 (with
+// a scalar fallback). Unlike span_gradient they work in floating point
+// directly in screen space, without an interpolator and a gradient function
+// called per pixel, and read colors from gradient_lut_rgba8, which is built
+// from the color stops without sorting them.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SPAN_GRADIENT_SSE2_INCLUDED
+#define AGG_SPAN_GRADIENT_SSE2_INCLUDED
+
+#include <math.h>
+#include "agg_basics.h"
+#include "agg_color_rgba.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_SPAN_GRADIENT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //-------------------------------------------------------gradient_extend_e
+    enum gradient_extend_e
+    {
+        gradient_extend_pad,
+        gradient_extend_repeat,
+        gradient_extend_reflect
+    };
+
+    //------------------------------------------------------gradient_lut_rgba8
+    class gradient_lut_rgba8
+    {
+    public:
+        enum lut_scale_e
+        {
+            lut_shift = 8,
+            lut_size  = 1 << lut_shift,
+            lut_mask  = lut_size - 1
+        };
+
+        // Builds the LUT from num stops, which must be sorted by offset.
+        // Colors between stops are interpolated the same way as by
+        // gradient_lut, in 16.16 fixed point.
+        void build(const double* offsets, const rgba8* colors, unsigned num)
+        {
+            unsigned i;
+            unsigned start = uround(offsets[0] * lut_size);
+            unsigned end = start;
+
+            if(start > lut_size) start = end = lut_size;
+            for(i = 0; i < start; i++) m_lut[i] = colors[0];
+
+            for(i = 1; i < num; i++)
+            {
+                end = uround(offsets[i] * lut_size);
+                if(end > lut_size) end = lut_size;
+                if(end <= start) continue;
+
+                const rgba8& c1 = colors[i - 1];
+                const rgba8& c2 = colors[i];
+                int n = int(end - start + 1);
+
+                int r = int(c1.r) << 16, dr = ((int(c2.r) - int(c1.r)) << 16) / n;
+                int g = int(c1.g) << 16, dg = ((int(c2.g) - int(c1.g)) << 16) / n;
+                int b = int(c1.b) << 16, db = ((int(c2.b) - int(c1.b)) << 16) / n;
+                int a = int(c1.a) << 16, da = ((int(c2.a) - int(c1.a)) << 16) / n;
+
+                for(; start < end; start++)
+                {
+                    m_lut[start] = rgba8((r + 0x8000) >> 16, (g + 0x8000) >> 16,
+                                         (b + 0x8000) >> 16, (a + 0x8000) >> 16);
+                    r += dr; g += dg; b += db; a += da;
+                }
+            }
+
+            for(; end < lut_size; end++) m_lut[end] = colors[num - 1];
+        }
+
+        const rgba8& operator [] (unsigned i) const { return m_lut[i]; }
+
+    private:
+        rgba8 m_lut[lut_size];
+    };
+
+    //------------------------------------------------------gradient_fetch_sse2
+    // Converts gradient positions (scaled to LUT size) into LUT indexes
+    // according to the extend mode and fetches count (at most 4) colors.
+    class gradient_fetch_sse2
+    {
+    public:
+        typedef gradient_lut_rgba8 lut_type;
+
+#ifdef AGG_SPAN_GRADIENT_SSE2
+        static AGG_INLINE void fetch(rgba8* span, const lut_type& lut,
+                                     gradient_extend_e extend,
+                                     __m128 t, unsigned count)
+        {
+            __m128i idx;
+            if(extend == gradient_extend_pad)
+            {
+                t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()),
+                               _mm_set1_ps(float(lut_type::lut_mask)));
+                idx = _mm_cvttps_epi32(t);
+            }
+            else
+            {
+                // Floor, _mm_cvttps_epi32() truncates towards zero.
+                idx = _mm_cvttps_epi32(t);
+                idx = _mm_add_epi32(idx, _mm_castps_si128(
+                          _mm_cmpgt_ps(_mm_cvtepi32_ps(idx), t)));
+
+                if(extend == gradient_extend_repeat)
+                {
+                    idx = _mm_and_si128(idx, _mm_set1_epi32(lut_type::lut_mask));
+                }
+                else
+                {
+                    __m128i mask2 = _mm_set1_epi32(lut_type::lut_size * 2 - 1);
+                    idx = _mm_and_si128(idx, mask2);
+                    __m128i flip = _mm_cmpgt_epi32(idx, _mm_set1_epi32(lut_type::lut_mask));
+                    idx = _mm_xor_si128(idx, _mm_and_si128(flip, mask2));
+                }
+            }
+
+            int32 i[4];
+            _mm_storeu_si128((__m128i*)i, idx);
+            if(count > 4) count = 4;
+            for(unsigned k = 0; k < count; k++)
+            {
+                span[k] = lut[i[k]];
+            }
+        }
+#endif
+
+        static AGG_INLINE void fetch(rgba8* span, const lut_type& lut,
+                                     gradient_extend_e extend, double t)
+        {
+            int i;
+            if(extend == gradient_extend_pad)
+            {
+                i = (t <= 0.0) ? 0 : (t >= double(lut_type::lut_mask)) ? int(lut_type::lut_mask) : int(t);
+            }
+            else
+            {
+                i = ifloor(t);
+                if(extend == gradient_extend_repeat)
+                {
+                    i &= lut_type::lut_mask;
+                }
+                else
+                {
+                    i &= lut_type::lut_size * 2 - 1;
+                    if(i > lut_type::lut_mask) i ^= lut_type::lut_size * 2 - 1;
+                }
+            }
+            *span = lut[i];
+        }
+    };
+
+    //-----------------------------------------------span_gradient_linear_sse2
+    // Linear gradient from (x1, y1) to (x2, y2), both in screen space.
+    class span_gradient_linear_sse2
+    {
+    public:
+        typedef rgba8 color_type;
+
+        span_gradient_linear_sse2() :
+            m_lut(0), m_extend(gradient_extend_pad), m_ax(0), m_ay(0), m_c(0) {}
+
+        void init(const gradient_lut_rgba8& lut, gradient_extend_e extend,
+                  double x1, double y1, double x2, double y2)
+        {
+            double dx = x2 - x1;
+            double dy = y2 - y1;
+            double len2 = dx * dx + dy * dy;
+            double scale = (len2 > 0.0) ? double(gradient_lut_rgba8::lut_size) / len2 : 0.0;
+
+            m_lut = &lut;
+            m_extend = extend;
+            m_ax = dx * scale;
+            m_ay = dy * scale;
+            m_c = -(x1 * m_ax + y1 * m_ay);
+        }
+
+        void prepare() {}
+
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            double t = m_ax * (x + 0.5) + m_ay * (y + 0.5) + m_c;
+
+#ifdef AGG_SPAN_GRADIENT_SSE2
+            __m128 vt  = _mm_add_ps(_mm_set1_ps(float(t)),
+                                    _mm_mul_ps(_mm_set1_ps(float(m_ax)),
+                                               _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)));
+            __m128 vdt = _mm_set1_ps(float(m_ax * 4.0));
+
+            while(len >= 4)
+            {
+                gradient_fetch_sse2::fetch(span, *m_lut, m_extend, vt, 4);
+                vt = _mm_add_ps(vt, vdt);
+                span += 4;
+                len -= 4;
+            }
+            if(len) gradient_fetch_sse2::fetch(span, *m_lut, m_extend, vt, len);
+#else
+            do
+            {
+                gradient_fetch_sse2::fetch(span++, *m_lut, m_extend, t);
+                t += m_ax;
+            }
+            while(--len);
+#endif
+        }
+
+    private:
+        const gradient_lut_rgba8* m_lut;
+        gradient_extend_e         m_extend;
+        double                    m_ax;
+        double                    m_ay;
+        double                    m_c;
+    };
+
+    //-----------------------------------------------span_gradient_radial_sse2
+    // Radial gradient with a circle at (cx, cy) of radius r and a focal
+    // point at (fx, fy), all in screen space. Uses the same equation as
+    // gradient_radial_focus.
+    class span_gradient_radial_sse2
+    {
+    public:
+        typedef rgba8 color_type;
+
+        span_gradient_radial_sse2() :
+            m_lut(0), m_extend(gradient_extend_pad),
+            m_x(0), m_y(0), m_fx(0), m_fy(0), m_r2(0), m_mul(0) {}
+
+        void init(const gradient_lut_rgba8& lut, gradient_extend_e extend,
+                  double cx, double cy, double r, double fx, double fy)
+        {
+            m_lut = &lut;
+            m_extend = extend;
+            m_fx = fx - cx;
+            m_fy = fy - cy;
+            m_r2 = r * r;
+
+            // The focal point must be inside of the circle, move it a bit
+            // towards the center if it lies on it (see gradient_radial_focus).
+            double d = m_r2 - (m_fx * m_fx + m_fy * m_fy);
+            if(d <= m_r2 * 1e-6 && m_r2 > 0.0)
+            {
+                double s = sqrt((m_r2 * (1.0 - 1e-6)) / (m_fx * m_fx + m_fy * m_fy));
+                m_fx *= s;
+                m_fy *= s;
+                d = m_r2 - (m_fx * m_fx + m_fy * m_fy);
+            }
+
+            m_x = cx + m_fx;
+            m_y = cy + m_fy;
+            m_mul = (d > 0.0) ? double(gradient_lut_rgba8::lut_size) / d : 0.0;
+        }
+
+        void prepare() {}
+
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            double dx = x + 0.5 - m_x;
+            double dy = y + 0.5 - m_y;
+
+#ifdef AGG_SPAN_GRADIENT_SSE2
+            __m128 vdx = _mm_add_ps(_mm_set1_ps(float(dx)), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+            __m128 vfx = _mm_set1_ps(float(m_fx));
+            __m128 vr2 = _mm_set1_ps(float(m_r2));
+            __m128 vmul = _mm_set1_ps(float(m_mul));
+
+            // Terms that only depend on y.
+            __m128 vdy_fx  = _mm_set1_ps(float(dy * m_fx));
+            __m128 vdy_fy  = _mm_set1_ps(float(dy * m_fy));
+            __m128 vdy2    = _mm_set1_ps(float(dy * dy));
+            __m128 vfy     = _mm_set1_ps(float(m_fy));
+            __m128 vabs    = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            __m128 vstep   = _mm_set1_ps(4.0f);
+
+            for(;;)
+            {
+                __m128 d2 = _mm_sub_ps(_mm_mul_ps(vdx, vfy), vdy_fx);
+                __m128 d3 = _mm_sub_ps(_mm_mul_ps(vr2, _mm_add_ps(_mm_mul_ps(vdx, vdx), vdy2)),
+                                       _mm_mul_ps(d2, d2));
+                __m128 t  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vdx, vfx), vdy_fy),
+                                       _mm_sqrt_ps(_mm_and_ps(d3, vabs)));
+                t = _mm_mul_ps(t, vmul);
+
+                if(len <= 4)
+                {
+                    gradient_fetch_sse2::fetch(span, *m_lut, m_extend, t, len);
+                    break;
+                }
+
+                gradient_fetch_sse2::fetch(span, *m_lut, m_extend, t, 4);
+                vdx = _mm_add_ps(vdx, vstep);
+                span += 4;
+                len -= 4;
+            }
+#else
+            do
+            {
+                double d2 = dx * m_fy - dy * m_fx;
+                double d3 = m_r2 * (dx * dx + dy * dy) - d2 * d2;
+                double t = (dx * m_fx + dy * m_fy + sqrt(fabs(d3))) * m_mul;
+                gradient_fetch_sse2::fetch(span++, *m_lut, m_extend, t);
+                dx += 1.0;
+            }
+            while(--len);
+#endif
+        }
+
+    private:
+        const gradient_lut_rgba8* m_lut;
+        gradient_extend_e         m_extend;
+        double                    m_x;
+        double                    m_y;
+        double                    m_fx;
+        double                    m_fy;
+        double                    m_r2;
+        double                    m_mul;
+    };
+
+}
+
+#endif
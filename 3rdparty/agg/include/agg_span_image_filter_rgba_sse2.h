@@ -0,0 +1,388 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Nearest neighbor and bilinear RGBA image span generators for affine
+// transformations with a repeating source image. They step through the
+// source in 16.16 fixed point instead of using an interpolator and an
+// image accessor per pixel. When the whole span samples the inside of the
+// image (the common case) no wrapping is done at all and SSE2 is used to
+// compute several coordinates or all 4 channels at once.
+//
+// The source must be a 32-bit RGBA pixel format with 8-bit components.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_SPAN_IMAGE_FILTER_RGBA_SSE2_INCLUDED
+#define AGG_SPAN_IMAGE_FILTER_RGBA_SSE2_INCLUDED
+
+#include <math.h>
+#include <string.h>
+#include "agg_basics.h"
+#include "agg_color_rgba.h"
+#include "agg_image_filters.h"
+#include "agg_trans_affine.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_SPAN_IMAGE_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+
+    //----------------------------------------------------span_image_affine_sse2
+    // Common part of the generators, maps spans into the source image.
+    template<class Source> class span_image_affine_sse2
+    {
+    public:
+        typedef Source source_type;
+        typedef rgba8 color_type;
+        typedef typename source_type::order_type order_type;
+
+        enum fixed_e
+        {
+            fixed_shift = 16,
+            fixed_scale = 1 << fixed_shift,
+            fixed_mask  = fixed_scale - 1
+        };
+
+        // The matrix maps destination pixels into the source image, like
+        // the (already inverted) matrix passed to span interpolators.
+        span_image_affine_sse2(const source_type& src, const trans_affine& mtx) :
+            m_src(&src), m_mtx(mtx) {}
+
+        void prepare() {}
+
+    protected:
+        // Computes the fixed point source position of the first pixel of the
+        // span and its increment, offset by (ox, oy) in source pixels. Returns
+        // true if the positions of the whole span, extended by margin pixels,
+        // lie in the source image.
+        bool begin(int x, int y, unsigned len, double ox, double oy, int margin,
+                   int* fx, int* fy, int* dx, int* dy) const
+        {
+            double sx = x + 0.5;
+            double sy = y + 0.5;
+            m_mtx.transform(&sx, &sy);
+            sx += ox;
+            sy += oy;
+
+            // Keep the fixed point values far from overflowing.
+            const double limit = 16384.0;
+            double ex = sx + m_mtx.sx  * (len - 1);
+            double ey = sy + m_mtx.shy * (len - 1);
+            if(fabs(sx) >= limit || fabs(sy) >= limit ||
+               fabs(ex) >= limit || fabs(ey) >= limit)
+            {
+                sx = wrap_position(sx, m_src->width());
+                sy = wrap_position(sy, m_src->height());
+            }
+
+            // The start is rounded to image_subpixel_shift bits, the same as
+            // span_interpolator_linear does, so both sample the same pixels.
+            *fx = iround(sx * image_subpixel_scale) << (fixed_shift - image_subpixel_shift);
+            *fy = iround(sy * image_subpixel_scale) << (fixed_shift - image_subpixel_shift);
+            *dx = iround(m_mtx.sx  * fixed_scale);
+            *dy = iround(m_mtx.shy * fixed_scale);
+
+            int x1 = (*fx + *dx * int(len - 1)) >> fixed_shift;
+            int y1 = (*fy + *dy * int(len - 1)) >> fixed_shift;
+            int x0 = *fx >> fixed_shift;
+            int y0 = *fy >> fixed_shift;
+            int w = int(m_src->width()) - margin;
+            int h = int(m_src->height()) - margin;
+
+            return x0 >= 0 && x1 >= 0 && x0 < w && x1 < w &&
+                   y0 >= 0 && y1 >= 0 && y0 < h && y1 < h;
+        }
+
+        static double wrap_position(double v, unsigned size)
+        {
+            double s = double(size);
+            return v - floor(v / s) * s;
+        }
+
+        static AGG_INLINE int wrap(int v, int size)
+        {
+            v %= size;
+            return (v < 0) ? v + size : v;
+        }
+
+        // Converts a pixel read from the source into rgba8 (little endian).
+        static AGG_INLINE int32u to_rgba(int32u v)
+        {
+            return ((v >> (order_type::R * 8)) & 0xFF)        |
+                   ((v >> (order_type::G * 8)) & 0xFF) <<  8  |
+                   ((v >> (order_type::B * 8)) & 0xFF) << 16  |
+                   ((v >> (order_type::A * 8)) & 0xFF) << 24;
+        }
+
+#ifdef AGG_SPAN_IMAGE_FILTER_SSE2
+        static AGG_INLINE __m128i to_rgba(__m128i v)
+        {
+            __m128i m = _mm_set1_epi32(0xFF);
+            __m128i r = _mm_and_si128(_mm_srli_epi32(v, order_type::R * 8), m);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(v, order_type::G * 8), m);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(v, order_type::B * 8), m);
+            __m128i a = _mm_srli_epi32(v, order_type::A * 8);
+            if(order_type::A != 3) a = _mm_and_si128(a, m);
+            return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+        }
+#endif
+
+        static AGG_INLINE void store(color_type* span, int32u v)
+        {
+            memcpy((void*)span, &v, 4);
+        }
+
+        AGG_INLINE int32u pixel(int x, int y) const
+        {
+            int32u v;
+            memcpy(&v, m_src->row_ptr(y) + x * 4, 4);
+            return v;
+        }
+
+        const source_type* m_src;
+        trans_affine       m_mtx;
+    };
+
+    //-----------------------------------------span_image_filter_rgba_nn_sse2
+    template<class Source> class span_image_filter_rgba_nn_sse2 :
+    public span_image_affine_sse2<Source>
+    {
+    public:
+        typedef span_image_affine_sse2<Source> base_type;
+        typedef typename base_type::source_type source_type;
+        typedef typename base_type::color_type color_type;
+
+        span_image_filter_rgba_nn_sse2(const source_type& src, const trans_affine& mtx) :
+            base_type(src, mtx) {}
+
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            int fx, fy, dx, dy;
+            const int shift = base_type::fixed_shift;
+
+            if(!base_type::begin(x, y, len, 0.0, 0.0, 0, &fx, &fy, &dx, &dy))
+            {
+                int w = int(base_type::m_src->width());
+                int h = int(base_type::m_src->height());
+                do
+                {
+                    int32u v = base_type::pixel(base_type::wrap(fx >> shift, w),
+                                                base_type::wrap(fy >> shift, h));
+                    base_type::store(span++, base_type::to_rgba(v));
+                    fx += dx;
+                    fy += dy;
+                }
+                while(--len);
+                return;
+            }
+
+#ifdef AGG_SPAN_IMAGE_FILTER_SSE2
+            if(dy == 0)
+            {
+                // The whole span reads a single row of the source.
+                const int8u* row = base_type::m_src->row_ptr(fy >> shift);
+
+                __m128i vx  = _mm_add_epi32(_mm_set1_epi32(fx),
+                                            _mm_set_epi32(dx * 3, dx * 2, dx, 0));
+                __m128i vdx = _mm_set1_epi32(dx * 4);
+
+                while(len >= 4)
+                {
+                    int32 ix[4];
+                    _mm_storeu_si128((__m128i*)ix, _mm_srai_epi32(vx, shift));
+
+                    int32u p[4];
+                    memcpy(p + 0, row + ix[0] * 4, 4);
+                    memcpy(p + 1, row + ix[1] * 4, 4);
+                    memcpy(p + 2, row + ix[2] * 4, 4);
+                    memcpy(p + 3, row + ix[3] * 4, 4);
+
+                    __m128i v = base_type::to_rgba(_mm_loadu_si128((const __m128i*)p));
+                    _mm_storeu_si128((__m128i*)span, v);
+
+                    vx = _mm_add_epi32(vx, vdx);
+                    span += 4;
+                    len -= 4;
+                }
+                fx = _mm_cvtsi128_si32(vx);
+            }
+#endif
+
+            for(; len; len--)
+            {
+                int32u v = base_type::pixel(fx >> shift, fy >> shift);
+                base_type::store(span++, base_type::to_rgba(v));
+                fx += dx;
+                fy += dy;
+            }
+        }
+    };
+
+    //-----------------------------------span_image_filter_rgba_bilinear_sse2
+    // Weights have image_subpixel_shift bits like in the classic bilinear
+    // filter, but the rows are interpolated first and rounded to 8 bits, so
+    // the result can differ from span_image_filter_rgba_bilinear by 1.
+    template<class Source> class span_image_filter_rgba_bilinear_sse2 :
+    public span_image_affine_sse2<Source>
+    {
+    public:
+        typedef span_image_affine_sse2<Source> base_type;
+        typedef typename base_type::source_type source_type;
+        typedef typename base_type::color_type color_type;
+
+        span_image_filter_rgba_bilinear_sse2(const source_type& src, const trans_affine& mtx) :
+            base_type(src, mtx) {}
+
+        void generate(color_type* span, int x, int y, unsigned len)
+        {
+            int fx, fy, dx, dy;
+            const int shift = base_type::fixed_shift;
+            const int wshift = base_type::fixed_shift - image_subpixel_shift;
+
+            if(!base_type::begin(x, y, len, -0.5, -0.5, 1, &fx, &fy, &dx, &dy))
+            {
+                int w = int(base_type::m_src->width());
+                int h = int(base_type::m_src->height());
+                do
+                {
+                    int x0 = base_type::wrap(fx >> shift, w);
+                    int y0 = base_type::wrap(fy >> shift, h);
+                    int x1 = (x0 + 1 < w) ? x0 + 1 : 0;
+                    int y1 = (y0 + 1 < h) ? y0 + 1 : 0;
+                    unsigned wx = (fx >> wshift) & image_subpixel_mask;
+                    unsigned wy = (fy >> wshift) & image_subpixel_mask;
+
+                    int32u v = blend(base_type::pixel(x0, y0), base_type::pixel(x1, y0),
+                                     base_type::pixel(x0, y1), base_type::pixel(x1, y1),
+                                     wx, wy);
+                    base_type::store(span++, base_type::to_rgba(v));
+                    fx += dx;
+                    fy += dy;
+                }
+                while(--len);
+                return;
+            }
+
+            int stride = base_type::m_src->stride();
+
+#ifdef AGG_SPAN_IMAGE_FILTER_SSE2
+            if(dx == base_type::fixed_scale && dy == 0)
+            {
+                // Translation only - the weights are the same for the whole
+                // span, 4 pixels are interpolated from 5 source columns.
+                const int8u* p = base_type::m_src->row_ptr(fy >> shift) + (fx >> shift) * 4;
+                unsigned wx = (fx >> wshift) & image_subpixel_mask;
+                unsigned wy = (fy >> wshift) & image_subpixel_mask;
+
+                __m128i zero = _mm_setzero_si128();
+                __m128i half = _mm_set1_epi16(image_subpixel_scale / 2);
+                __m128i wy0  = _mm_set1_epi16(short(image_subpixel_scale - wy));
+                __m128i wy1  = _mm_set1_epi16(short(wy));
+                __m128i wx0  = _mm_set1_epi16(short(image_subpixel_scale - wx));
+                __m128i wx1  = _mm_set1_epi16(short(wx));
+                unsigned count = len;
+
+                while(len >= 4)
+                {
+                    __m128i t0 = _mm_loadu_si128((const __m128i*)p);
+                    __m128i t1 = _mm_loadu_si128((const __m128i*)(p + 4));
+                    __m128i b0 = _mm_loadu_si128((const __m128i*)(p + stride));
+                    __m128i b1 = _mm_loadu_si128((const __m128i*)(p + stride + 4));
+
+                    __m128i l0 = lerp(_mm_unpacklo_epi8(t0, zero), _mm_unpacklo_epi8(b0, zero), wy0, wy1, half);
+                    __m128i l1 = lerp(_mm_unpackhi_epi8(t0, zero), _mm_unpackhi_epi8(b0, zero), wy0, wy1, half);
+                    __m128i r0 = lerp(_mm_unpacklo_epi8(t1, zero), _mm_unpacklo_epi8(b1, zero), wy0, wy1, half);
+                    __m128i r1 = lerp(_mm_unpackhi_epi8(t1, zero), _mm_unpackhi_epi8(b1, zero), wy0, wy1, half);
+
+                    __m128i v = _mm_packus_epi16(lerp(l0, r0, wx0, wx1, half),
+                                                 lerp(l1, r1, wx0, wx1, half));
+                    _mm_storeu_si128((__m128i*)span, base_type::to_rgba(v));
+
+                    p += 16;
+                    span += 4;
+                    len -= 4;
+                }
+                fx += int(count - len) * dx;
+            }
+#endif
+
+            for(; len; len--)
+            {
+                const int8u* p = base_type::m_src->row_ptr(fy >> shift) + (fx >> shift) * 4;
+                unsigned wx = (fx >> wshift) & image_subpixel_mask;
+                unsigned wy = (fy >> wshift) & image_subpixel_mask;
+
+#ifdef AGG_SPAN_IMAGE_FILTER_SSE2
+                // [x0y0, x1y0] and [x0y1, x1y1] pairs, 8 components each.
+                __m128i zero = _mm_setzero_si128();
+                __m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), zero);
+                __m128i bot = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + stride)), zero);
+
+                __m128i half = _mm_set1_epi16(image_subpixel_scale / 2);
+
+                __m128i v = lerp(top, bot, _mm_set1_epi16(short(image_subpixel_scale - wy)),
+                                           _mm_set1_epi16(short(wy)), half);
+                v = lerp(v, _mm_srli_si128(v, 8), _mm_set1_epi16(short(image_subpixel_scale - wx)),
+                                                  _mm_set1_epi16(short(wx)), half);
+
+                int32u c = int32u(_mm_cvtsi128_si32(_mm_packus_epi16(v, v)));
+#else
+                int32u p00, p10, p01, p11;
+                memcpy(&p00, p, 4);
+                memcpy(&p10, p + 4, 4);
+                memcpy(&p01, p + stride, 4);
+                memcpy(&p11, p + stride + 4, 4);
+                int32u c = blend(p00, p10, p01, p11, wx, wy);
+#endif
+                base_type::store(span++, base_type::to_rgba(c));
+                fx += dx;
+                fy += dy;
+            }
+        }
+
+    private:
+#ifdef AGG_SPAN_IMAGE_FILTER_SSE2
+        // (a * w0 + b * w1 + half) >> image_subpixel_shift of 16-bit components.
+        static AGG_INLINE __m128i lerp(__m128i a, __m128i b, __m128i w0, __m128i w1, __m128i half)
+        {
+            __m128i v = _mm_add_epi16(_mm_mullo_epi16(a, w0), _mm_mullo_epi16(b, w1));
+            return _mm_srli_epi16(_mm_add_epi16(v, half), image_subpixel_shift);
+        }
+#endif
+
+        // Scalar equivalent of the SSE2 code, works on all components at once.
+        static AGG_INLINE int32u blend(int32u p00, int32u p10, int32u p01, int32u p11,
+                                       unsigned wx, unsigned wy)
+        {
+            int32u c = 0;
+            for(unsigned i = 0; i < 32; i += 8)
+            {
+                unsigned l = (((p00 >> i) & 0xFF) * (image_subpixel_scale - wy) +
+                              ((p01 >> i) & 0xFF) * wy + image_subpixel_scale / 2) >> image_subpixel_shift;
+                unsigned r = (((p10 >> i) & 0xFF) * (image_subpixel_scale - wy) +
+                              ((p11 >> i) & 0xFF) * wy + image_subpixel_scale / 2) >> image_subpixel_shift;
+                unsigned v = (l * (image_subpixel_scale - wx) + r * wx + image_subpixel_scale / 2) >> image_subpixel_shift;
+                c |= int32u(v) << i;
+            }
+            return c;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,220 @@
+//----------------------------------------------------------------------------
+// Anti-Grain Geometry - Version 2.4
+// Copyright (C) 2002-2005 Maxim Shemanarev (http://www.antigrain.com)
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+//----------------------------------------------------------------------------
+// Contact: mcseem@antigrain.com
+//          mcseemagg@yahoo.com
+//          http://www.antigrain.com
+//----------------------------------------------------------------------------
+//
+// Block vertex protocol. Instead of pulling one vertex per call:
+//
+//     unsigned vertex(double* x, double* y);
+//
+// a block source fills arrays of up to max_count vertices per call:
+//
+//     void     rewind(unsigned path_id);
+//     unsigned vertices(double* xy, unsigned* cmd, unsigned max_count);
+//
+// Coordinates are interleaved (x0, y0, x1, y1, ...) and the function returns
+// the number of vertices stored, 0 meaning path_cmd_stop. Commands never
+// contain path_cmd_stop. Coordinates of non-vertex commands are zero.
+//
+// The adaptors below convert between both protocols, so block sources can be
+// used with the classic converters (conv_stroke, etc.) and the other way.
+//
+//----------------------------------------------------------------------------
+#ifndef AGG_VERTEX_BLOCK_INCLUDED
+#define AGG_VERTEX_BLOCK_INCLUDED
+
+#include "agg_basics.h"
+#include "agg_trans_affine.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_VERTEX_BLOCK_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace agg
+{
+    enum vertex_block_e
+    {
+        vertex_block_size = 64
+    };
+
+    //------------------------------------------------trans_affine_transform_block
+    // Transforms num interleaved points in place. The result is bit-exact
+    // with trans_affine::transform() as the operations are done in the same
+    // order, the SSE2 version just computes x and y in a single register.
+    inline void trans_affine_transform_block(const trans_affine& m, double* xy, unsigned num)
+    {
+#ifdef AGG_VERTEX_BLOCK_SSE2
+        __m128d m0 = _mm_set_pd(m.shy, m.sx);
+        __m128d m1 = _mm_set_pd(m.sy,  m.shx);
+        __m128d t  = _mm_set_pd(m.ty,  m.tx);
+
+        for(unsigned i = 0; i < num; i++, xy += 2)
+        {
+            __m128d p  = _mm_loadu_pd(xy);
+            __m128d px = _mm_unpacklo_pd(p, p);
+            __m128d py = _mm_unpackhi_pd(p, p);
+            p = _mm_add_pd(_mm_add_pd(_mm_mul_pd(px, m0), _mm_mul_pd(py, m1)), t);
+            _mm_storeu_pd(xy, p);
+        }
+#else
+        for(unsigned i = 0; i < num; i++, xy += 2)
+        {
+            m.transform(xy, xy + 1);
+        }
+#endif
+    }
+
+    //-------------------------------------------------------vertex_block_adaptor
+    // Classic vertex source -> block source.
+    template<class VertexSource> class vertex_block_adaptor
+    {
+    public:
+        explicit vertex_block_adaptor(VertexSource& source) : m_source(&source) {}
+        void attach(VertexSource& source) { m_source = &source; }
+
+        void rewind(unsigned path_id)
+        {
+            m_source->rewind(path_id);
+        }
+
+        unsigned vertices(double* xy, unsigned* cmd, unsigned max_count)
+        {
+            unsigned i;
+            for(i = 0; i < max_count; i++, xy += 2)
+            {
+                xy[0] = 0.0;
+                xy[1] = 0.0;
+                unsigned c = m_source->vertex(xy, xy + 1);
+                if(is_stop(c)) break;
+                cmd[i] = c;
+            }
+            return i;
+        }
+
+    private:
+        VertexSource* m_source;
+    };
+
+    //------------------------------------------------vertex_source_block_adaptor
+    // Block source -> classic vertex source.
+    template<class BlockSource, unsigned BlockSize=vertex_block_size>
+    class vertex_source_block_adaptor
+    {
+    public:
+        explicit vertex_source_block_adaptor(BlockSource& source) :
+            m_source(&source), m_index(0), m_size(0) {}
+        void attach(BlockSource& source) { m_source = &source; }
+
+        void rewind(unsigned path_id)
+        {
+            m_source->rewind(path_id);
+            m_index = 0;
+            m_size = 0;
+        }
+
+        unsigned vertex(double* x, double* y)
+        {
+            if(m_index >= m_size)
+            {
+                m_size = m_source->vertices(m_xy, m_cmd, BlockSize);
+                m_index = 0;
+                if(m_size == 0) return path_cmd_stop;
+            }
+
+            *x = m_xy[m_index * 2];
+            *y = m_xy[m_index * 2 + 1];
+            return m_cmd[m_index++];
+        }
+
+    private:
+        BlockSource* m_source;
+        unsigned     m_index;
+        unsigned     m_size;
+        unsigned     m_cmd[BlockSize];
+        double       m_xy[BlockSize * 2];
+    };
+
+    //-------------------------------------------------------conv_transform_block
+    // Block counterpart of conv_transform, transforms whole blocks at once.
+    template<class BlockSource, class Transformer=trans_affine>
+    class conv_transform_block
+    {
+    public:
+        conv_transform_block(BlockSource& source, const Transformer& tr) :
+            m_source(&source), m_trans(&tr) {}
+        void attach(BlockSource& source) { m_source = &source; }
+        void transformer(const Transformer& tr) { m_trans = &tr; }
+
+        void rewind(unsigned path_id)
+        {
+            m_source->rewind(path_id);
+        }
+
+        unsigned vertices(double* xy, unsigned* cmd, unsigned max_count)
+        {
+            unsigned num = m_source->vertices(xy, cmd, max_count);
+            trans_affine_transform_block(*m_trans, xy, num);
+            return num;
+        }
+
+    private:
+        BlockSource*       m_source;
+        const Transformer* m_trans;
+    };
+
+    //-------------------------------------------------------------add_path_block
+    // Block counterpart of rasterizer's add_path(). Consecutive vertices
+    // that aren't move_to are added by a single line_to_block_d() call, so
+    // segments of blocks that don't need clipping go directly to the cell
+    // generator. Works with rasterizer_scanline_aa and its nogamma variant.
+    template<class Rasterizer, class BlockSource>
+    void add_path_block(Rasterizer& ras, BlockSource& vs, unsigned path_id=0)
+    {
+        unsigned cmd[vertex_block_size];
+        double xy[vertex_block_size * 2];
+
+        vs.rewind(path_id);
+        if(ras.sorted()) ras.reset();
+        for(;;)
+        {
+            unsigned num = vs.vertices(xy, cmd, vertex_block_size);
+            if(num == 0) break;
+
+            unsigned i = 0;
+            while(i < num)
+            {
+                unsigned c = cmd[i];
+                if(is_move_to(c))
+                {
+                    ras.move_to_d(xy[i * 2], xy[i * 2 + 1]);
+                    i++;
+                }
+                else
+                if(is_vertex(c))
+                {
+                    unsigned start = i;
+                    while(++i < num && is_vertex(cmd[i]) && !is_move_to(cmd[i])) {}
+                    ras.line_to_block_d(xy + start * 2, i - start);
+                }
+                else
+                {
+                    if(is_close(c)) ras.close_polygon();
+                    i++;
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -17,6 +17,11 @@
 #include "agg_curves.h"
 #include "agg_math.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGG_CURVES_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace agg
 {
 
@@ -25,6 +30,7 @@ namespace agg
     const double curve_collinearity_epsilon              = 1e-30;
     const double curve_angle_tolerance_epsilon           = 0.01;
     enum curve_recursion_limit_e { curve_recursion_limit = 32 };
+    enum curve_fd_step_limit_e { curve_fd_step_limit = 1024 };
 
 
 
@@ -608,6 +614,135 @@ namespace agg
         recursive_bezier(x1, y1, x2, y2, x3, y3, x4, y4, 0);
         m_points.add(point_d(x4, y4));
     }
+    //------------------------------------------------------------------------
+    // Wang's formula: flattening a bezier of degree n into k uniform steps
+    // keeps the error below tolerance when
+    //
+    //     k >= sqrt(n * (n - 1) / 8 * max|P[i] - 2P[i+1] + P[i+2]| / tolerance)
+    //
+    static unsigned curve_fd_steps(double dd, double k)
+    {
+        double steps = ceil(sqrt(dd * k));
+        if(!(steps >= 1.0)) return 1;
+        if(steps >= double(curve_fd_step_limit)) return curve_fd_step_limit;
+        return unsigned(steps);
+    }
+
+    //------------------------------------------------------------------------
+    // Writes points[1] to points[num_steps - 1] by forward differencing, the
+    // caller stores both end-points. Differences are passed as (x, y) pairs.
+    static void curve_fd_eval(point_d* points, unsigned num_steps,
+                              const double* f, const double* df,
+                              const double* ddf, const double* dddf)
+    {
+#ifdef AGG_CURVES_SSE2
+        __m128d vf    = _mm_loadu_pd(f);
+        __m128d vdf   = _mm_loadu_pd(df);
+        __m128d vddf  = _mm_loadu_pd(ddf);
+        __m128d vdddf = _mm_loadu_pd(dddf);
+
+        for(unsigned i = 1; i < num_steps; i++)
+        {
+            vf   = _mm_add_pd(vf, vdf);
+            vdf  = _mm_add_pd(vdf, vddf);
+            vddf = _mm_add_pd(vddf, vdddf);
+            _mm_storeu_pd(&points[i].x, vf);
+        }
+#else
+        double fx    = f[0],    fy    = f[1];
+        double dfx   = df[0],   dfy   = df[1];
+        double ddfx  = ddf[0],  ddfy  = ddf[1];
+        double dddfx = dddf[0], dddfy = dddf[1];
+
+        for(unsigned i = 1; i < num_steps; i++)
+        {
+            fx   += dfx;   fy   += dfy;
+            dfx  += ddfx;  dfy  += ddfy;
+            ddfx += dddfx; ddfy += dddfy;
+            points[i].x = fx;
+            points[i].y = fy;
+        }
+#endif
+    }
+
+    //------------------------------------------------------------------------
+    void curve3_fd::init(double x1, double y1, 
+                         double x2, double y2, 
+                         double x3, double y3)
+    {
+        // Power basis: B(t) = a*t^2 + b*t + P1.
+        double ax = x1 - x2 * 2.0 + x3;
+        double ay = y1 - y2 * 2.0 + y3;
+        double bx = (x2 - x1) * 2.0;
+        double by = (y2 - y1) * 2.0;
+
+        double tolerance = 0.5 / m_approximation_scale;
+        unsigned num_steps = curve_fd_steps(sqrt(ax * ax + ay * ay), 0.25 / tolerance);
+
+        double h  = 1.0 / num_steps;
+        double h2 = h * h;
+
+        double f[2]    = { x1, y1 };
+        double df[2]   = { ax * h2 + bx * h, ay * h2 + by * h };
+        double ddf[2]  = { ax * h2 * 2.0, ay * h2 * 2.0 };
+        double dddf[2] = { 0.0, 0.0 };
+
+        m_points.allocate(num_steps + 1, 16);
+        point_d* points = m_points.data();
+
+        points[0].x = x1;
+        points[0].y = y1;
+        curve_fd_eval(points, num_steps, f, df, ddf, dddf);
+        points[num_steps].x = x3;
+        points[num_steps].y = y3;
+
+        m_count = 0;
+    }
+
+    //------------------------------------------------------------------------
+    void curve4_fd::init(double x1, double y1, 
+                         double x2, double y2, 
+                         double x3, double y3,
+                         double x4, double y4)
+    {
+        double d1x = x1 - x2 * 2.0 + x3;
+        double d1y = y1 - y2 * 2.0 + y3;
+        double d2x = x2 - x3 * 2.0 + x4;
+        double d2y = y2 - y3 * 2.0 + y4;
+        double dd1 = d1x * d1x + d1y * d1y;
+        double dd2 = d2x * d2x + d2y * d2y;
+
+        double tolerance = 0.5 / m_approximation_scale;
+        unsigned num_steps = curve_fd_steps(sqrt(dd1 > dd2 ? dd1 : dd2), 0.75 / tolerance);
+
+        // Power basis: B(t) = a*t^3 + b*t^2 + c*t + P1.
+        double ax = x4 - x1 + (x2 - x3) * 3.0;
+        double ay = y4 - y1 + (y2 - y3) * 3.0;
+        double bx = d1x * 3.0;
+        double by = d1y * 3.0;
+        double cx = (x2 - x1) * 3.0;
+        double cy = (y2 - y1) * 3.0;
+
+        double h  = 1.0 / num_steps;
+        double h2 = h * h;
+        double h3 = h2 * h;
+
+        double f[2]    = { x1, y1 };
+        double df[2]   = { ax * h3 + bx * h2 + cx * h, ay * h3 + by * h2 + cy * h };
+        double ddf[2]  = { ax * h3 * 6.0 + bx * h2 * 2.0, ay * h3 * 6.0 + by * h2 * 2.0 };
+        double dddf[2] = { ax * h3 * 6.0, ay * h3 * 6.0 };
+
+        m_points.allocate(num_steps + 1, 16);
+        point_d* points = m_points.data();
+
+        points[0].x = x1;
+        points[0].y = y1;
+        curve_fd_eval(points, num_steps, f, df, ddf, dddf);
+        points[num_steps].x = x4;
+        points[num_steps].y = y4;
+
+        m_count = 0;
+    }
 
 }
 
@@ -21,17 +21,23 @@
 //    misrepresented as being the original software.
 // 3. This notice may not be removed or altered from any source distribution.
 
+#include <algorithm>
 #include <dirent.h>
+#include <math.h>
 #include <sys/stat.h>
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <limits>
 #include <type_traits>
 
 #include "./app.h"
 #include "./images_data.h"
 #include "./module_blend2d.h"
+#include "./module_plugin.h"
 
 #if defined(BLBENCH_ENABLE_AGG)
+  #include "./microbench_agg.h"
   #include "./module_agg.h"
 #endif // BLBENCH_ENABLE_AGG
 
@@ -73,6 +79,13 @@ static const char* benchIdNameList[] = {
   "FillPolyNZi40",
   "FillPolyEOi40",
   "FillWorld",
+  "FillMasked",
+  "GouraudMesh",
+  "BatchRectA",
+  "BatchRectU",
+  "BatchPolyNZi10",
+  "FillPathBuild",
+  "FillPathReuse",
   "StrokeRectA",
   "StrokeRectU",
   "StrokeRectRot",
@@ -82,7 +95,14 @@ static const char* benchIdNameList[] = {
   "StrokePoly10",
   "StrokePoly20",
   "StrokePoly40",
-  "StrokeWorld"
+  "StrokeWorld",
+  "HairlineSegment",
+  "HairlinePoly10",
+  "HairlineGrid",
+  "StateNone",
+  "StateSave",
+  "StateStyle",
+  "StateTransform"
 };
 
 static const char* benchCompOpList[] = {
@@ -131,14 +151,42 @@ static const char* benchStyleModeList[] = {
   "Pattern_BI"
 };
 
+// Indexed by BLFormat.
+static const char* benchFormatList[] = {
+  "None",
+  "PRGB32",
+  "XRGB32",
+  "A8"
+};
+
+// Indexed by BenchSurfaceMemory.
+static const char* benchSurfaceMemoryList[] = {
+  "default",
+  "thp",
+  "hugetlb"
+};
+
 static const int benchShapeSizeList[] = {
   8, 16, 32, 64, 128, 256
 };
 
+static_assert(ARRAY_SIZE(benchShapeSizeList) == BenchResult::kSizeCount,
+              "BenchResult must hold a duration of each shape size");
+
 const char benchBorderStr[] = "+--------------------+-------------+---------------+-------+-------+-------+-------+-------+-------+\n";
 const char benchHeaderStr[] = "|%-20s"             "| CompOp      | Style         | 8x8   | 16x16 | 32x32 | 64x64 |128x128|256x256|\n";
 const char benchDataFmt[]   = "|%-20s"             "| %-12s"     "| %-14s"       "| %-6s""| %-6s""| %-6s""| %-6s""| %-6s""| %-6s""|\n";
 
+const char* benchIdName(uint32_t benchId) {
+  return benchId < ARRAY_SIZE(benchIdNameList) ? benchIdNameList[benchId] : "Unknown";
+}
+
+// Tests that ignore the style only run with kBenchStyleSolid, other styles
+// would repeat the same work.
+static bool benchIdUsesStyle(uint32_t benchId) {
+  return benchId != kBenchIdFillGouraudMesh;
+}
+
 static uint32_t searchStringList(const char** listData, size_t listSize, const char* key) {
   for (size_t i = 0; i < listSize; i++)
     if (strcmp(listData[i], key) == 0)
@@ -165,10 +213,21 @@ BenchApp::BenchApp(int argc, char** argv)
   : _argc(argc),
     _argv(argv),
     _isolated(false),
+    _persistent(false),
     _deepBench(false),
     _saveImages(false),
+    _formats(1u << BL_FORMAT_PRGB32),
+    _screenW(600),
+    _screenH(512),
+    _surfaceMemory(kBenchSurfaceMemoryDefault),
+    _surfaceNode(-1),
+    _surfacePadding(0),
+    _plugin(NULL),
+    _abPlugins(NULL),
     _repeat(1),
-    _quantity(1000) {}
+    _quantity(1000),
+    _aggOptions(0),
+    _aggMicroBenches(0) {}
 BenchApp::~BenchApp() {}
 
 // ============================================================================
@@ -223,11 +282,103 @@ int BenchApp::intValueOf(const char* key, int defaultValue) const {
 
 bool BenchApp::init() {
   _isolated = hasArg("--isolated");
+  _persistent = hasArg("--persistent");
   _deepBench = hasArg("--deep");
   _saveImages = hasArg("--save");
   _compOp = 0xFFFFFFFFu;
   _repeat = intValueOf("--repeat", 1);
   _quantity = intValueOf("--quantity", 1000);
+  _tuneThreads = intValueOf("--threads", 4);
+  _flushEvery = intValueOf("--flush-every", 0);
+  _queueSweep = hasArg("--queue-sweep");
+  _aggOptions = 0;
+  _aggMicroBenches = 0;
+
+  // A comma separated list of destination formats, each runs the whole suite.
+  const char* formatNames = valueOf("--format");
+  if (formatNames != NULL) {
+    _formats = 0;
+    for (const char* p = formatNames; ; p++) {
+      const char* end = strchr(p, ',');
+      size_t size = end ? size_t(end - p) : strlen(p);
+
+      uint32_t format = 0;
+      for (uint32_t i = 1; i < BL_FORMAT_COUNT; i++) {
+        if (strlen(benchFormatList[i]) == size && strncasecmp(benchFormatList[i], p, size) == 0) {
+          format = i;
+          break;
+        }
+      }
+
+      if (!format) {
+        printf("ERROR: Invalid format [%.*s] specified\n", int(size), p);
+        return false;
+      }
+
+      _formats |= 1u << format;
+      if (!end)
+        break;
+      p = end;
+    }
+  }
+
+  const char* screenSize = valueOf("--screen");
+  if (screenSize != NULL) {
+    if (sscanf(screenSize, "%ux%u", &_screenW, &_screenH) != 2 ||
+        _screenW < 256 || _screenW > 16384 || _screenH < 256 || _screenH > 16384) {
+      printf("ERROR: Invalid screen size [%s] specified\n", screenSize);
+      return false;
+    }
+  }
+
+  const char* surfaceMemory = valueOf("--surface-memory");
+  if (surfaceMemory != NULL) {
+    _surfaceMemory = searchStringList(benchSurfaceMemoryList, ARRAY_SIZE(benchSurfaceMemoryList), surfaceMemory);
+    if (_surfaceMemory == 0xFFFFFFFFu) {
+      printf("ERROR: Invalid surface memory [%s] specified\n", surfaceMemory);
+      return false;
+    }
+  }
+
+  _plugin = valueOf("--plugin");
+  _abPlugins = valueOf("--ab");
+
+  if (_abPlugins != NULL && strchr(_abPlugins, ',') == NULL) {
+    printf("ERROR: Invalid A/B plugins [%s] specified (expected A,B)\n", _abPlugins);
+    return false;
+  }
+
+  // Plugin modules only run next to the regular modules and A/B plugins only
+  // receive BenchPluginParams, reject options that would be silently ignored.
+  if (_plugin != NULL && (_isolated || _abPlugins != NULL)) {
+    printf("ERROR: --plugin can't be combined with %s\n", _isolated ? "--isolated" : "--ab");
+    return false;
+  }
+
+  if (_abPlugins != NULL && (_persistent || _flushEvery || _queueSweep)) {
+    printf("ERROR: --ab can't be combined with --persistent, --flush-every or --queue-sweep\n");
+    return false;
+  }
+
+  _surfaceNode = intValueOf("--numa-node", -1);
+  _surfacePadding = intValueOf("--stride-pad", 0);
+
+  #if defined(BLBENCH_ENABLE_AGG)
+  if (hasArg("--agg-cache")) _aggOptions |= AGGModule::kOptionCoverageCache;
+  if (hasArg("--agg-block")) _aggOptions |= AGGModule::kOptionBlockPipeline;
+  if (hasArg("--agg-gradient")) _aggOptions |= AGGModule::kOptionSimdGradient;
+  if (hasArg("--agg-image")) _aggOptions |= AGGModule::kOptionSimdImage;
+  if (hasArg("--agg-outline")) _aggOptions |= AGGModule::kOptionOutlineAA;
+  if (hasArg("--agg-gamma")) _aggOptions |= AGGModule::kOptionGamma | AGGModule::kOptionGammaSimd;
+  if (hasArg("--agg-mask")) _aggOptions |= AGGModule::kOptionSimdMask;
+  if (hasArg("--agg-integer")) _aggOptions |= AGGModule::kOptionIntegerPath;
+  if (hasArg("--agg-gouraud")) _aggOptions |= AGGModule::kOptionSimdGouraud;
+  if (hasArg("--agg-curves")) _aggMicroBenches |= AGGMicroBench::kIdCurves;
+  if (hasArg("--agg-blur")) _aggMicroBenches |= AGGMicroBench::kIdBlur;
+  if (hasArg("--agg-compound")) _aggMicroBenches |= AGGMicroBench::kIdCompound;
+  if (hasArg("--agg-boolean")) _aggMicroBenches |= AGGMicroBench::kIdBoolean;
+  if (hasArg("--agg-glyphs")) _aggMicroBenches |= AGGMicroBench::kIdGlyphs;
+  #endif
 
   if (_repeat <= 0 || _repeat > 100) {
     printf("ERROR: Invalid repeat [%d] specified\n", _repeat);
@@ -239,6 +390,27 @@ bool BenchApp::init() {
     return false;
   }
 
+  if (_tuneThreads > 256) {
+    printf("ERROR: Invalid thread count [%d] specified\n", _tuneThreads);
+    return false;
+  }
+
+  if (_flushEvery > 100000) {
+    printf("ERROR: Invalid flush interval [%d] specified\n", _flushEvery);
+    return false;
+  }
+
+  if (_surfaceNode < -1 || _surfaceNode > 1023) {
+    printf("ERROR: Invalid NUMA node [%d] specified\n", _surfaceNode);
+    return false;
+  }
+
+  // A multiple of 16 keeps rows aligned for SIMD stores of all backends.
+  if (_surfacePadding > 65536 || _surfacePadding % 16 != 0) {
+    printf("ERROR: Invalid stride padding [%u] specified (must be a multiple of 16)\n", _surfacePadding);
+    return false;
+  }
+
   const char* compOpName = valueOf("--compOp");
   if (compOpName != NULL)
     _compOp = searchStringList(benchCompOpList, ARRAY_SIZE(benchCompOpList), compOpName);
@@ -255,6 +427,16 @@ void BenchApp::info() {
   BLRuntimeBuildInfo buildInfo;
   BLRuntime::queryBuildInfo(&buildInfo);
 
+  char formatNames[64];
+  formatNames[0] = '\0';
+  for (uint32_t format = 1; format < BL_FORMAT_COUNT; format++) {
+    if (_formats & (1u << format)) {
+      if (formatNames[0])
+        strcat(formatNames, ",");
+      strcat(formatNames, benchFormatList[format]);
+    }
+  }
+
   const char no_yes[][4] = { "no", "yes" };
 
   printf(
@@ -276,14 +458,79 @@ void BenchApp::info() {
     "  --save       [%s] Save all generated images as .bmp files\n"
     "  --deep       [%s] More tests that use gradients and textures\n"
     "  --isolated   [%s] Use Blend2D isolated context (useful for development)\n"
+    "  --persistent [%s] Also run Blend2D with a context kept alive across runs\n"
     "  --repeat=N   [%d] Number of repeats of each test to select the best time\n"
     "  --quantity=N [%d] Override the default quantity of each operation\n"
+    "  --format=L   [%s] Destination formats to run (comma separated prgb32, xrgb32, a8)\n"
+    "  --screen=WxH [%ux%u] Size of the surface, e.g. 3840x2160 (4K) or 7680x4320 (8K)\n"
+    "\n"
+    "Plugins (modules built as shared libraries, see plugin.h):\n"
+    "  --plugin=P   [%s] Also run the modules of plugin P (not with --isolated)\n"
+    "  --ab=A,B     [%s] Only run plugins A and B, interleaved cell by cell\n"
+    "\n"
+    "Surface memory (mapped by the harness if any differs from the default):\n"
+    "  --surface-memory=M [%s] Allocation (default, thp, hugetlb)\n"
+    "  --numa-node=N      [%d] Bind the memory to a NUMA node (-1 means not bound)\n"
+    "  --stride-pad=N     [%u] Bytes added to the stride (multiple of 16)\n"
+    "\n"
+    "Blend2D tuning (each setting runs as a separate Blend2D module):\n"
+    "  --queue-sweep   [%s] Sweep BLContextCreateInfo::commandQueueLimit\n"
+    "  --flush-every=K [%u] Flush (sync) every K operations to simulate frames\n"
+    "  --threads=N     [%u] Thread count of tuning modules\n"
     "\n",
     no_yes[_deepBench],
     no_yes[_saveImages],
     no_yes[_isolated],
+    no_yes[_persistent],
     _repeat,
-    _quantity);
+    _quantity,
+    formatNames,
+    _screenW,
+    _screenH,
+    _plugin ? _plugin : "none",
+    _abPlugins ? _abPlugins : "none",
+    benchSurfaceMemoryList[_surfaceMemory],
+    _surfaceNode,
+    _surfacePadding,
+    no_yes[_queueSweep],
+    _flushEvery,
+    _tuneThreads);
+
+  #if defined(BLBENCH_ENABLE_AGG)
+  printf(
+    "AGG options (each enabled option runs as a separate AGG module):\n"
+    "  --agg-cache    [%s] Replay cached coverage of translated shapes\n"
+    "  --agg-block    [%s] Process vertices in blocks instead of one by one\n"
+    "  --agg-gradient [%s] Use SSE2 gradient spans and cache gradient LUTs\n"
+    "  --agg-image    [%s] Use SSE2 nearest and bilinear image filters\n"
+    "  --agg-outline  [%s] Render solid hairlines by the outline rasterizer\n"
+    "  --agg-gamma    [%s] Apply gamma by the gamma rasterizer and by SSE2 cover spans\n"
+    "  --agg-mask     [%s] Combine covers with the alpha mask by SSE2\n"
+    "  --agg-integer  [%s] Fill polygons and shapes by integer vertices\n"
+    "  --agg-gouraud  [%s] Use SSE2 Gouraud spans\n"
+    "\n"
+    "AGG micro-benchmarks (run after all modules):\n"
+    "  --agg-curves   [%s] Compare curve flattening methods\n"
+    "  --agg-blur     [%s] Compare blur filters\n"
+    "  --agg-compound [%s] Compare compound rendering of a map to per-path rendering\n"
+    "  --agg-boolean  [%s] Compare scanline boolean operations\n"
+    "  --agg-glyphs   [%s] Compare per-instance glyph caches to a shared one\n"
+    "\n",
+    no_yes[(_aggOptions & AGGModule::kOptionCoverageCache) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionBlockPipeline) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionSimdGradient) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionSimdImage) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionOutlineAA) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionGamma) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionSimdMask) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionIntegerPath) != 0],
+    no_yes[(_aggOptions & AGGModule::kOptionSimdGouraud) != 0],
+    no_yes[(_aggMicroBenches & AGGMicroBench::kIdCurves) != 0],
+    no_yes[(_aggMicroBenches & AGGMicroBench::kIdBlur) != 0],
+    no_yes[(_aggMicroBenches & AGGMicroBench::kIdCompound) != 0],
+    no_yes[(_aggMicroBenches & AGGMicroBench::kIdBoolean) != 0],
+    no_yes[(_aggMicroBenches & AGGMicroBench::kIdGlyphs) != 0]);
+  #endif
 }
 
 bool BenchApp::readImage(BLImage& image, const char* name, const void* data, size_t size) noexcept {
@@ -314,6 +561,15 @@ bool BenchApp::isStyleEnabled(uint32_t style) {
          style == kBenchStylePatternBI ;
 }
 
+void BenchApp::formatStyleName(char* out, uint32_t style) const {
+  // Remove '@' from the style name if not running a deep benchmark.
+  strcpy(out, benchStyleModeList[style]);
+  if (!_deepBench) {
+    char* x = strchr(out, '@');
+    if (x != NULL) x[0] = '\0';
+  }
+}
+
 // ============================================================================
 // [bench::BenchApp - Run]
 // ============================================================================
@@ -322,48 +578,156 @@ int BenchApp::run() {
   BenchParams params;
   memset(&params, 0, sizeof(params));
 
-  params.screenW = 600;
-  params.screenH = 512;
+  params.screenW = _screenW;
+  params.screenH = _screenH;
+  params.surfaceMemory = _surfaceMemory;
+  params.surfaceNode = _surfaceNode;
+  params.surfacePadding = _surfacePadding;
 
-  params.format = BL_FORMAT_PRGB32;
   params.quantity = _quantity;
   params.strokeWidth = 2.0;
 
+  // Plugins are loaded once and stay loaded until all formats are done.
+  PluginLibrary plugin;
+  PluginLibrary abPlugins[2];
+
+  if (_abPlugins) {
+    char paths[2][512];
+    const char* comma = strchr(_abPlugins, ',');
+    snprintf(paths[0], ARRAY_SIZE(paths[0]), "%.*s", int(comma - _abPlugins), _abPlugins);
+    snprintf(paths[1], ARRAY_SIZE(paths[1]), "%s", comma + 1);
+
+    for (uint32_t i = 0; i < 2; i++) {
+      if (!abPlugins[i].load(paths[i]))
+        return 1;
+      printf("%c: %s (%s)\n", 'A' + i, paths[i], abPlugins[i]._api->library());
+    }
+    printf("\n");
+  }
+  else if (_plugin) {
+    if (!plugin.load(_plugin))
+      return 1;
+  }
+
+  // The whole suite runs per destination format, modules skip formats they
+  // can't render to.
+  bool printFormat = _formats != (1u << BL_FORMAT_PRGB32);
+  for (uint32_t format = 1; format < BL_FORMAT_COUNT; format++) {
+    if (!(_formats & (1u << format)))
+      continue;
+
+    if (printFormat)
+      printf("\nDestination format: %s\n\n", benchFormatList[format]);
+
+    params.format = BLFormat(format);
+    if (_abPlugins)
+      runPluginsAB(abPlugins[0], abPlugins[1], params);
+    else
+      runModules(params, _plugin ? &plugin : nullptr);
+  }
+
+  // Micro-benchmarks don't depend on the destination format or on the Blend2D
+  // context options, so they run once. They only compare with the Blend2D the
+  // tool is linked to, not with plugins.
+  #if defined(BLBENCH_ENABLE_AGG)
+  if (_aggMicroBenches) {
+    if (_abPlugins) {
+      printf("AGG micro-benchmarks are skipped in --ab mode\n");
+    }
+    else {
+      AGGMicroBench microBench(_quantity, _repeat);
+      microBench.run(_aggMicroBenches);
+    }
+  }
+  #endif
+
+  return 0;
+}
+
+void BenchApp::runModules(BenchParams& params, const PluginLibrary* plugin) {
   if (_isolated) {
     BLRuntimeSystemInfo si;
     BLRuntime::querySystemInfo(&si);
 
-    // Only use features that could actually make a difference.
+    // Only use features that could actually make a difference. Each level
+    // includes all the levels below it, so the JIT is restricted to exactly
+    // what the label says. The Blend2D version used here doesn't have any
+    // AVX-512 feature to select, AVX2 is the widest level it can generate.
     static const uint32_t x86Features[] = {
       BL_RUNTIME_CPU_FEATURE_X86_SSE2,
-      BL_RUNTIME_CPU_FEATURE_X86_SSSE3,
-      BL_RUNTIME_CPU_FEATURE_X86_SSE4_1
+      BL_RUNTIME_CPU_FEATURE_X86_SSE2 | BL_RUNTIME_CPU_FEATURE_X86_SSE3 | BL_RUNTIME_CPU_FEATURE_X86_SSSE3,
+      BL_RUNTIME_CPU_FEATURE_X86_SSE2 | BL_RUNTIME_CPU_FEATURE_X86_SSE3 | BL_RUNTIME_CPU_FEATURE_X86_SSSE3 |
+      BL_RUNTIME_CPU_FEATURE_X86_SSE4_1,
+      BL_RUNTIME_CPU_FEATURE_X86_SSE2 | BL_RUNTIME_CPU_FEATURE_X86_SSE3 | BL_RUNTIME_CPU_FEATURE_X86_SSSE3 |
+      BL_RUNTIME_CPU_FEATURE_X86_SSE4_1 | BL_RUNTIME_CPU_FEATURE_X86_SSE4_2 | BL_RUNTIME_CPU_FEATURE_X86_AVX,
+      BL_RUNTIME_CPU_FEATURE_X86_SSE2 | BL_RUNTIME_CPU_FEATURE_X86_SSE3 | BL_RUNTIME_CPU_FEATURE_X86_SSSE3 |
+      BL_RUNTIME_CPU_FEATURE_X86_SSE4_1 | BL_RUNTIME_CPU_FEATURE_X86_SSE4_2 | BL_RUNTIME_CPU_FEATURE_X86_AVX |
+      BL_RUNTIME_CPU_FEATURE_X86_AVX2
     };
 
     const uint32_t* features = x86Features;
     uint32_t featureCount = ARRAY_SIZE(x86Features);
 
+    // Results of each level the CPU supports, compared to SSE2 at the end.
+    BenchResults results[ARRAY_SIZE(x86Features)];
+    char names[ARRAY_SIZE(x86Features)][64];
+    bool available[ARRAY_SIZE(x86Features)];
+
     for (uint32_t i = 0; i < featureCount; i++) {
-      if ((si.cpuFeatures & features[i]) == features[i]) {
+      available[i] = (si.cpuFeatures & features[i]) == features[i];
+      if (available[i]) {
         Blend2DModule mod(0, features[i]);
-        runModule(mod, params);
+        runModule(mod, params, &results[i]);
+        strcpy(names[i], mod._name);
+
+        if (_persistent) {
+          Blend2DModule steadyMod(0, features[i], true);
+          runModule(steadyMod, params);
+        }
+      }
+    }
+
+    if (available[0] && !results[0].empty()) {
+      for (uint32_t i = 1; i < featureCount; i++) {
+        if (available[i])
+          printSpeedup(names[i], names[0], results[i], results[0]);
       }
     }
   }
   else {
-    {
-      Blend2DModule mod(0);
-      runModule(mod, params);
+    // The steady-state variant keeps its context alive and follows the
+    // regular one, so the cost of per-run setup can be compared directly.
+    static const uint32_t threadCounts[] = { 0, 2, 4 };
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(threadCounts); i++) {
+      {
+        Blend2DModule mod(threadCounts[i]);
+        runModule(mod, params);
+      }
+
+      if (_persistent) {
+        Blend2DModule mod(threadCounts[i], 0, true);
+        runModule(mod, params);
+      }
     }
 
-    {
-      Blend2DModule mod(2);
-      runModule(mod, params);
+    // Tuning modules, the default queue limit (0) is included in the sweep.
+    if (_queueSweep || _flushEvery) {
+      static const uint32_t queueLimits[] = { 0, 64, 256, 1024, 4096 };
+      uint32_t queueLimitCount = _queueSweep ? uint32_t(ARRAY_SIZE(queueLimits)) : 1u;
+
+      for (uint32_t i = 0; i < queueLimitCount; i++) {
+        Blend2DModule mod(_tuneThreads, 0, false, true, queueLimits[i], _flushEvery);
+        runModule(mod, params);
+      }
     }
 
-    {
-      Blend2DModule mod(4);
-      runModule(mod, params);
+    if (plugin) {
+      for (uint32_t i = 0; i < plugin->_api->moduleCount; i++) {
+        PluginModule mod(*plugin, i, "Plugin");
+        if (mod.isValid())
+          runModule(mod, params);
+      }
     }
 
     #if defined(BLBENCH_ENABLE_QT)
@@ -399,20 +763,38 @@ int BenchApp::run() {
       AGGModule mod;
       runModule(mod, params);
     }
+
+    // Each AGG option is benchmarked in isolation so it can be compared to the default AGG run.
+    for (uint32_t option = 1; option <= AGGModule::kOptionAll; option <<= 1) {
+      if (_aggOptions & option) {
+        AGGModule mod(option);
+        runModule(mod, params);
+      }
+    }
     #endif
 
   }
-
-  return 0;
 }
 
-int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
+int BenchApp::runModule(BenchModule& mod, BenchParams& params, BenchResults* results) {
   char fileName[256];
   char styleString[128];
 
   uint64_t localDuration[ARRAY_SIZE(benchShapeSizeList)];
   uint64_t totalDuration[ARRAY_SIZE(benchShapeSizeList)];
   DurationFormat durationFormat[ARRAY_SIZE(benchShapeSizeList)];
+  BenchResults tableResults;
+
+  if (!mod.supportsFormat(params.format)) {
+    printf("%s doesn't support %s destination, skipping...\n", mod._name, benchFormatList[params.format]);
+    return 0;
+  }
+
+  // Images of other formats than the default are saved to separate directories.
+  char formatSuffix[16];
+  formatSuffix[0] = '\0';
+  if (params.format != BL_FORMAT_PRGB32)
+    sprintf(formatSuffix, "-%s", benchFormatList[params.format]);
 
   uint32_t compOpFirst = BL_COMP_OP_SRC_OVER;
   uint32_t compOpLast  = BL_COMP_OP_SRC_COPY;
@@ -434,20 +816,19 @@ int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
         continue;
       params.style = style;
 
-      // Remove '@' from the style name if not running a deep benchmark.
-      strcpy(styleString, benchStyleModeList[style]);
-      if (!_deepBench) {
-        char* x = strchr(styleString, '@');
-        if (x != NULL) x[0] = '\0';
-      }
+      formatStyleName(styleString, style);
 
       memset(totalDuration, 0, sizeof(totalDuration));
+      tableResults.clear();
+      mod.resetStats();
 
       printf(benchBorderStr);
       printf(benchHeaderStr, mod._name);
       printf(benchBorderStr);
 
       for (uint32_t testId = 0; testId < kBenchIdCount; testId++) {
+        if (style != kBenchStyleSolid && !benchIdUsesStyle(testId))
+          continue;
         params.benchId = testId;
 
         for (uint32_t sizeId = 0; sizeId < ARRAY_SIZE(benchShapeSizeList); sizeId++) {
@@ -455,7 +836,7 @@ int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
 
           uint64_t duration = std::numeric_limits<uint64_t>::max();
           for (uint32_t attempt = 0; attempt < _repeat; attempt++) {
-            mod.run(*this, params);
+            mod.run(_sprites, params);
 
             if (duration > mod._duration)
               duration = mod._duration;
@@ -467,13 +848,14 @@ int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
           if (_saveImages) {
             // Save only the last two as these are easier to compare visually.
             if (sizeId >= ARRAY_SIZE(benchShapeSizeList) - 2) {
-              sprintf(fileName, "save-%s", mod._name);
+              sprintf(fileName, "save-%s%s", mod._name, formatSuffix);
               struct stat st;
               if( stat( fileName, &st ) != 0 ) {
                 mkdir( fileName, 0755);
               }
-              sprintf(fileName, "save-%s/%s-%s-%s-%c.bmp",
+              sprintf(fileName, "save-%s%s/%s-%s-%s-%c.bmp",
                 mod._name,
+                formatSuffix,
                 benchIdNameList[params.benchId],
                 benchCompOpList[params.compOp],
                 styleString,
@@ -486,6 +868,13 @@ int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
         for (uint32_t sizeId = 0; sizeId < ARRAY_SIZE(benchShapeSizeList); sizeId++)
           durationFormat[sizeId].format(localDuration[sizeId]);
 
+        BenchResult result;
+        result.compOp = params.compOp;
+        result.style = params.style;
+        result.benchId = params.benchId;
+        memcpy(result.duration, localDuration, sizeof(result.duration));
+        tableResults.push_back(result);
+
         printf(benchDataFmt,
           benchIdNameList[params.benchId],
           benchCompOpList[params.compOp],
@@ -512,6 +901,132 @@ int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
         durationFormat[3].data,
         durationFormat[4].data,
         durationFormat[5].data);
+      printf(benchBorderStr);
+      mod.printStats();
+      printBatching(tableResults, params.quantity);
+      printf("\n");
+
+      if (results)
+        results->insert(results->end(), tableResults.begin(), tableResults.end());
+    }
+  }
+
+  return 0;
+}
+
+void BenchApp::runPluginsAB(const PluginLibrary& a, const PluginLibrary& b, BenchParams& params) {
+  uint32_t moduleCount = std::min(a._api->moduleCount, b._api->moduleCount);
+
+  for (uint32_t i = 0; i < moduleCount; i++) {
+    PluginModule modA(a, i, "A");
+    PluginModule modB(b, i, "B");
+
+    if (!modA.isValid() || !modB.isValid()) {
+      printf("Failed to create module #%u of the plugins, skipping...\n", i);
+      continue;
+    }
+
+    BenchResults resultsA;
+    BenchResults resultsB;
+
+    runInterleaved(modA, modB, params, resultsA, resultsB);
+    if (!resultsA.empty())
+      printSpeedup(modB._name, modA._name, resultsB, resultsA);
+  }
+}
+
+int BenchApp::runInterleaved(BenchModule& a, BenchModule& b, BenchParams& params, BenchResults& resultsA, BenchResults& resultsB) {
+  char styleString[128];
+
+  if (!a.supportsFormat(params.format) || !b.supportsFormat(params.format)) {
+    printf("%s or %s doesn't support %s destination, skipping...\n", a._name, b._name, benchFormatList[params.format]);
+    return 0;
+  }
+
+  uint32_t compOpFirst = BL_COMP_OP_SRC_OVER;
+  uint32_t compOpLast  = BL_COMP_OP_SRC_COPY;
+
+  if (_compOp != 0xFFFFFFFFu) {
+    compOpFirst = compOpLast = _compOp;
+  }
+
+  // Each cell runs A and B alternately (ABAB...) and keeps the best time of
+  // each, so both see the same thermal and frequency state. Two attempts are
+  // the minimum, the first run of a cell warms up caches of both.
+  uint32_t attempts = std::max<uint32_t>(_repeat, 2);
+
+  for (uint32_t compOp = compOpFirst; compOp <= compOpLast; compOp++) {
+    if (!a.supportsCompOp(compOp) || !b.supportsCompOp(compOp))
+      continue;
+    params.compOp = BLCompOp(compOp);
+
+    for (uint32_t style = 0; style < kBenchStyleCount; style++) {
+      if (!isStyleEnabled(style) || !a.supportsStyle(style) || !b.supportsStyle(style))
+        continue;
+      params.style = style;
+
+      formatStyleName(styleString, style);
+
+      printf(benchBorderStr);
+      printf(benchHeaderStr, a._name);
+      printf(benchHeaderStr, b._name);
+      printf(benchBorderStr);
+
+      for (uint32_t testId = 0; testId < kBenchIdCount; testId++) {
+        if (style != kBenchStyleSolid && !benchIdUsesStyle(testId))
+          continue;
+        params.benchId = testId;
+
+        BenchResult resultA;
+        BenchResult resultB;
+
+        resultA.compOp = resultB.compOp = params.compOp;
+        resultA.style = resultB.style = params.style;
+        resultA.benchId = resultB.benchId = params.benchId;
+
+        for (uint32_t sizeId = 0; sizeId < ARRAY_SIZE(benchShapeSizeList); sizeId++) {
+          params.shapeSize = benchShapeSizeList[sizeId];
+
+          uint64_t durationA = std::numeric_limits<uint64_t>::max();
+          uint64_t durationB = std::numeric_limits<uint64_t>::max();
+
+          for (uint32_t attempt = 0; attempt < attempts; attempt++) {
+            a.run(_sprites, params);
+            durationA = std::min(durationA, a._duration);
+
+            b.run(_sprites, params);
+            durationB = std::min(durationB, b._duration);
+          }
+
+          resultA.duration[sizeId] = durationA;
+          resultB.duration[sizeId] = durationB;
+        }
+
+        resultsA.push_back(resultA);
+        resultsB.push_back(resultB);
+
+        const BenchResult* rows[2] = { &resultA, &resultB };
+        for (uint32_t i = 0; i < 2; i++) {
+          DurationFormat durationFormat[ARRAY_SIZE(benchShapeSizeList)];
+          for (uint32_t sizeId = 0; sizeId < ARRAY_SIZE(benchShapeSizeList); sizeId++)
+            durationFormat[sizeId].format(rows[i]->duration[sizeId]);
+
+          char nameString[32];
+          snprintf(nameString, ARRAY_SIZE(nameString), "%c %s", 'A' + i, benchIdNameList[testId]);
+
+          printf(benchDataFmt,
+            nameString,
+            benchCompOpList[params.compOp],
+            styleString,
+            durationFormat[0].data,
+            durationFormat[1].data,
+            durationFormat[2].data,
+            durationFormat[3].data,
+            durationFormat[4].data,
+            durationFormat[5].data);
+        }
+      }
+
       printf(benchBorderStr);
       printf("\n");
     }
@@ -520,6 +1035,140 @@ int BenchApp::runModule(BenchModule& mod, BenchParams& params) {
   return 0;
 }
 
+void BenchApp::printBatching(const BenchResults& results, uint32_t quantity) {
+  // Batched benchmarks and the unbatched ones that render the same shapes.
+  static const uint32_t pairs[][2] = {
+    { kBenchIdFillAlignedRect, kBenchIdBatchAlignedRect },
+    { kBenchIdFillSmoothRect , kBenchIdBatchSmoothRect  },
+    { kBenchIdFillPolygon10NZ, kBenchIdBatchPolygon10NZ }
+  };
+
+  char styleString[128];
+  char cells[3][BenchResult::kSizeCount][32];
+  bool headerPrinted = false;
+
+  if (!quantity)
+    return;
+
+  for (uint32_t i = 0; i < ARRAY_SIZE(pairs); i++) {
+    const BenchResult* rows[2] = { nullptr, nullptr };
+    for (const BenchResult& result : results) {
+      for (uint32_t j = 0; j < 2; j++) {
+        if (result.benchId == pairs[i][j])
+          rows[j] = &result;
+      }
+    }
+
+    if (!rows[0] || !rows[1])
+      continue;
+
+    // Nanoseconds per shape of both and the speedup of the batched one.
+    for (uint32_t sizeId = 0; sizeId < BenchResult::kSizeCount; sizeId++) {
+      for (uint32_t j = 0; j < 2; j++) {
+        double ns = double(rows[j]->duration[sizeId]) * 1000.0 / double(quantity);
+        snprintf(cells[j][sizeId], ARRAY_SIZE(cells[j][sizeId]), ns < 100.0 ? "%.1f" : "%.0f", ns);
+      }
+
+      if (rows[1]->duration[sizeId])
+        snprintf(cells[2][sizeId], ARRAY_SIZE(cells[2][sizeId]), "%.2fx", double(rows[0]->duration[sizeId]) / double(rows[1]->duration[sizeId]));
+      else
+        strcpy(cells[2][sizeId], "-");
+    }
+
+    if (!headerPrinted) {
+      printf(benchBorderStr);
+      printf(benchHeaderStr, "Batching [ns/shape]");
+      printf(benchBorderStr);
+      headerPrinted = true;
+    }
+
+    const char* names[3] = { benchIdNameList[pairs[i][0]], benchIdNameList[pairs[i][1]], "Speedup" };
+
+    formatStyleName(styleString, rows[0]->style);
+    for (uint32_t j = 0; j < 3; j++) {
+      printf(benchDataFmt,
+        names[j],
+        benchCompOpList[rows[0]->compOp],
+        styleString,
+        cells[j][0],
+        cells[j][1],
+        cells[j][2],
+        cells[j][3],
+        cells[j][4],
+        cells[j][5]);
+    }
+  }
+
+  if (headerPrinted)
+    printf(benchBorderStr);
+}
+
+void BenchApp::printSpeedup(const char* name, const char* baseName, const BenchResults& results, const BenchResults& baseResults) {
+  char title[128];
+  char styleString[128];
+  char speedupString[BenchResult::kSizeCount][32];
+
+  // A cell counts as a win when it's at least 10% faster than the base, and
+  // as a loss when the base is at least 10% faster.
+  const double kWinThreshold = 1.10;
+
+  uint32_t cellCount = 0;
+  uint32_t winCount = 0;
+  uint32_t lossCount = 0;
+  double logSum = 0.0;
+
+  const char* feature = strchr(name, '[');
+  snprintf(title, ARRAY_SIZE(title), "Speedup %s", feature ? feature : name);
+
+  printf(benchBorderStr);
+  printf(benchHeaderStr, title);
+  printf(benchBorderStr);
+
+  for (const BenchResult& result : results) {
+    const BenchResult* base = nullptr;
+    for (const BenchResult& candidate : baseResults) {
+      if (candidate.compOp == result.compOp && candidate.style == result.style && candidate.benchId == result.benchId) {
+        base = &candidate;
+        break;
+      }
+    }
+
+    if (!base)
+      continue;
+
+    for (uint32_t sizeId = 0; sizeId < BenchResult::kSizeCount; sizeId++) {
+      if (!result.duration[sizeId] || !base->duration[sizeId]) {
+        strcpy(speedupString[sizeId], "-");
+        continue;
+      }
+
+      double speedup = double(base->duration[sizeId]) / double(result.duration[sizeId]);
+      snprintf(speedupString[sizeId], ARRAY_SIZE(speedupString[sizeId]), "%.2fx", speedup);
+
+      cellCount++;
+      winCount += uint32_t(speedup >= kWinThreshold);
+      lossCount += uint32_t(speedup * kWinThreshold <= 1.0);
+      logSum += log(speedup);
+    }
+
+    formatStyleName(styleString, result.style);
+    printf(benchDataFmt,
+      benchIdNameList[result.benchId],
+      benchCompOpList[result.compOp],
+      styleString,
+      speedupString[0],
+      speedupString[1],
+      speedupString[2],
+      speedupString[3],
+      speedupString[4],
+      speedupString[5]);
+  }
+
+  printf(benchBorderStr);
+  printf("%s over %s: %u of %u cells at least %.2fx faster, %u at least %.2fx slower, geometric mean %.2fx\n\n",
+    name, baseName, winCount, cellCount, kWinThreshold, lossCount, kWinThreshold, cellCount ? exp(logSum / double(cellCount)) : 1.0);
+}
+
 } // {blbench}
 
 // ============================================================================
@@ -25,10 +25,39 @@
 #define BLBENCH_APP_H
 
 #include <blend2d.h>
+#include <vector>
 #include "./module.h"
 
 namespace blbench {
 
+// ============================================================================
+// [Forward Declarations]
+// ============================================================================
+
+struct PluginLibrary;
+
+// ============================================================================
+// [bench::Names]
+// ============================================================================
+
+const char* benchIdName(uint32_t benchId);
+
+// ============================================================================
+// [bench::BenchResult]
+// ============================================================================
+
+//! One row of a result table - the best duration of each shape size.
+struct BenchResult {
+  enum : uint32_t { kSizeCount = 6 };
+
+  uint32_t compOp;
+  uint32_t style;
+  uint32_t benchId;
+  uint64_t duration[kSizeCount];
+};
+
+typedef std::vector<BenchResult> BenchResults;
+
 // ============================================================================
 // [bench::BenchApp]
 // ============================================================================
@@ -40,11 +69,25 @@ struct BenchApp {
 
   // Configuration.
   bool _isolated;
+  bool _persistent;
   bool _deepBench;
   bool _saveImages;
   uint32_t _compOp;
+  uint32_t _formats;
+  uint32_t _screenW;
+  uint32_t _screenH;
+  uint32_t _surfaceMemory;
+  int _surfaceNode;
+  uint32_t _surfacePadding;
+  const char* _plugin;
+  const char* _abPlugins;
   uint32_t _repeat;
   uint32_t _quantity;
+  uint32_t _tuneThreads;
+  uint32_t _flushEvery;
+  bool _queueSweep;
+  uint32_t _aggOptions;
+  uint32_t _aggMicroBenches;
 
   // Assets.
   BLImage _sprites[4];
@@ -78,13 +121,21 @@ struct BenchApp {
   // --------------------------------------------------------------------------
 
   bool isStyleEnabled(uint32_t style);
+  void formatStyleName(char* out, uint32_t style) const;
 
   // --------------------------------------------------------------------------
   // [Run]
   // --------------------------------------------------------------------------
 
   int run();
-  int runModule(BenchModule& mod, BenchParams& params);
+  void runModules(BenchParams& params, const PluginLibrary* plugin);
+  int runModule(BenchModule& mod, BenchParams& params, BenchResults* results = nullptr);
+
+  void runPluginsAB(const PluginLibrary& a, const PluginLibrary& b, BenchParams& params);
+  int runInterleaved(BenchModule& a, BenchModule& b, BenchParams& params, BenchResults& resultsA, BenchResults& resultsB);
+
+  void printBatching(const BenchResults& results, uint32_t quantity);
+  void printSpeedup(const char* name, const char* baseName, const BenchResults& results, const BenchResults& baseResults);
 };
 
 } // {blbench}
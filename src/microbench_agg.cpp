@@ -0,0 +1,1321 @@
+// Blend2D - 2D Vector Graphics Powered by a JIT Compiler
+//
+//  * Official Blend2D Home Page: https://blend2d.com
+//  * Official Github Repository: https://github.com/blend2d/blend2d
+//
+// Copyright (c) 2017-2020 The Blend2D Authors
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifdef BLBENCH_ENABLE_AGG
+
+#include "./microbench_agg.h"
+#include "./shapes_data.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "agg_blur.h"
+#include "agg_blur_sse2.h"
+#include "agg_conv_stroke.h"
+#include "agg_curves.h"
+#include "agg_font_cache_manager.h"
+#include "agg_glyph_cache_shared.h"
+#include "agg_gsv_text.h"
+#include "agg_path_storage.h"
+#include "agg_pixfmt_gray.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_rasterizer_compound_aa.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_rasterizer_scanline_aa_nogamma.h"
+#include "agg_renderer_base.h"
+#include "agg_renderer_scanline.h"
+#include "agg_rendering_buffer.h"
+#include "agg_scanline_bin.h"
+#include "agg_scanline_boolean_algebra.h"
+#include "agg_scanline_boolean_algebra_sse2.h"
+#include "agg_scanline_p.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_span_allocator.h"
+#include "agg_span_gradient_sse2.h"
+
+namespace blbench {
+
+// ============================================================================
+// [bench::AGGMicroBench - Constants]
+// ============================================================================
+
+static const int aggCurveSizeList[] = {
+  8, 16, 32, 64, 128, 256
+};
+
+struct AGGCurveMethod {
+  const char* name;
+  agg::curve_approximation_method_e method;
+};
+
+static const AGGCurveMethod aggCurveMethodList[] = {
+  { "Inc", agg::curve_inc },
+  { "Div", agg::curve_div },
+  { "FD" , agg::curve_fd  }
+};
+
+//! Number of curves (from each size) used to measure the error.
+static const uint32_t aggCurveErrorCurves = 64;
+//! Number of samples per curve used to measure the error.
+static const uint32_t aggCurveErrorSamples = 256;
+
+static const unsigned aggBlurRadiusList[] = {
+  1, 2, 4, 8, 16, 32, 64
+};
+
+//! Size of the blurred surface, the same as the screen used by modules.
+static const unsigned aggBlurSurfaceW = 600;
+static const unsigned aggBlurSurfaceH = 512;
+//! Size of a blurred region (like a shadow of a single shape).
+static const unsigned aggBlurRegionSize = 64;
+
+static const int aggMapCellSizeList[] = {
+  8, 16, 32, 64, 128, 256
+};
+
+//! Blend2D thread counts the map is rendered with (0 means synchronous).
+static const uint32_t aggMapBlend2DThreadList[] = {
+  0, 4
+};
+
+static const int aggBooleanSizeList[] = {
+  16, 64, 256
+};
+
+//! Number of vertices of each random polygon.
+static const uint32_t aggBooleanPolygonVertices = 10;
+//! The world shape is combined with a grid of squares (not pixel aligned).
+static const double aggBooleanGridCell = 16.0;
+static const double aggBooleanGridSquare = 10.5;
+
+struct AGGGlyphFont {
+  const char* signature;
+  double size;
+  double weight;
+};
+
+//! Fonts used by the text workload, all are the built-in gsv font.
+static const AGGGlyphFont aggGlyphFontList[] = {
+  { "gsv-10", 10.0, 0.8 },
+  { "gsv-12", 12.0, 1.0 },
+  { "gsv-16", 16.0, 1.2 },
+  { "gsv-24", 24.0, 1.6 }
+};
+
+//! Numbers of rendering instances (threads) sharing or not sharing a cache.
+static const uint32_t aggGlyphInstanceList[] = {
+  1, 2, 4, 8
+};
+
+static const char* const aggGlyphWordList[] = {
+  "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+  "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore", "et", "dolore",
+  "magna", "aliqua", "Ut", "enim", "ad", "minim", "veniam", "quis", "nostrud",
+  "exercitation", "ullamco", "laboris", "nisi", "aliquip", "ex", "ea", "commodo",
+  "consequat.", "Duis", "aute", "irure", "in", "reprehenderit", "voluptate",
+  "velit", "esse", "cillum", "eu", "fugiat", "nulla", "pariatur.", "Excepteur",
+  "sint", "occaecat", "cupidatat", "non", "proident,", "sunt", "culpa", "qui",
+  "officia", "deserunt", "mollit", "anim", "id", "est", "laborum.", "0123", "4567"
+};
+
+//! Approximate number of characters of each line of text.
+static const size_t aggGlyphLineLength = 48;
+
+// ============================================================================
+// [bench::AGGMicroBench - Helpers]
+// ============================================================================
+
+static double aggSegmentDistance(const agg::point_d& p, const agg::point_d& a, const agg::point_d& b) {
+  double dx = b.x - a.x;
+  double dy = b.y - a.y;
+  double px = p.x - a.x;
+  double py = p.y - a.y;
+
+  double lenSq = dx * dx + dy * dy;
+  double t = lenSq > 0.0 ? (px * dx + py * dy) / lenSq : 0.0;
+
+  t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+  px -= dx * t;
+  py -= dy * t;
+  return sqrt(px * px + py * py);
+}
+
+//! Returns the maximum distance between the curve `cp` and its flattened
+//! representation `poly`, sampled at `aggCurveErrorSamples` points.
+static double aggCurveError(const agg::curve4_points& cp, const std::vector<agg::point_d>& poly) {
+  double maxError = 0.0;
+
+  for (uint32_t i = 0; i <= aggCurveErrorSamples; i++) {
+    double t = double(i) / double(aggCurveErrorSamples);
+    double u = 1.0 - t;
+
+    double b0 = u * u * u;
+    double b1 = 3.0 * u * u * t;
+    double b2 = 3.0 * u * t * t;
+    double b3 = t * t * t;
+
+    agg::point_d p(cp[0] * b0 + cp[2] * b1 + cp[4] * b2 + cp[6] * b3,
+                   cp[1] * b0 + cp[3] * b1 + cp[5] * b2 + cp[7] * b3);
+
+    double minError = poly.size() == 1 ? aggSegmentDistance(p, poly[0], poly[0]) : HUGE_VAL;
+    for (size_t j = 1; j < poly.size(); j++)
+      minError = std::min(minError, aggSegmentDistance(p, poly[j - 1], poly[j]));
+
+    maxError = std::max(maxError, minError);
+  }
+
+  return maxError;
+}
+
+// ============================================================================
+// [bench::AGGWorkerPool]
+// ============================================================================
+
+//! Minimal fork-join thread pool. Runs `count` tasks (horizontal bands of the
+//! blur and scanline boolean micro-benchmarks, or glyph cache instances) on
+//! all threads and waits for all of them to finish.
+class AGGWorkerPool {
+public:
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _wakeCondition;
+  std::condition_variable _doneCondition;
+
+  const std::function<void(uint32_t)>* _task;
+  std::atomic<uint32_t> _next;
+  uint32_t _count;
+  uint32_t _pending;
+  uint64_t _generation;
+  bool _stop;
+
+  explicit AGGWorkerPool(uint32_t threadCount)
+    : _task(nullptr),
+      _next(0),
+      _count(0),
+      _pending(0),
+      _generation(0),
+      _stop(false) {
+    // The calling thread is one of the workers.
+    for (uint32_t i = 1; i < threadCount; i++)
+      _threads.emplace_back([this]() { workerMain(); });
+  }
+
+  ~AGGWorkerPool() {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wakeCondition.notify_all();
+
+    for (std::thread& thread : _threads)
+      thread.join();
+  }
+
+  inline uint32_t threadCount() const noexcept { return uint32_t(_threads.size()) + 1; }
+
+  //! Calls `task(i)` for each `i` in [0, count) and waits until all calls
+  //! returned.
+  void run(uint32_t count, const std::function<void(uint32_t)>& task) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _task = &task;
+      _next = 0;
+      _count = count;
+      _pending = uint32_t(_threads.size());
+      _generation++;
+    }
+    _wakeCondition.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _doneCondition.wait(lock, [this]() { return _pending == 0; });
+  }
+
+  void work() {
+    for (;;) {
+      uint32_t i = _next.fetch_add(1);
+      if (i >= _count)
+        break;
+      (*_task)(i);
+    }
+  }
+
+  void workerMain() {
+    uint64_t generation = 0;
+
+    for (;;) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _wakeCondition.wait(lock, [&]() { return _stop || _generation != generation; });
+
+      if (_stop)
+        return;
+
+      generation = _generation;
+      lock.unlock();
+
+      work();
+
+      lock.lock();
+      if (--_pending == 0)
+        _doneCondition.notify_one();
+    }
+  }
+};
+
+// ============================================================================
+// [bench::AGGMapCell]
+// ============================================================================
+
+//! A cell of a map of adjacent polygons, all styles are opaque.
+struct AGGMapCell {
+  //! Quad vertices (x0, y0, x1, y1, ...), shared with adjacent cells.
+  double xy[8];
+  //! Solid color or gradient stops at 0, 0.5, and 1.
+  BLRgba32 colors[3];
+
+  inline void gradientLine(double& x0, double& y0, double& x1, double& y1) const noexcept {
+    x0 = xy[0];
+    y0 = xy[1];
+    x1 = xy[4];
+    y1 = xy[5];
+  }
+
+  inline void buildLut(agg::gradient_lut_rgba8& lut) const noexcept {
+    static const double offsets[3] = { 0.0, 0.5, 1.0 };
+    agg::rgba8 c[3];
+
+    for (uint32_t i = 0; i < 3; i++)
+      c[i] = agg::rgba8(uint8_t(colors[i].r()), uint8_t(colors[i].g()), uint8_t(colors[i].b()), 0xFF);
+    lut.build(offsets, c, 3);
+  }
+};
+
+//! Style handler of `agg::render_scanlines_compound()`, style ids are cell
+//! indexes.
+class AGGMapStyleHandler {
+public:
+  const std::vector<AGGMapCell>& _cells;
+  std::vector<agg::rgba8> _colors;
+  std::vector<agg::gradient_lut_rgba8> _luts;
+  std::vector<agg::span_gradient_linear_sse2> _gradients;
+  bool _solid;
+
+  AGGMapStyleHandler(const std::vector<AGGMapCell>& cells, bool solid)
+    : _cells(cells),
+      _colors(cells.size()),
+      _luts(solid ? 0 : cells.size()),
+      _gradients(solid ? 0 : cells.size()),
+      _solid(solid) {}
+
+  //! Prepares the style of each cell (colors or gradient LUTs).
+  void init() {
+    for (size_t i = 0; i < _cells.size(); i++) {
+      const AGGMapCell& cell = _cells[i];
+      if (_solid) {
+        const BLRgba32& c = cell.colors[0];
+        _colors[i] = agg::rgba8(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), 0xFF);
+      }
+      else {
+        double x0, y0, x1, y1;
+        cell.gradientLine(x0, y0, x1, y1);
+        cell.buildLut(_luts[i]);
+        _gradients[i].init(_luts[i], agg::gradient_extend_pad, x0, y0, x1, y1);
+      }
+    }
+  }
+
+  inline bool is_solid(unsigned) const { return _solid; }
+  inline const agg::rgba8& color(unsigned style) const { return _colors[style]; }
+
+  inline void generate_span(agg::rgba8* span, int x, int y, unsigned len, unsigned style) {
+    _gradients[style].generate(span, x, y, len);
+  }
+};
+
+// ============================================================================
+// [bench::AGGGlyphRasterizer]
+// ============================================================================
+
+//! Stands in for a font engine - rasterizes glyphs of the built-in gsv font
+//! into serialized AA scanlines (`glyph_data_gray8`), which is what
+//! `font_cache_manager` stores for gray8 glyph rendering.
+class AGGGlyphRasterizer {
+public:
+  agg::gsv_text _text;
+  agg::conv_stroke<agg::gsv_text> _stroke;
+  agg::rasterizer_scanline_aa<> _rasterizer;
+  agg::scanline_u8 _scanline;
+  agg::scanline_storage_aa8 _storage;
+
+  const AGGGlyphFont* _font;
+  double _advance;
+
+  AGGGlyphRasterizer()
+    : _stroke(_text),
+      _font(nullptr),
+      _advance(0.0) {
+    _text.flip(true);
+    _stroke.line_join(agg::round_join);
+    _stroke.line_cap(agg::round_cap);
+  }
+
+  //! Rasterizes `glyphCode` of `font`, use `dataSize()`, `bounds()`, etc.
+  //! to query the glyph and `serialize()` to store it.
+  void prepare(const AGGGlyphFont& font, unsigned glyphCode) {
+    char str[2] = { char(glyphCode), '\0' };
+
+    _font = &font;
+    _text.size(font.size);
+    _text.start_point(0.0, 0.0);
+    _text.text(str);
+    _stroke.width(font.weight);
+    _advance = _text.text_width();
+
+    _rasterizer.reset();
+    _rasterizer.add_path(_stroke);
+    _storage.prepare();
+    agg::render_scanlines(_rasterizer, _scanline, _storage);
+  }
+
+  inline unsigned dataSize() const { return _storage.byte_size(); }
+  inline double advance() const { return _advance; }
+
+  inline agg::rect_i bounds() const {
+    return agg::rect_i(_storage.min_x(), _storage.min_y(), _storage.max_x(), _storage.max_y());
+  }
+
+  inline void serialize(agg::int8u* data) const { _storage.serialize(data); }
+};
+
+// ============================================================================
+// [bench::AGGMicroBench - Construction / Destruction]
+// ============================================================================
+
+AGGMicroBench::AGGMicroBench(uint32_t quantity, uint32_t repeat)
+  : _quantity(quantity),
+    _repeat(repeat) {}
+AGGMicroBench::~AGGMicroBench() {}
+
+// ============================================================================
+// [bench::AGGMicroBench - Run]
+// ============================================================================
+
+void AGGMicroBench::run(uint32_t ids) {
+  if (ids & kIdCurves)
+    runCurves();
+
+  if (ids & kIdBlur)
+    runBlur();
+
+  if (ids & kIdCompound)
+    runCompound();
+
+  if (ids & kIdBoolean)
+    runBoolean();
+
+  if (ids & kIdGlyphs)
+    runGlyphs();
+}
+
+void AGGMicroBench::runCurves() {
+  static const char borderStr[] = "+--------+--------+------------+------------+------------+\n";
+
+  printf("AGG curve flattening (%u random cubic curves of each size):\n", _quantity);
+  printf(borderStr);
+  printf("|Size    |Method  |Time [ms]   |Vertices    |Max error   |\n");
+  printf(borderStr);
+
+  std::vector<agg::curve4_points> curves(_quantity);
+  std::vector<agg::point_d> poly;
+
+  // Prevents the compiler from optimizing out the flattening loops.
+  volatile double sink = 0.0;
+
+  for (int size : aggCurveSizeList) {
+    BenchRandom rnd(0x19AE0DDAE3FA7391ull);
+    double wh = double(size);
+
+    for (agg::curve4_points& cp : curves) {
+      for (uint32_t i = 0; i < 8; i++)
+        cp[i] = rnd.nextDouble(0.0, wh);
+    }
+
+    for (const AGGCurveMethod& m : aggCurveMethodList) {
+      agg::curve4 curve;
+      curve.approximation_method(m.method);
+
+      double bestTime = HUGE_VAL;
+      uint64_t vertexCount = 0;
+
+      for (uint32_t attempt = 0; attempt < _repeat; attempt++) {
+        double checksum = 0.0;
+        vertexCount = 0;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const agg::curve4_points& cp : curves) {
+          double x, y;
+          curve.init(cp);
+          curve.rewind(0);
+          while (!agg::is_stop(curve.vertex(&x, &y))) {
+            checksum += x + y;
+            vertexCount++;
+          }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> elapsed = end - start;
+        bestTime = std::min(bestTime, elapsed.count() * 1000.0);
+        sink = sink + checksum;
+      }
+
+      double maxError = 0.0;
+      size_t errorCurves = std::min<size_t>(curves.size(), aggCurveErrorCurves);
+
+      for (size_t i = 0; i < errorCurves; i++) {
+        double x, y;
+        poly.clear();
+        curve.init(curves[i]);
+        curve.rewind(0);
+        while (!agg::is_stop(curve.vertex(&x, &y)))
+          poly.push_back(agg::point_d(x, y));
+
+        if (!poly.empty())
+          maxError = std::max(maxError, aggCurveError(curves[i], poly));
+      }
+
+      char sizeStr[16];
+      snprintf(sizeStr, sizeof(sizeStr), "%dx%d", size, size);
+
+      printf("|%-8s|%-8s|%-12.3f|%-12llu|%-12.4f|\n",
+        sizeStr, m.name, bestTime, (unsigned long long)vertexCount, maxError);
+    }
+  }
+
+  printf(borderStr);
+  printf("\n");
+}
+
+void AGGMicroBench::runBlur() {
+  typedef agg::pixfmt_bgra32_pre PixelFormat;
+  typedef agg::recursive_blur<agg::rgba8, agg::recursive_blur_calc_rgba<> > RecursiveBlur;
+
+  enum Method : uint32_t {
+    kMethodRecursive,
+    kMethodStack,
+    kMethodStackSSE2,
+    kMethodStackSSE2MT,
+    kMethodCount
+  };
+
+  static const char borderStr[] = "+--------+---------------+--------+--------+--------+--------+--------+--------+--------+\n";
+
+  AGGWorkerPool pool(std::max<uint32_t>(std::thread::hardware_concurrency(), 1u));
+  uint32_t bandCount = pool.threadCount();
+
+  char methodNames[kMethodCount][16];
+  strcpy(methodNames[kMethodRecursive], "Recursive");
+  strcpy(methodNames[kMethodStack], "Stack");
+  strcpy(methodNames[kMethodStackSSE2], "Stack SSE2");
+  snprintf(methodNames[kMethodStackSSE2MT], sizeof(methodNames[0]), "Stack SSE2 x%u", bandCount);
+
+  // Random content, the time doesn't depend on it.
+  std::vector<agg::int8u> pixels(size_t(aggBlurSurfaceW) * aggBlurSurfaceH * 4);
+  BenchRandom rnd(0x19AE0DDAE3FA7391ull);
+  for (size_t i = 0; i < pixels.size(); i += 4) {
+    BLRgba32 c(rnd.nextRgba32());
+    agg::rgba8 color(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), uint8_t(c.a()));
+    color.premultiply();
+    pixels[i + 0] = color.b;
+    pixels[i + 1] = color.g;
+    pixels[i + 2] = color.r;
+    pixels[i + 3] = color.a;
+  }
+
+  std::vector<BLPointI> regions(_quantity);
+  BLSizeI regionBounds(int(aggBlurSurfaceW - aggBlurRegionSize), int(aggBlurSurfaceH - aggBlurRegionSize));
+  for (BLPointI& pt : regions)
+    pt = rnd.nextIntPoint(regionBounds);
+
+  RecursiveBlur recursiveBlur;
+
+  auto blur = [&](agg::rendering_buffer& rbuf, uint32_t method, unsigned radius) {
+    PixelFormat img(rbuf);
+
+    switch (method) {
+      case kMethodRecursive:
+        recursiveBlur.blur(img, double(radius));
+        break;
+
+      case kMethodStack:
+        agg::stack_blur_rgba32(img, radius, radius);
+        break;
+
+      case kMethodStackSSE2:
+        agg::stack_blur_rgba32_sse2(img, radius, radius);
+        break;
+
+      case kMethodStackSSE2MT: {
+        unsigned w = img.width();
+        unsigned h = img.height();
+
+        pool.run(bandCount, [&](uint32_t i) {
+          agg::stack_blur_rgba32_x_sse2(img, radius, h * i / bandCount, h * (i + 1) / bandCount);
+        });
+        pool.run(bandCount, [&](uint32_t i) {
+          agg::stack_blur_rgba32_y_sse2(img, radius, w * i / bandCount, w * (i + 1) / bandCount);
+        });
+        break;
+      }
+    }
+  };
+
+  printf("AGG blur (%ux%u surface and %u random %ux%u regions, time in ms):\n",
+    aggBlurSurfaceW, aggBlurSurfaceH, _quantity, aggBlurRegionSize, aggBlurRegionSize);
+  printf(borderStr);
+  printf("|Target  |Method         |r=1     |r=2     |r=4     |r=8     |r=16    |r=32    |r=64    |\n");
+  printf(borderStr);
+
+  for (uint32_t target = 0; target < 2; target++) {
+    for (uint32_t method = 0; method < kMethodCount; method++) {
+      printf("|%-8s|%-15s|", target == 0 ? "Surface" : "Regions", methodNames[method]);
+
+      for (unsigned radius : aggBlurRadiusList) {
+        double bestTime = HUGE_VAL;
+
+        for (uint32_t attempt = 0; attempt < _repeat; attempt++) {
+          agg::rendering_buffer rbuf;
+          auto start = std::chrono::high_resolution_clock::now();
+
+          if (target == 0) {
+            rbuf.attach(pixels.data(), aggBlurSurfaceW, aggBlurSurfaceH, int(aggBlurSurfaceW * 4));
+            blur(rbuf, method, radius);
+          }
+          else {
+            for (const BLPointI& pt : regions) {
+              rbuf.attach(pixels.data() + (size_t(pt.y) * aggBlurSurfaceW + unsigned(pt.x)) * 4,
+                aggBlurRegionSize, aggBlurRegionSize, int(aggBlurSurfaceW * 4));
+              blur(rbuf, method, radius);
+            }
+          }
+
+          auto end = std::chrono::high_resolution_clock::now();
+          std::chrono::duration<double> elapsed = end - start;
+          bestTime = std::min(bestTime, elapsed.count() * 1000.0);
+        }
+
+        printf("%-8.3f|", bestTime);
+      }
+      printf("\n");
+    }
+  }
+  printf(borderStr);
+
+  // The SSE2 stack blur must produce the same pixels as the classic one.
+  bool identical = true;
+  for (unsigned radius : aggBlurRadiusList) {
+    std::vector<agg::int8u> a(pixels);
+    std::vector<agg::int8u> b(pixels);
+
+    agg::rendering_buffer rbufA(a.data(), aggBlurSurfaceW, aggBlurSurfaceH, int(aggBlurSurfaceW * 4));
+    agg::rendering_buffer rbufB(b.data(), aggBlurSurfaceW, aggBlurSurfaceH, int(aggBlurSurfaceW * 4));
+
+    blur(rbufA, kMethodStack, radius);
+    blur(rbufB, kMethodStackSSE2MT, radius);
+    identical &= a == b;
+  }
+
+  printf("  Stack SSE2 output identical to Stack: %s\n", identical ? "yes" : "no");
+  printf("\n");
+}
+
+void AGGMicroBench::runCompound() {
+  typedef agg::pixfmt_bgra32_pre PixelFormat;
+  typedef agg::renderer_base<PixelFormat> RendererBase;
+
+  enum Method : uint32_t {
+    kMethodPerPath,
+    kMethodCompound,
+    kMethodBlend2D,
+    kMethodCount = kMethodBlend2D + uint32_t(sizeof(aggMapBlend2DThreadList) / sizeof(aggMapBlend2DThreadList[0]))
+  };
+
+  static const char borderStr[] = "+--------+--------------+--------+--------+--------+--------+--------+--------+\n";
+
+  unsigned w = aggBlurSurfaceW;
+  unsigned h = aggBlurSurfaceH;
+
+  std::vector<agg::int8u> pixels(size_t(w) * h * 4);
+  agg::rendering_buffer rbuf(pixels.data(), w, h, int(w * 4));
+  PixelFormat pixfmt(rbuf);
+  RendererBase rendererBase(pixfmt);
+
+  BLImage image;
+  image.create(int(w), int(h), BL_FORMAT_PRGB32);
+  std::vector<AGGMapCell> cells;
+
+  agg::rasterizer_scanline_aa_nogamma<> rasterizer;
+  agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_dbl> compoundRasterizer;
+  agg::scanline_p8 scanline;
+  agg::scanline_u8 scanlineAA;
+  agg::scanline_bin scanlineBin;
+  agg::span_allocator<agg::rgba8> spanAllocator;
+  agg::gradient_lut_rgba8 lut;
+  BLPath path;
+
+  printf("AGG compound rasterizer (%ux%u map of adjacent opaque polygons, time in ms):\n", w, h);
+  printf(borderStr);
+  printf("|Style   |Method        |8x8     |16x16   |32x32   |64x64   |128x128 |256x256 |\n");
+  printf(borderStr);
+
+  for (uint32_t styleId = 0; styleId < 2; styleId++) {
+    bool solid = styleId == 0;
+
+    for (uint32_t method = 0; method < kMethodCount; method++) {
+      char methodName[32];
+      if (method == kMethodPerPath)
+        strcpy(methodName, "AGG");
+      else if (method == kMethodCompound)
+        strcpy(methodName, "AGG Compound");
+      else if (aggMapBlend2DThreadList[method - kMethodBlend2D] == 0)
+        strcpy(methodName, "Blend2D ST");
+      else
+        snprintf(methodName, sizeof(methodName), "Blend2D %uT", aggMapBlend2DThreadList[method - kMethodBlend2D]);
+
+      printf("|%-8s|%-14s|", solid ? "Solid" : "Linear", methodName);
+
+      for (int size : aggMapCellSizeList) {
+        // Jittered grid, vertices on the border of the surface stay there.
+        unsigned nx = (w + unsigned(size) - 1) / unsigned(size);
+        unsigned ny = (h + unsigned(size) - 1) / unsigned(size);
+        double jitter = double(size) * 0.3;
+
+        BenchRandom rnd(0x19AE0DDAE3FA7391ull);
+        std::vector<BLPoint> grid(size_t(nx + 1) * (ny + 1));
+
+        for (unsigned y = 0; y <= ny; y++) {
+          for (unsigned x = 0; x <= nx; x++) {
+            BLPoint& pt = grid[y * (nx + 1) + x];
+            pt.x = std::min(double(x) * size, double(w));
+            pt.y = std::min(double(y) * size, double(h));
+
+            if (x != 0 && x != nx) pt.x += rnd.nextDouble(-jitter, jitter);
+            if (y != 0 && y != ny) pt.y += rnd.nextDouble(-jitter, jitter);
+          }
+        }
+
+        cells.resize(size_t(nx) * ny);
+        for (unsigned y = 0; y < ny; y++) {
+          for (unsigned x = 0; x < nx; x++) {
+            AGGMapCell& cell = cells[y * nx + x];
+            const BLPoint* p0 = &grid[y * (nx + 1) + x];
+            const BLPoint* p1 = p0 + (nx + 1);
+
+            cell.xy[0] = p0[0].x; cell.xy[1] = p0[0].y;
+            cell.xy[2] = p0[1].x; cell.xy[3] = p0[1].y;
+            cell.xy[4] = p1[1].x; cell.xy[5] = p1[1].y;
+            cell.xy[6] = p1[0].x; cell.xy[7] = p1[0].y;
+
+            for (uint32_t i = 0; i < 3; i++)
+              cell.colors[i] = rnd.nextRgb32();
+          }
+        }
+
+        double bestTime = HUGE_VAL;
+        for (uint32_t attempt = 0; attempt < _repeat; attempt++) {
+          AGGMapStyleHandler styleHandler(cells, solid);
+          memset(pixels.data(), 0, pixels.size());
+
+          // Like the clear above, context creation (including its worker
+          // threads) and clearing are not part of the measured time.
+          BLContext ctx;
+          if (method >= kMethodBlend2D) {
+            BLContextCreateInfo createInfo {};
+            createInfo.threadCount = aggMapBlend2DThreadList[method - kMethodBlend2D];
+
+            ctx.begin(image, &createInfo);
+            ctx.setCompOp(BL_COMP_OP_SRC_COPY);
+            ctx.setFillStyle(BLRgba32(0x00000000));
+            ctx.fillAll();
+            ctx.flush(BL_CONTEXT_FLUSH_SYNC);
+            ctx.setCompOp(BL_COMP_OP_SRC_OVER);
+          }
+
+          auto start = std::chrono::high_resolution_clock::now();
+          switch (method) {
+            case kMethodPerPath: {
+              for (const AGGMapCell& cell : cells) {
+                agg::poly_plain_adaptor<double> poly(cell.xy, 4, true);
+                rasterizer.reset();
+                rasterizer.add_path(poly);
+
+                if (solid) {
+                  const BLRgba32& c = cell.colors[0];
+                  agg::render_scanlines_aa_solid(rasterizer, scanline, rendererBase,
+                    agg::rgba8(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), 0xFF));
+                }
+                else {
+                  double x0, y0, x1, y1;
+                  cell.gradientLine(x0, y0, x1, y1);
+                  cell.buildLut(lut);
+
+                  agg::span_gradient_linear_sse2 spanGen;
+                  spanGen.init(lut, agg::gradient_extend_pad, x0, y0, x1, y1);
+                  agg::render_scanlines_aa(rasterizer, scanline, rendererBase, spanAllocator, spanGen);
+                }
+              }
+              break;
+            }
+
+            case kMethodCompound: {
+              styleHandler.init();
+              compoundRasterizer.reset();
+
+              for (size_t i = 0; i < cells.size(); i++) {
+                agg::poly_plain_adaptor<double> poly(cells[i].xy, 4, true);
+                compoundRasterizer.styles(int(i), -1);
+                compoundRasterizer.add_path(poly);
+              }
+
+              agg::render_scanlines_compound(compoundRasterizer, scanlineAA, scanlineBin, rendererBase, spanAllocator, styleHandler);
+              break;
+            }
+
+            default: {
+              for (const AGGMapCell& cell : cells) {
+                path.clear();
+                path.moveTo(cell.xy[0], cell.xy[1]);
+                path.lineTo(cell.xy[2], cell.xy[3]);
+                path.lineTo(cell.xy[4], cell.xy[5]);
+                path.lineTo(cell.xy[6], cell.xy[7]);
+                path.close();
+
+                if (solid) {
+                  ctx.setFillStyle(cell.colors[0]);
+                }
+                else {
+                  BLLinearGradientValues values;
+                  cell.gradientLine(values.x0, values.y0, values.x1, values.y1);
+
+                  BLGradient gradient(values);
+                  gradient.addStop(0.0, cell.colors[0]);
+                  gradient.addStop(0.5, cell.colors[1]);
+                  gradient.addStop(1.0, cell.colors[2]);
+                  ctx.setFillStyle(gradient);
+                }
+                ctx.fillPath(path);
+              }
+
+              ctx.end();
+              break;
+            }
+          }
+          auto end = std::chrono::high_resolution_clock::now();
+
+          std::chrono::duration<double> elapsed = end - start;
+          bestTime = std::min(bestTime, elapsed.count() * 1000.0);
+        }
+
+        printf("%-8.3f|", bestTime);
+      }
+      printf("\n");
+    }
+  }
+
+  printf(borderStr);
+  printf("\n");
+}
+
+void AGGMicroBench::runBoolean() {
+  typedef agg::pixfmt_gray8 PixelFormat;
+  typedef agg::renderer_base<PixelFormat> RendererBase;
+  typedef agg::renderer_scanline_aa_solid<RendererBase> Renderer;
+
+  enum Op : uint32_t {
+    kOpUnion,
+    kOpIntersect,
+    kOpXor,
+    kOpCount
+  };
+
+  enum Method : uint32_t {
+    kMethodScalar,
+    kMethodSSE2,
+    kMethodSSE2MT,
+    kMethodCount
+  };
+
+  //! Everything a band needs to combine shapes independently of others.
+  struct Band {
+    agg::rasterizer_scanline_aa<> ras1;
+    agg::rasterizer_scanline_aa<> ras2;
+    agg::scanline_p8 sl1;
+    agg::scanline_p8 sl2;
+    agg::scanline_u8 sl;
+  };
+
+  static const char* const opNames[kOpCount] = { "Union", "Intersect", "Xor" };
+  static const char borderStr[] = "+---------+---------------+--------+--------+--------+--------+\n";
+
+  AGGWorkerPool pool(std::max<uint32_t>(std::thread::hardware_concurrency(), 1u));
+  uint32_t bandCount = pool.threadCount();
+  std::unique_ptr<Band[]> bands(new Band[bandCount]);
+
+  char methodNames[kMethodCount][16];
+  strcpy(methodNames[kMethodScalar], "Scalar");
+  strcpy(methodNames[kMethodSSE2], "SSE2");
+  snprintf(methodNames[kMethodSSE2MT], sizeof(methodNames[0]), "SSE2 x%u", bandCount);
+
+  unsigned w = aggBlurSurfaceW;
+  unsigned h = aggBlurSurfaceH;
+
+  std::vector<agg::int8u> pixels(size_t(w) * h);
+  std::vector<agg::int8u> reference;
+  agg::rendering_buffer rbuf(pixels.data(), w, h, int(w));
+  PixelFormat pixfmt(rbuf);
+  RendererBase rendererBase(pixfmt);
+
+  // Scenes are pairs of shapes, one scene per polygon size and the world.
+  uint32_t sceneCount = uint32_t(sizeof(aggBooleanSizeList) / sizeof(aggBooleanSizeList[0])) + 1;
+  uint32_t worldCount = std::max<uint32_t>(_quantity / 100, 1u);
+  std::vector<std::vector<agg::path_storage>> scenes(sceneCount * 2);
+
+  BenchRandom rnd(0x19AE0DDAE3FA7391ull);
+  for (uint32_t sceneId = 0; sceneId + 1 < sceneCount; sceneId++) {
+    double wh = double(aggBooleanSizeList[sceneId]);
+    BLSizeI bounds(int(w - unsigned(wh * 1.25)), int(h - unsigned(wh * 1.25)));
+
+    for (uint32_t i = 0; i < 2; i++)
+      scenes[sceneId * 2 + i].resize(_quantity);
+
+    for (uint32_t j = 0; j < _quantity; j++) {
+      BLPoint tr(rnd.nextPoint(bounds));
+
+      for (uint32_t i = 0; i < 2; i++) {
+        // The second polygon is displaced so the pair partially overlaps.
+        agg::path_storage& path = scenes[sceneId * 2 + i][j];
+        double d = double(i) * wh * 0.25;
+
+        for (uint32_t k = 0; k < aggBooleanPolygonVertices; k++) {
+          double x = tr.x + d + rnd.nextDouble(0.0, wh);
+          double y = tr.y + d + rnd.nextDouble(0.0, wh);
+          if (k == 0)
+            path.move_to(x, y);
+          else
+            path.line_to(x, y);
+        }
+        path.close_polygon();
+      }
+    }
+  }
+
+  {
+    agg::path_storage world;
+    agg::path_storage grid;
+
+    ShapesData shape;
+    getShapesData(shape, ShapesData::kIdWorld);
+
+    double scale = double(h);
+    double ox = double(w - h) * 0.5;
+    bool moveTo = true;
+
+    for (size_t i = 0; i < shape.count; i++) {
+      const BLPoint& pt = shape.data[i];
+      if (pt.x == -1.0) {
+        world.close_polygon();
+        moveTo = true;
+      }
+      else if (moveTo) {
+        world.move_to(pt.x * scale + ox, pt.y * scale);
+        moveTo = false;
+      }
+      else {
+        world.line_to(pt.x * scale + ox, pt.y * scale);
+      }
+    }
+
+    for (double y = 0.25; y < double(h); y += aggBooleanGridCell) {
+      for (double x = 0.25; x < double(w); x += aggBooleanGridCell) {
+        grid.move_to(x, y);
+        grid.line_to(x + aggBooleanGridSquare, y);
+        grid.line_to(x + aggBooleanGridSquare, y + aggBooleanGridSquare);
+        grid.line_to(x, y + aggBooleanGridSquare);
+        grid.close_polygon();
+      }
+    }
+
+    scenes[(sceneCount - 1) * 2 + 0].assign(worldCount, world);
+    scenes[(sceneCount - 1) * 2 + 1].assign(worldCount, grid);
+  }
+
+  // Combines all pairs of a scene, only rows [y0, y1) are generated.
+  auto combine = [&](Band& band, uint32_t op, uint32_t method, uint32_t sceneId, unsigned y0, unsigned y1) {
+    std::vector<agg::path_storage>& a = scenes[sceneId * 2 + 0];
+    std::vector<agg::path_storage>& b = scenes[sceneId * 2 + 1];
+    Renderer renderer(rendererBase);
+    renderer.color(agg::gray8(0xFF));
+
+    band.ras1.clip_box(0.0, double(y0), double(w), double(y1));
+    band.ras2.clip_box(0.0, double(y0), double(w), double(y1));
+
+    for (size_t i = 0; i < a.size(); i++) {
+      band.ras1.reset();
+      band.ras1.add_path(a[i]);
+      band.ras2.reset();
+      band.ras2.add_path(b[i]);
+
+      if (method == kMethodScalar) {
+        switch (op) {
+          case kOpUnion    : agg::sbool_unite_shapes_aa(band.ras1, band.ras2, band.sl1, band.sl2, band.sl, renderer); break;
+          case kOpIntersect: agg::sbool_intersect_shapes_aa(band.ras1, band.ras2, band.sl1, band.sl2, band.sl, renderer); break;
+          case kOpXor      : agg::sbool_xor_shapes_aa(band.ras1, band.ras2, band.sl1, band.sl2, band.sl, renderer); break;
+        }
+      }
+      else {
+        switch (op) {
+          case kOpUnion    : agg::sbool_unite_shapes_aa_sse2(band.ras1, band.ras2, band.sl1, band.sl2, band.sl, renderer); break;
+          case kOpIntersect: agg::sbool_intersect_shapes_aa_sse2(band.ras1, band.ras2, band.sl1, band.sl2, band.sl, renderer); break;
+          case kOpXor      : agg::sbool_xor_shapes_aa_sse2(band.ras1, band.ras2, band.sl1, band.sl2, band.sl, renderer); break;
+        }
+      }
+    }
+  };
+
+  printf("AGG scanline boolean algebra (%u random polygon pairs of each size, world with a grid %u times, time in ms):\n",
+    _quantity, worldCount);
+  printf(borderStr);
+  printf("|Op       |Method         |16x16   |64x64   |256x256 |World   |\n");
+  printf(borderStr);
+
+  bool identical = true;
+  for (uint32_t op = 0; op < kOpCount; op++) {
+    std::vector<std::vector<agg::int8u>> results(sceneCount);
+
+    for (uint32_t method = 0; method < kMethodCount; method++) {
+      printf("|%-9s|%-15s|", opNames[op], methodNames[method]);
+
+      for (uint32_t sceneId = 0; sceneId < sceneCount; sceneId++) {
+        double bestTime = HUGE_VAL;
+
+        for (uint32_t attempt = 0; attempt < _repeat; attempt++) {
+          memset(pixels.data(), 0, pixels.size());
+          auto start = std::chrono::high_resolution_clock::now();
+
+          if (method == kMethodSSE2MT) {
+            pool.run(bandCount, [&](uint32_t i) {
+              combine(bands[i], op, method, sceneId, h * i / bandCount, h * (i + 1) / bandCount);
+            });
+          }
+          else {
+            combine(bands[0], op, method, sceneId, 0, h);
+          }
+
+          auto end = std::chrono::high_resolution_clock::now();
+          std::chrono::duration<double> elapsed = end - start;
+          bestTime = std::min(bestTime, elapsed.count() * 1000.0);
+        }
+
+        // Both SSE2 methods must produce the same pixels as the scalar one.
+        if (method == kMethodScalar)
+          results[sceneId] = pixels;
+        else
+          identical &= results[sceneId] == pixels;
+
+        printf("%-8.3f|", bestTime);
+      }
+      printf("\n");
+    }
+  }
+  printf(borderStr);
+
+  printf("  SSE2 output identical to Scalar: %s\n", identical ? "yes" : "no");
+  printf("\n");
+}
+
+void AGGMicroBench::runGlyphs() {
+  typedef agg::pixfmt_bgra32_pre PixelFormat;
+  typedef agg::renderer_base<PixelFormat> RendererBase;
+  typedef agg::renderer_scanline_aa_solid<RendererBase> Renderer;
+  typedef agg::serialized_scanlines_adaptor_aa8 GlyphAdaptor;
+
+  enum Method : uint32_t {
+    kMethodPerInstance,
+    kMethodShared,
+    kMethodCount
+  };
+
+  struct TextLine {
+    uint32_t fontIndex;
+    double x, y;
+    agg::rgba8 color;
+    std::string text;
+  };
+
+  //! A rendering instance - renders its own document into its own surface.
+  struct Instance {
+    std::vector<TextLine> lines;
+    std::vector<agg::int8u> pixels;
+    AGGGlyphRasterizer glyphRasterizer;
+    GlyphAdaptor adaptor;
+    GlyphAdaptor::embedded_scanline scanline;
+    std::unique_ptr<agg::font_cache_pool> localCache;
+
+    uint64_t lookups;
+    uint64_t misses;
+    uint64_t localMemory;
+  };
+
+  struct Stats {
+    uint64_t lookups;
+    uint64_t rasterized;
+    uint64_t memory;
+  };
+
+  static const char* const methodNames[kMethodCount] = { "Per-instance", "Shared" };
+  static const char borderStr[] = "+--------------+--------+--------+--------+--------+\n";
+  static const char statsBorderStr[] = "+--------------+---------+--------+-----------+------------+\n";
+
+  const uint32_t fontCount = uint32_t(sizeof(aggGlyphFontList) / sizeof(aggGlyphFontList[0]));
+  const uint32_t wordCount = uint32_t(sizeof(aggGlyphWordList) / sizeof(aggGlyphWordList[0]));
+  const uint32_t countCount = uint32_t(sizeof(aggGlyphInstanceList) / sizeof(aggGlyphInstanceList[0]));
+  const uint32_t maxInstances = aggGlyphInstanceList[countCount - 1];
+
+  unsigned w = aggBlurSurfaceW;
+  unsigned h = aggBlurSurfaceH;
+
+  AGGWorkerPool pool(std::max<uint32_t>(std::thread::hardware_concurrency(), 1u));
+  std::unique_ptr<Instance[]> instances(new Instance[maxInstances]);
+
+  agg::int32u fontIds[sizeof(aggGlyphFontList) / sizeof(aggGlyphFontList[0])];
+  for (uint32_t i = 0; i < fontCount; i++)
+    fontIds[i] = agg::glyph_font_id(aggGlyphFontList[i].signature);
+
+  // Each instance renders a different document, but all use the same fonts.
+  for (uint32_t id = 0; id < maxInstances; id++) {
+    Instance& instance = instances[id];
+    BenchRandom rnd(0x3D1A5C0FFEE41B27ull + id);
+
+    instance.pixels.resize(size_t(w) * h * 4);
+    instance.lines.resize(_quantity);
+
+    for (TextLine& line : instance.lines) {
+      line.fontIndex = uint32_t(rnd.nextDouble(0.0, double(fontCount))) % fontCount;
+      line.x = rnd.nextDouble(0.0, double(w) * 0.5);
+      line.y = rnd.nextDouble(aggGlyphFontList[line.fontIndex].size, double(h));
+
+      BLRgba32 c(rnd.nextRgb32());
+      line.color = agg::rgba8(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), 0xFF);
+
+      while (line.text.size() < aggGlyphLineLength) {
+        if (!line.text.empty())
+          line.text += ' ';
+        line.text += aggGlyphWordList[uint32_t(rnd.nextDouble(0.0, double(wordCount))) % wordCount];
+      }
+    }
+  }
+
+  // Renders all lines of an instance, glyphs are looked up in either its own
+  // cache or in the shared one and rasterized on a miss.
+  auto render = [&](Instance& instance, uint32_t method, agg::glyph_cache_shared* sharedCache) {
+    agg::rendering_buffer rbuf(instance.pixels.data(), w, h, int(w * 4));
+    PixelFormat pixfmt(rbuf);
+    RendererBase rendererBase(pixfmt);
+    Renderer renderer(rendererBase);
+    rendererBase.clear(agg::rgba8(0, 0, 0, 0));
+
+    for (const TextLine& line : instance.lines) {
+      const AGGGlyphFont& font = aggGlyphFontList[line.fontIndex];
+      agg::int32u fontId = fontIds[line.fontIndex];
+      double x = line.x;
+
+      if (method == kMethodPerInstance)
+        instance.localCache->font(font.signature);
+      renderer.color(line.color);
+
+      for (char c : line.text) {
+        unsigned glyphCode = unsigned((unsigned char)c);
+        const agg::int8u* data;
+        unsigned dataSize;
+        double advance;
+
+        // A glyph that didn't fit the shared cache, owned by this instance.
+        agg::shared_glyph* uncached = nullptr;
+
+        instance.lookups++;
+        if (method == kMethodPerInstance) {
+          const agg::glyph_cache* gl = instance.localCache->find_glyph(glyphCode);
+          if (!gl) {
+            AGGGlyphRasterizer& gr = instance.glyphRasterizer;
+            gr.prepare(font, glyphCode);
+
+            agg::glyph_cache* newGlyph = instance.localCache->cache_glyph(
+              glyphCode, glyphCode, gr.dataSize(), agg::glyph_data_gray8, gr.bounds(), gr.advance(), 0.0);
+            gr.serialize(newGlyph->data);
+
+            instance.misses++;
+            instance.localMemory += sizeof(agg::glyph_cache) + newGlyph->data_size;
+            gl = newGlyph;
+          }
+          data = gl->data;
+          dataSize = gl->data_size;
+          advance = gl->advance_x;
+        }
+        else {
+          const agg::shared_glyph* gl = sharedCache->find_glyph(fontId, glyphCode);
+          if (!gl) {
+            AGGGlyphRasterizer& gr = instance.glyphRasterizer;
+            gr.prepare(font, glyphCode);
+
+            agg::shared_glyph* newGlyph = agg::glyph_cache_shared::create_glyph(
+              fontId, glyphCode, glyphCode, gr.dataSize(), agg::glyph_data_gray8, gr.bounds(), gr.advance(), 0.0);
+            gr.serialize(newGlyph->data);
+
+            // Another instance may have inserted the same glyph meanwhile,
+            // rendered without caching if the shared cache is full.
+            gl = sharedCache->insert_glyph(newGlyph);
+            if (!gl) {
+              uncached = newGlyph;
+              gl = newGlyph;
+            }
+            instance.misses++;
+          }
+          data = gl->data;
+          dataSize = gl->data_size;
+          advance = gl->advance_x;
+        }
+
+        instance.adaptor.init(data, dataSize, x, line.y);
+        agg::render_scanlines(instance.adaptor, instance.scanline, renderer);
+        x += advance;
+
+        agg::glyph_cache_shared::destroy_glyph(uncached);
+      }
+    }
+  };
+
+  printf("AGG glyph cache (%u lines of text per instance, %u fonts, time in ms):\n", _quantity, fontCount);
+  printf(borderStr);
+  printf("|Cache         |1 inst  |2 inst  |4 inst  |8 inst  |\n");
+  printf(borderStr);
+
+  std::vector<Stats> stats(kMethodCount * countCount);
+  std::vector<agg::int8u> reference;
+  bool identical = true;
+
+  for (uint32_t method = 0; method < kMethodCount; method++) {
+    printf("|%-14s|", methodNames[method]);
+
+    for (uint32_t countId = 0; countId < countCount; countId++) {
+      uint32_t instanceCount = aggGlyphInstanceList[countId];
+      double bestTime = HUGE_VAL;
+      Stats& s = stats[method * countCount + countId];
+
+      for (uint32_t attempt = 0; attempt < _repeat; attempt++) {
+        // Caches start empty, so misses are part of the measurement.
+        std::unique_ptr<agg::glyph_cache_shared> sharedCache;
+        if (method == kMethodShared)
+          sharedCache.reset(new agg::glyph_cache_shared());
+
+        for (uint32_t id = 0; id < instanceCount; id++) {
+          Instance& instance = instances[id];
+          instance.localCache.reset(method == kMethodPerInstance ? new agg::font_cache_pool() : nullptr);
+          instance.lookups = 0;
+          instance.misses = 0;
+          instance.localMemory = 0;
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        pool.run(instanceCount, [&](uint32_t id) {
+          render(instances[id], method, sharedCache.get());
+        });
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> elapsed = end - start;
+        bestTime = std::min(bestTime, elapsed.count() * 1000.0);
+
+        memset(&s, 0, sizeof(s));
+        for (uint32_t id = 0; id < instanceCount; id++) {
+          s.lookups += instances[id].lookups;
+          s.rasterized += instances[id].misses;
+          s.memory += instances[id].localMemory;
+        }
+        if (sharedCache)
+          s.memory = sharedCache->memory_size();
+      }
+
+      // The document of the first instance must render the same either way.
+      if (method == kMethodPerInstance && countId == 0)
+        reference = instances[0].pixels;
+      else
+        identical &= reference == instances[0].pixels;
+
+      printf("%-8.3f|", bestTime);
+    }
+    printf("\n");
+  }
+  printf(borderStr);
+
+  printf("\n");
+  printf(statsBorderStr);
+  printf("|Cache         |Instances|Hit rate|Rasterized |Memory [KB] |\n");
+  printf(statsBorderStr);
+
+  for (uint32_t method = 0; method < kMethodCount; method++) {
+    for (uint32_t countId = 0; countId < countCount; countId++) {
+      const Stats& s = stats[method * countCount + countId];
+      double hitRate = s.lookups ? double(s.lookups - s.rasterized) * 100.0 / double(s.lookups) : 0.0;
+
+      printf("|%-14s|%-9u|%6.2f%% |%-11llu|%-12.1f|\n",
+        methodNames[method], aggGlyphInstanceList[countId], hitRate,
+        (unsigned long long)s.rasterized, double(s.memory) / 1024.0);
+    }
+  }
+  printf(statsBorderStr);
+
+  const Stats& localMax = stats[kMethodPerInstance * countCount + countCount - 1];
+  const Stats& sharedMax = stats[kMethodShared * countCount + countCount - 1];
+  double saved = localMax.memory ? (1.0 - double(sharedMax.memory) / double(localMax.memory)) * 100.0 : 0.0;
+
+  printf("  Memory saved by sharing (%u instances): %.1f KB (%.1f%%)\n",
+    maxInstances, double(localMax.memory - sharedMax.memory) / 1024.0, saved);
+  printf("  Shared output identical to Per-instance: %s\n", identical ? "yes" : "no");
+  printf("\n");
+}
+
+} // {blbench}
+
+#endif // BLBENCH_ENABLE_AGG
@@ -0,0 +1,99 @@
+// Blend2D - 2D Vector Graphics Powered by a JIT Compiler
+//
+//  * Official Blend2D Home Page: https://blend2d.com
+//  * Official Github Repository: https://github.com/blend2d/blend2d
+//
+// Copyright (c) 2017-2020 The Blend2D Authors
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef BLBENCH_MICROBENCH_AGG_H
+#define BLBENCH_MICROBENCH_AGG_H
+
+#include "./module.h"
+
+namespace blbench {
+
+// ============================================================================
+// [bench::AGGMicroBench]
+// ============================================================================
+
+//! Micro-benchmarks of individual AGG pipeline stages.
+//!
+//! These don't render anything, so they are not part of module tables and
+//! are only run when enabled from the command line.
+struct AGGMicroBench {
+  enum Id : uint32_t {
+    //! Curve flattening, see `runCurves()`.
+    kIdCurves = 0x00000001u,
+    //! Blur filters, see `runBlur()`.
+    kIdBlur = 0x00000002u,
+    //! Compound rasterizer, see `runCompound()`.
+    kIdCompound = 0x00000004u,
+    //! Scanline boolean algebra, see `runBoolean()`.
+    kIdBoolean = 0x00000008u,
+    //! Shared glyph cache, see `runGlyphs()`.
+    kIdGlyphs = 0x00000010u,
+
+    kIdAll = kIdCurves | kIdBlur | kIdCompound | kIdBoolean | kIdGlyphs
+  };
+
+  uint32_t _quantity;
+  uint32_t _repeat;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  AGGMicroBench(uint32_t quantity, uint32_t repeat);
+  ~AGGMicroBench();
+
+  // --------------------------------------------------------------------------
+  // [Run]
+  // --------------------------------------------------------------------------
+
+  //! Runs all micro-benchmarks specified by `ids`.
+  void run(uint32_t ids);
+
+  //! Flattens random cubic curves by all AGG approximation methods and
+  //! compares the time, the number of vertices, and the maximum error.
+  void runCurves();
+
+  //! Blurs the whole surface and random regions of it by AGG's recursive
+  //! and stack blur and by the SSE2 stack blur (single and multi-threaded)
+  //! at radii 1 to 64.
+  void runBlur();
+
+  //! Renders a map of adjacent polygons with solid and gradient styles path
+  //! by path, in a single pass of AGG's compound rasterizer, and by Blend2D
+  //! (single and multi-threaded).
+  void runCompound();
+
+  //! Unites, intersects, and xors random polygon pairs and the world shape
+  //! with a grid by AGG's scanline boolean algebra and by its SSE2 span
+  //! functors (single-threaded and split into bands).
+  void runBoolean();
+
+  //! Renders text by several concurrent instances that either have their
+  //! own glyph caches or share a lock-free one, and compares the time, the
+  //! hit rate, and the memory used by cached glyphs.
+  void runGlyphs();
+};
+
+} // {blbench}
+
+#endif // BLBENCH_MICROBENCH_AGG_H
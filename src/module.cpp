@@ -26,6 +26,16 @@
 #include "./shapes_data.h"
 
 #include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
 
 namespace blbench {
 
@@ -37,23 +47,87 @@ BenchModule::BenchModule()
   : _name(),
     _params(),
     _duration(0),
+    _submitDuration(0),
+    _flushDuration(0),
+    _flushInterval(0),
     _rndCoord(0x19AE0DDAE3FA7391ull),
     _rndColor(0x94BD7A499AD10011ull),
     _rndExtra(0x1ABD9CC9CAF0F123ull),
-    _rndSpriteId(0) {}
+    _rndSpriteId(0) {
+  memset(&_timing, 0, sizeof(_timing));
+}
 BenchModule::~BenchModule() {}
 
 // ============================================================================
 // [bench::BenchModule - Run]
 // ============================================================================
 
+// Returns CPU time of the calling thread or of the whole process in
+// microseconds, or 0 if the clock is not available.
+static uint64_t BenchModule_cpuTime(bool process) {
+#if defined(CLOCK_THREAD_CPUTIME_ID) && defined(CLOCK_PROCESS_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(process ? CLOCK_PROCESS_CPUTIME_ID : CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return 0;
+  return uint64_t(ts.tv_sec) * 1000000u + uint64_t(ts.tv_nsec) / 1000u;
+#else
+  (void)process;
+  return 0;
+#endif
+}
+
 static void BenchModule_onDoShapeHelper(BenchModule* mod, bool stroke, uint32_t shapeId) {
   ShapesData shape;
   getShapesData(shape, shapeId);
   mod->onDoShape(stroke, shape.data, shape.count);
 }
 
-void BenchModule::run(const BenchApp& app, const BenchParams& params) {
+static void BenchModule_dispatch(BenchModule* mod) {
+  switch (mod->_params.benchId) {
+    case kBenchIdFillAlignedRect   : mod->onDoRectAligned(false); break;
+    case kBenchIdFillSmoothRect    : mod->onDoRectSmooth(false); break;
+    case kBenchIdFillRotatedRect   : mod->onDoRectRotated(false); break;
+    case kBenchIdFillSmoothRound   : mod->onDoRoundSmooth(false); break;
+    case kBenchIdFillRotatedRound  : mod->onDoRoundRotated(false); break;
+    case kBenchIdFillTriangle      : mod->onDoPolygon(1, 3); break;
+    case kBenchIdFillPolygon10NZ   : mod->onDoPolygon(0, 10); break;
+    case kBenchIdFillPolygon10EO   : mod->onDoPolygon(1, 10); break;
+    case kBenchIdFillPolygon20NZ   : mod->onDoPolygon(0, 20); break;
+    case kBenchIdFillPolygon20EO   : mod->onDoPolygon(1, 20); break;
+    case kBenchIdFillPolygon40NZ   : mod->onDoPolygon(0, 40); break;
+    case kBenchIdFillPolygon40EO   : mod->onDoPolygon(1, 40); break;
+    case kBenchIdFillShapeWorld    : BenchModule_onDoShapeHelper(mod, false, ShapesData::kIdWorld); break;
+    case kBenchIdFillMasked        : mod->onDoMaskedFill(); break;
+    case kBenchIdFillGouraudMesh   : mod->onDoGouraudMesh(); break;
+    case kBenchIdBatchAlignedRect  : mod->onDoBatch(kBenchBatchAlignedRect); break;
+    case kBenchIdBatchSmoothRect   : mod->onDoBatch(kBenchBatchSmoothRect); break;
+    case kBenchIdBatchPolygon10NZ  : mod->onDoBatch(kBenchBatchPolygon); break;
+    case kBenchIdFillPathBuild     : mod->onDoPaths(false); break;
+    case kBenchIdFillPathReuse     : mod->onDoPaths(true); break;
+
+    case kBenchIdStrokeAlignedRect : mod->onDoRectAligned(true); break;
+    case kBenchIdStrokeSmoothRect  : mod->onDoRectSmooth(true); break;
+    case kBenchIdStrokeRotatedRect : mod->onDoRectRotated(true); break;
+    case kBenchIdStrokeSmoothRound : mod->onDoRoundSmooth(true); break;
+    case kBenchIdStrokeRotatedRound: mod->onDoRoundRotated(true); break;
+    case kBenchIdStrokeTriangle    : mod->onDoPolygon(2, 3); break;
+    case kBenchIdStrokePolygon10   : mod->onDoPolygon(2, 10); break;
+    case kBenchIdStrokePolygon20   : mod->onDoPolygon(2, 20); break;
+    case kBenchIdStrokePolygon40   : mod->onDoPolygon(2, 40); break;
+    case kBenchIdStrokeShapeWorld  : BenchModule_onDoShapeHelper(mod, true, ShapesData::kIdWorld); break;
+
+    case kBenchIdHairlineSegment   : mod->onDoHairline(kBenchHairlineSegment); break;
+    case kBenchIdHairlinePolyline  : mod->onDoHairline(kBenchHairlinePolyline); break;
+    case kBenchIdHairlineGrid      : mod->onDoHairline(kBenchHairlineGrid); break;
+
+    case kBenchIdStateNone         : mod->onDoStateChurn(kBenchStateNone); break;
+    case kBenchIdStateSave         : mod->onDoStateChurn(kBenchStateSave); break;
+    case kBenchIdStateStyle        : mod->onDoStateChurn(kBenchStateStyle); break;
+    case kBenchIdStateTransform    : mod->onDoStateChurn(kBenchStateTransform); break;
+  }
+}
+
+void BenchModule::run(const BLImage* sprites, const BenchParams& params) {
   _params = params;
 
   _rndCoord.rewind();
@@ -65,45 +139,456 @@ void BenchModule::run(const BenchApp& app, const BenchParams& params) {
   for (uint32_t i = 0; i < kBenchNumSprites; i++) {
     BLImage::scale(
       _sprites[i],
-      app._sprites[i],
+      sprites[i],
       BLSizeI(params.shapeSize, params.shapeSize), BL_IMAGE_SCALE_FILTER_BILINEAR);
   }
 
+  if (_params.benchId == kBenchIdFillMasked)
+    initMask();
+
+  if (_params.benchId == kBenchIdFillGouraudMesh)
+    initMesh();
+
+  if (_params.benchId == kBenchIdFillPathBuild || _params.benchId == kBenchIdFillPathReuse)
+    initPaths();
+
   onBeforeRun();
+  uint64_t threadCpuStart = BenchModule_cpuTime(false);
+  uint64_t processCpuStart = BenchModule_cpuTime(true);
   auto start = std::chrono::high_resolution_clock::now();
 
-  switch (_params.benchId) {
-    case kBenchIdFillAlignedRect   : onDoRectAligned(false); break;
-    case kBenchIdFillSmoothRect    : onDoRectSmooth(false); break;
-    case kBenchIdFillRotatedRect   : onDoRectRotated(false); break;
-    case kBenchIdFillSmoothRound   : onDoRoundSmooth(false); break;
-    case kBenchIdFillRotatedRound  : onDoRoundRotated(false); break;
-    case kBenchIdFillTriangle      : onDoPolygon(1, 3); break;
-    case kBenchIdFillPolygon10NZ   : onDoPolygon(0, 10); break;
-    case kBenchIdFillPolygon10EO   : onDoPolygon(1, 10); break;
-    case kBenchIdFillPolygon20NZ   : onDoPolygon(0, 20); break;
-    case kBenchIdFillPolygon20EO   : onDoPolygon(1, 20); break;
-    case kBenchIdFillPolygon40NZ   : onDoPolygon(0, 40); break;
-    case kBenchIdFillPolygon40EO   : onDoPolygon(1, 40); break;
-    case kBenchIdFillShapeWorld    : BenchModule_onDoShapeHelper(this, false, ShapesData::kIdWorld); break;
-
-    case kBenchIdStrokeAlignedRect : onDoRectAligned(true); break;
-    case kBenchIdStrokeSmoothRect  : onDoRectSmooth(true); break;
-    case kBenchIdStrokeRotatedRect : onDoRectRotated(true); break;
-    case kBenchIdStrokeSmoothRound : onDoRoundSmooth(true); break;
-    case kBenchIdStrokeRotatedRound: onDoRoundRotated(true); break;
-    case kBenchIdStrokeTriangle    : onDoPolygon(2, 3); break;
-    case kBenchIdStrokePolygon10   : onDoPolygon(2, 10); break;
-    case kBenchIdStrokePolygon20   : onDoPolygon(2, 20); break;
-    case kBenchIdStrokePolygon40   : onDoPolygon(2, 40); break;
-    case kBenchIdStrokeShapeWorld  : BenchModule_onDoShapeHelper(this, true, ShapesData::kIdWorld); break;
+  // Split the work into frames of `_flushInterval` operations if enabled.
+  uint32_t quantity = _params.quantity;
+  uint32_t frameSize = _flushInterval ? _flushInterval : quantity;
+
+  for (uint32_t done = 0; done < quantity; ) {
+    uint32_t n = quantity - done < frameSize ? quantity - done : frameSize;
+    _params.quantity = n;
+    BenchModule_dispatch(this);
+
+    done += n;
+    if (done < quantity)
+      onFlush();
   }
+  _params.quantity = quantity;
 
+  // Everything up to here was done by the calling thread, the rest is flush
+  // (and waiting for worker threads if the module has them).
+  auto submitted = std::chrono::high_resolution_clock::now();
   onAfterRun();
 
   auto end = std::chrono::high_resolution_clock::now();
+  uint64_t threadCpu = BenchModule_cpuTime(false) - threadCpuStart;
+  uint64_t processCpu = BenchModule_cpuTime(true) - processCpuStart;
+
   std::chrono::duration<double> elapsed = end - start;
+  std::chrono::duration<double> submitElapsed = submitted - start;
+
   _duration = uint64_t(elapsed.count() * 1000000);
+  _submitDuration = uint64_t(submitElapsed.count() * 1000000);
+  _flushDuration = _duration - _submitDuration;
+
+  _timing.runs++;
+  _timing.submit += _submitDuration;
+  _timing.flush += _flushDuration;
+  _timing.workerCpu += processCpu > threadCpu ? processCpu - threadCpu : 0u;
+}
+
+// ============================================================================
+// [bench::BenchModule - Misc]
+// ============================================================================
+
+void BenchModule::nextHairline(BenchHairline& dst, uint32_t mode) {
+  BLSizeI bounds(_params.screenW - _params.shapeSize,
+                 _params.screenH - _params.shapeSize);
+
+  double wh = double(_params.shapeSize);
+  BLPoint base(_rndCoord.nextPoint(bounds));
+  dst.bounds = BLRect(base.x, base.y, wh, wh);
+
+  switch (mode) {
+    case kBenchHairlineSegment:
+    case kBenchHairlinePolyline: {
+      dst.polyCount = 1;
+      dst.polySize = mode == kBenchHairlineSegment ? 2 : BenchHairline::kPolylineSize;
+
+      for (uint32_t i = 0; i < dst.polySize; i++) {
+        double x = _rndCoord.nextDouble(base.x, base.x + wh);
+        double y = _rndCoord.nextDouble(base.y, base.y + wh);
+        dst.points[i].reset(x, y);
+      }
+      break;
+    }
+
+    case kBenchHairlineGrid: {
+      uint32_t n = BenchHairline::kGridLines;
+      double x0 = floor(base.x) + 0.5;
+      double y0 = floor(base.y) + 0.5;
+      double len = wh - 1.0;
+
+      dst.polyCount = n * 2;
+      dst.polySize = 2;
+
+      BLPoint* p = dst.points;
+      for (uint32_t i = 0; i < n; i++, p += 4) {
+        double d = floor(double(i) * len / double(n - 1));
+        p[0].reset(x0, y0 + d);
+        p[1].reset(x0 + len, y0 + d);
+        p[2].reset(x0 + d, y0);
+        p[3].reset(x0 + d, y0 + len);
+      }
+      break;
+    }
+  }
+}
+
+void BenchModule::nextBatch(uint32_t mode) {
+  uint32_t quantity = _params.quantity;
+  int wh = int(_params.shapeSize);
+
+  // Uses the random generators the same way as the unbatched benchmarks.
+  switch (mode) {
+    case kBenchBatchAlignedRect: {
+      BLSizeI bounds(_params.screenW, _params.screenH);
+      _batch.rectsI.resize(quantity);
+      for (uint32_t i = 0; i < quantity; i++)
+        _batch.rectsI[i] = _rndCoord.nextRectI(bounds, wh, wh);
+      break;
+    }
+
+    case kBenchBatchSmoothRect: {
+      BLSize bounds(_params.screenW, _params.screenH);
+      _batch.rects.resize(quantity);
+      for (uint32_t i = 0; i < quantity; i++)
+        _batch.rects[i] = _rndCoord.nextRect(bounds, wh, wh);
+      break;
+    }
+
+    case kBenchBatchPolygon: {
+      BLSizeI bounds(_params.screenW - _params.shapeSize,
+                     _params.screenH - _params.shapeSize);
+      _batch.points.resize(size_t(quantity) * BenchBatch::kPolygonSize);
+
+      BLPoint* p = _batch.points.data();
+      for (uint32_t i = 0; i < quantity; i++) {
+        BLPoint base(_rndCoord.nextPoint(bounds));
+        for (uint32_t j = 0; j < BenchBatch::kPolygonSize; j++, p++) {
+          double x = _rndCoord.nextDouble(base.x, base.x + wh);
+          double y = _rndCoord.nextDouble(base.y, base.y + wh);
+          p->reset(x, y);
+        }
+      }
+      break;
+    }
+  }
+}
+
+void BenchModule::initMask() {
+  int w = int(_params.screenW);
+  int h = int(_params.screenH);
+
+  if (_mask.width() == w && _mask.height() == h)
+    return;
+
+  ShapesData shape;
+  getShapesData(shape, ShapesData::kIdWorld);
+
+  // The world shape is defined in [0, 1] units, fit it to the screen height.
+  BLPath path;
+  bool start = true;
+  double scale = double(h);
+  double ox = double(w - h) / 2.0;
+
+  for (size_t i = 0; i < shape.count; i++) {
+    double x = shape.data[i].x;
+    double y = shape.data[i].y;
+
+    if (x == -1.0 && y == -1.0) {
+      start = true;
+      continue;
+    }
+
+    if (start) {
+      path.moveTo(ox + x * scale, y * scale);
+      start = false;
+    }
+    else {
+      path.lineTo(ox + x * scale, y * scale);
+    }
+  }
+
+  BLRadialGradientValues values;
+  values.x0 = double(w) / 2.0;
+  values.y0 = double(h) / 2.0;
+  values.x1 = values.x0;
+  values.y1 = values.y0;
+  values.r0 = double(h) / 2.0;
+
+  BLGradient gradient(values);
+  gradient.addStop(0.0, BLRgba32(0xFFFFFFFFu));
+  gradient.addStop(1.0, BLRgba32(0x00FFFFFFu));
+
+  BLContext ctx;
+  _mask.create(w, h, BL_FORMAT_PRGB32);
+  ctx.begin(_mask);
+  ctx.setCompOp(BL_COMP_OP_SRC_COPY);
+  ctx.setFillStyle(BLRgba32(0x00000000u));
+  ctx.fillAll();
+  ctx.setCompOp(BL_COMP_OP_SRC_OVER);
+  ctx.setFillStyle(gradient);
+  ctx.fillPath(path);
+  ctx.end();
+
+  // Alpha only copy of the mask.
+  BLImageData src;
+  BLImageData dst;
+
+  _maskA8.create(w, h, BL_FORMAT_A8);
+  _mask.getData(&src);
+  _maskA8.makeMutable(&dst);
+
+  for (int y = 0; y < h; y++) {
+    const uint32_t* srcLine = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(src.pixelData) + intptr_t(y) * src.stride);
+    uint8_t* dstLine = static_cast<uint8_t*>(dst.pixelData) + intptr_t(y) * dst.stride;
+
+    for (int x = 0; x < w; x++)
+      dstLine[x] = uint8_t(srcLine[x] >> 24);
+  }
+}
+
+void BenchModule::initMesh() {
+  uint32_t size = _params.shapeSize;
+  if (_mesh.size == size)
+    return;
+
+  static const BLRgba32 palette[] = {
+    BLRgba32(0xFF0000FFu), // Blue.
+    BLRgba32(0xFF00FFFFu), // Cyan.
+    BLRgba32(0xFF00FF00u), // Green.
+    BLRgba32(0xFFFFFF00u), // Yellow.
+    BLRgba32(0xFFFF0000u)  // Red.
+  };
+  const uint32_t paletteLast = uint32_t(sizeof(palette) / sizeof(palette[0])) - 1;
+
+  uint32_t cells = size >= BenchMesh::kCellSize ? size / BenchMesh::kCellSize : 1u;
+  uint32_t n = cells + 1;
+  double cellSize = double(size) / double(cells);
+
+  _mesh.cells = cells;
+  _mesh.size = size;
+  _mesh.points.resize(n * n);
+  _mesh.colors.resize(n * n);
+
+  // Always the same mesh of the same size, independent of the run.
+  BLRandom rnd(0x5F3759DF4B1D2C3Aull);
+
+  for (uint32_t y = 0; y < n; y++) {
+    for (uint32_t x = 0; x < n; x++) {
+      // Jitter inner vertices so the triangles are not all alike.
+      double px = double(x) * cellSize;
+      double py = double(y) * cellSize;
+
+      if (x != 0 && x != cells && y != 0 && y != cells) {
+        px += (rnd.nextDouble() - 0.5) * cellSize * 0.5;
+        py += (rnd.nextDouble() - 0.5) * cellSize * 0.5;
+      }
+
+      // Heat value in [0, 1] mapped to the palette.
+      double u = px / double(size);
+      double v = py / double(size);
+      double heat = 0.5 + 0.25 * sin(u * 7.0 + v * 3.0) + 0.25 * cos(v * 9.0 - u * u * 5.0);
+
+      double t = (heat < 0.0 ? 0.0 : heat > 1.0 ? 1.0 : heat) * double(paletteLast);
+      uint32_t i = uint32_t(t) < paletteLast ? uint32_t(t) : paletteLast - 1;
+      double f = t - double(i);
+
+      BLRgba32 c0 = palette[i];
+      BLRgba32 c1 = palette[i + 1];
+
+      _mesh.points[y * n + x].reset(px, py);
+      _mesh.colors[y * n + x] = BLRgba32(
+        uint32_t(double(c0.r()) + (double(c1.r()) - double(c0.r())) * f + 0.5),
+        uint32_t(double(c0.g()) + (double(c1.g()) - double(c0.g())) * f + 0.5),
+        uint32_t(double(c0.b()) + (double(c1.b()) - double(c0.b())) * f + 0.5),
+        0xFFu);
+    }
+  }
+
+  uint32_t triangleCount = _mesh.triangleCount();
+  _mesh.flatColors.resize(triangleCount);
+
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    uint32_t idx[3];
+    _mesh.triangle(i, idx);
+
+    const BLRgba32& c0 = _mesh.colors[idx[0]];
+    const BLRgba32& c1 = _mesh.colors[idx[1]];
+    const BLRgba32& c2 = _mesh.colors[idx[2]];
+
+    _mesh.flatColors[i] = BLRgba32(
+      (c0.r() + c1.r() + c2.r() + 1) / 3,
+      (c0.g() + c1.g() + c2.g() + 1) / 3,
+      (c0.b() + c1.b() + c2.b() + 1) / 3,
+      0xFFu);
+  }
+}
+
+void BenchModule::initPaths() {
+  uint32_t size = _params.shapeSize;
+  if (_paths.size == size)
+    return;
+
+  const uint32_t n = BenchPathSet::kCurveCount;
+  const double kPi = 3.14159265358979323846;
+
+  // Control point distance of a cubic approximating an arc of 2 * PI / n.
+  double kappa = 4.0 / 3.0 * tan(kPi / (2.0 * n));
+  double c = double(size) * 0.5;
+
+  _paths.size = size;
+  _paths.points.resize(BenchPathSet::kPathCount * BenchPathSet::kPointCount);
+
+  // Always the same paths of the same size, independent of the run.
+  BLRandom rnd(0x2545F4914F6CDD1Dull);
+
+  for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+    BLPoint* p = _paths.points.data() + i * BenchPathSet::kPointCount;
+
+    // Radius of each vertex of the blob, the first one closes it.
+    double r[n + 1];
+    for (uint32_t j = 0; j < n; j++)
+      r[j] = c * (0.55 + rnd.nextDouble() * 0.3);
+    r[n] = r[0];
+
+    p[0].reset(c + r[0], c);
+    for (uint32_t j = 0; j < n; j++, p += 3) {
+      double a0 = 2.0 * kPi * double(j) / double(n);
+      double a1 = 2.0 * kPi * double(j + 1) / double(n);
+
+      double x0 = c + cos(a0) * r[j];
+      double y0 = c + sin(a0) * r[j];
+      double x1 = c + cos(a1) * r[j + 1];
+      double y1 = c + sin(a1) * r[j + 1];
+
+      p[1].reset(x0 - sin(a0) * r[j] * kappa, y0 + cos(a0) * r[j] * kappa);
+      p[2].reset(x1 + sin(a1) * r[j + 1] * kappa, y1 - cos(a1) * r[j + 1] * kappa);
+      p[3].reset(x1, y1);
+    }
+  }
+}
+
+// ============================================================================
+// [bench::BenchModule - Interface]
+// ============================================================================
+
+void BenchModule::onFlush() {}
+
+// ============================================================================
+// [bench::BenchModule - Statistics]
+// ============================================================================
+
+void BenchModule::resetStats() {
+  memset(&_timing, 0, sizeof(_timing));
+}
+void BenchModule::printStats() {}
+
+// ============================================================================
+// [bench::BenchModule - Surface]
+// ============================================================================
+
+#if defined(__linux__)
+static const size_t kBenchHugePageSize = 2 * 1024 * 1024;
+
+// Memory mapped for a surface, released when the image is destroyed.
+struct BenchSurfaceMapping {
+  void* data;
+  size_t size;
+};
+
+static void BenchModule_unmapSurface(void* impl, void* destroyData) {
+  BenchSurfaceMapping* mapping = static_cast<BenchSurfaceMapping*>(destroyData);
+  munmap(mapping->data, mapping->size);
+  delete mapping;
+}
+
+// Prints a warning only once per `flag`, surfaces are created by every run.
+static void BenchModule_warnOnce(bool& flag, const char* message) {
+  if (!flag) {
+    printf("WARNING: %s\n", message);
+    flag = true;
+  }
+}
+
+static bool BenchModule_warnedHugeTLB;
+static bool BenchModule_warnedNode;
+
+static BenchSurfaceMapping* BenchModule_mapSurface(size_t size, uint32_t memory, int node) {
+  // Huge page sized (and aligned), so the last page is not shared with other allocations.
+  size = (size + kBenchHugePageSize - 1) & ~(kBenchHugePageSize - 1);
+
+  void* data = MAP_FAILED;
+  if (memory == kBenchSurfaceMemoryHugeTLB) {
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data == MAP_FAILED)
+      BenchModule_warnOnce(BenchModule_warnedHugeTLB, "MAP_HUGETLB failed (no huge pages reserved?), using transparent huge pages");
+  }
+
+  if (data == MAP_FAILED) {
+    // Over-allocate to align the start to a huge page, THP can only back
+    // aligned 2MB ranges.
+    size_t mappedSize = size + kBenchHugePageSize;
+    uint8_t* p = static_cast<uint8_t*>(mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (p == MAP_FAILED)
+      return nullptr;
+
+    uint8_t* aligned = reinterpret_cast<uint8_t*>((uintptr_t(p) + kBenchHugePageSize - 1) & ~uintptr_t(kBenchHugePageSize - 1));
+    size_t head = size_t(aligned - p);
+
+    if (head)
+      munmap(p, head);
+    munmap(aligned + size, kBenchHugePageSize - head);
+    data = aligned;
+
+    if (memory != kBenchSurfaceMemoryDefault)
+      madvise(data, size, MADV_HUGEPAGE);
+  }
+
+  // Bound before the first touch, which is what places the pages. Called via
+  // syscall() to not depend on libnuma (MPOL_BIND == 2).
+  if (node >= 0) {
+    unsigned long nodeMask[16] = {};
+    if (size_t(node) < sizeof(nodeMask) * 8)
+      nodeMask[size_t(node) / (sizeof(unsigned long) * 8)] = 1ul << (size_t(node) % (sizeof(unsigned long) * 8));
+
+    // The kernel reads `maxnode - 1` bits of the mask.
+    if (syscall(SYS_mbind, data, size, 2, nodeMask, sizeof(nodeMask) * 8 + 1, 0) != 0)
+      BenchModule_warnOnce(BenchModule_warnedNode, "mbind() failed, surface memory is not bound to the NUMA node");
+  }
+
+  memset(data, 0, size);
+  return new BenchSurfaceMapping{data, size};
+}
+#endif
+
+void BenchModule::createSurface() {
+  int w = int(_params.screenW);
+  int h = int(_params.screenH);
+
+#if defined(__linux__)
+  if (_params.surfaceMemory != kBenchSurfaceMemoryDefault || _params.surfaceNode >= 0 || _params.surfacePadding) {
+    uint32_t bpp = _params.format == BL_FORMAT_A8 ? 1 : 4;
+    intptr_t stride = intptr_t(w) * bpp + intptr_t(_params.surfacePadding);
+
+    BenchSurfaceMapping* mapping = BenchModule_mapSurface(size_t(stride) * size_t(h), _params.surfaceMemory, _params.surfaceNode);
+    if (mapping) {
+      if (_surface.createFromData(w, h, _params.format, mapping->data, stride, BenchModule_unmapSurface, mapping) == BL_SUCCESS)
+        return;
+      BenchModule_unmapSurface(nullptr, mapping);
+    }
+  }
+#endif
+
+  _surface.create(w, h, _params.format);
 }
 
 } // {blbench}
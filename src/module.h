@@ -25,6 +25,7 @@
 #define BLBENCH_MODULE_H
 
 #include <blend2d.h>
+#include <vector>
 // #include "./module.h"
 
 namespace blbench {
@@ -40,7 +41,12 @@ struct BenchApp;
 // ============================================================================
 
 enum BenchMisc {
-  kBenchNumSprites = 4
+  kBenchNumSprites = 4,
+
+  //! Number of cached styles `kBenchStateStyle` switches between.
+  kBenchStateStyles = 4,
+  //! Maximum nesting of save/restore of `kBenchStateSave`.
+  kBenchStateMaxDepth = 16
 };
 
 // ============================================================================
@@ -61,6 +67,13 @@ enum BenchId {
   kBenchIdFillPolygon40NZ,
   kBenchIdFillPolygon40EO,
   kBenchIdFillShapeWorld,
+  kBenchIdFillMasked,
+  kBenchIdFillGouraudMesh,
+  kBenchIdBatchAlignedRect,
+  kBenchIdBatchSmoothRect,
+  kBenchIdBatchPolygon10NZ,
+  kBenchIdFillPathBuild,
+  kBenchIdFillPathReuse,
 
   kBenchIdStrokeAlignedRect,
   kBenchIdStrokeSmoothRect,
@@ -73,9 +86,79 @@ enum BenchId {
   kBenchIdStrokePolygon40,
   kBenchIdStrokeShapeWorld,
 
+  kBenchIdHairlineSegment,
+  kBenchIdHairlinePolyline,
+  kBenchIdHairlineGrid,
+
+  kBenchIdStateNone,
+  kBenchIdStateSave,
+  kBenchIdStateStyle,
+  kBenchIdStateTransform,
+
   kBenchIdCount
 };
 
+// ============================================================================
+// [bench::BenchHairlineMode]
+// ============================================================================
+
+enum BenchHairlineMode {
+  //! A single segment between two random points.
+  kBenchHairlineSegment,
+  //! An open polyline of random points.
+  kBenchHairlinePolyline,
+  //! Horizontal and vertical lines at pixel centers (chart grid and axes).
+  kBenchHairlineGrid
+};
+
+// ============================================================================
+// [bench::BenchBatchMode]
+// ============================================================================
+
+//! Shapes submitted by a single call, each mode generates the same shapes as
+//! the unbatched benchmark it's named after.
+enum BenchBatchMode {
+  //! Pixel aligned rectangles (FillRectA).
+  kBenchBatchAlignedRect,
+  //! Rectangles at fractional coordinates (FillRectU).
+  kBenchBatchSmoothRect,
+  //! Polygons of 10 vertices filled by the non-zero rule (FillPolyNZi10).
+  kBenchBatchPolygon
+};
+
+// ============================================================================
+// [bench::BenchStateMode]
+// ============================================================================
+
+//! All modes fill the same smooth rectangles by styles that are created once
+//! per run, so they only differ by how the state is managed around each fill.
+enum BenchStateMode {
+  //! The style is set once, there are no state changes (reference).
+  kBenchStateNone,
+  //! Each fill is wrapped in 1 to `kBenchStateMaxDepth` nested save/restore.
+  kBenchStateSave,
+  //! Switches to the next of `kBenchStateStyles` cached styles before each fill.
+  kBenchStateStyle,
+  //! Saves, translates to the rectangle, fills it at the origin, and restores.
+  kBenchStateTransform
+};
+
+// ============================================================================
+// [bench::BenchSurfaceMemory]
+// ============================================================================
+
+//! How the memory of the surface is allocated, see `BenchModule::createSurface()`.
+enum BenchSurfaceMemory {
+  //! Allocated by Blend2D (`BLImage::create()`).
+  kBenchSurfaceMemoryDefault,
+  //! Mapped by the harness and advised to use transparent huge pages.
+  kBenchSurfaceMemoryTHP,
+  //! Mapped by the harness from explicit huge pages (MAP_HUGETLB).
+  kBenchSurfaceMemoryHugeTLB,
+
+  kBenchSurfaceMemoryCount
+};
+
 // ============================================================================
 // [bench::BenchStyle]
 // ============================================================================
@@ -112,6 +195,13 @@ struct BenchParams {
   uint32_t shapeSize;
 
   double strokeWidth;
+
+  //! Memory of the surface, see `BenchSurfaceMemory`.
+  uint32_t surfaceMemory;
+  //! NUMA node the memory of the surface is bound to, -1 if not bound.
+  int surfaceNode;
+  //! Bytes added to the stride of the surface.
+  uint32_t surfacePadding;
 };
 
 // ============================================================================
@@ -197,6 +287,136 @@ struct BenchRandom {
   }
 };
 
+// ============================================================================
+// [bench::BenchHairline]
+// ============================================================================
+
+//! Geometry of a single hairline shape, `polyCount` open polylines of
+//! `polySize` points each.
+struct BenchHairline {
+  enum : uint32_t {
+    kPolylineSize = 10,
+    kGridLines = 5,
+    kMaxPoints = kGridLines * 2 * 2
+  };
+
+  BLPoint points[kMaxPoints];
+  uint32_t polyCount;
+  uint32_t polySize;
+  //! Bounding box of the shape, used to setup styles.
+  BLRect bounds;
+};
+
+// ============================================================================
+// [bench::BenchMesh]
+// ============================================================================
+
+//! Triangulated heatmap mesh with a color per vertex.
+//!
+//! The mesh is a grid of `cells * cells` cells, each split into 2 triangles.
+//! Vertices are relative to the top-left corner of the mesh, rendering
+//! translates them.
+struct BenchMesh {
+  //! Size of a cell in pixels.
+  enum : uint32_t { kCellSize = 8 };
+
+  //! Number of cells per side.
+  uint32_t cells;
+  //! Size of the mesh in pixels.
+  uint32_t size;
+  //! Vertices, `(cells + 1) * (cells + 1)` of them, row by row.
+  std::vector<BLPoint> points;
+  //! Opaque vertex colors, one per point.
+  std::vector<BLRgba32> colors;
+  //! Average of the vertex colors of each triangle, used by renderers that
+  //! can only fill triangles by a single color (flat shading).
+  std::vector<BLRgba32> flatColors;
+
+  inline BenchMesh() noexcept
+    : cells(0),
+      size(0) {}
+
+  inline uint32_t triangleCount() const noexcept { return cells * cells * 2; }
+
+  //! Stores vertex indexes of the triangle `i` into `idx`.
+  inline void triangle(uint32_t i, uint32_t idx[3]) const noexcept {
+    uint32_t c = i / 2;
+    uint32_t v00 = (c / cells) * (cells + 1) + (c % cells);
+    uint32_t v01 = v00 + cells + 1;
+
+    idx[0] = v00;
+    if (i & 1) {
+      idx[1] = v01 + 1;
+      idx[2] = v01;
+    }
+    else {
+      idx[1] = v00 + 1;
+      idx[2] = v01 + 1;
+    }
+  }
+};
+
+// ============================================================================
+// [bench::BenchBatch]
+// ============================================================================
+
+//! Geometry of all shapes of a batch, only the array of the mode is used.
+struct BenchBatch {
+  enum : uint32_t { kPolygonSize = 10 };
+
+  //! Rectangles of `kBenchBatchAlignedRect`.
+  std::vector<BLRectI> rectsI;
+  //! Rectangles of `kBenchBatchSmoothRect`.
+  std::vector<BLRect> rects;
+  //! Polygons of `kBenchBatchPolygon`, `kPolygonSize` points each.
+  std::vector<BLPoint> points;
+
+  inline size_t polygonCount() const noexcept { return points.size() / kPolygonSize; }
+};
+
+// ============================================================================
+// [bench::BenchPathSet]
+// ============================================================================
+
+//! A set of closed paths made of cubic curves (irregular blobs).
+//!
+//! Points are relative to the top-left corner of a `size * size` box, each
+//! path starts with a move-to followed by `kCurveCount` cubic curves (3 points
+//! each) and is closed.
+struct BenchPathSet {
+  enum : uint32_t {
+    kPathCount = 16,
+    kCurveCount = 8,
+    kPointCount = 1 + kCurveCount * 3
+  };
+
+  //! Size of the box in pixels.
+  uint32_t size;
+  //! Points of all paths, `kPointCount` per path.
+  std::vector<BLPoint> points;
+
+  inline BenchPathSet() noexcept
+    : size(0) {}
+
+  inline const BLPoint* pathPoints(uint32_t i) const noexcept { return points.data() + i * kPointCount; }
+};
+
+// ============================================================================
+// [bench::BenchTiming]
+// ============================================================================
+
+//! Split of the measured time of runs, in microseconds.
+struct BenchTiming {
+  //! Number of runs.
+  uint64_t runs;
+  //! Time the calling thread spent submitting the work (`onDo*()`).
+  uint64_t submit;
+  //! Time spent flushing and waiting for the work to finish (`onAfterRun()`).
+  uint64_t flush;
+  //! CPU time consumed by all other threads (workers) of the process.
+  uint64_t workerCpu;
+};
+
 // ============================================================================
 // [bench::BenchModule]
 // ============================================================================
@@ -208,6 +428,14 @@ struct BenchModule {
   BenchParams _params;
   //! Current duration.
   uint64_t _duration;
+  //! Current duration split into submit and flush times.
+  uint64_t _submitDuration;
+  uint64_t _flushDuration;
+  //! Timing of all runs since the last `resetStats()`.
+  BenchTiming _timing;
+  //! Number of operations per frame, `onFlush()` is called between frames
+  //! of a run. Zero means that the whole run is a single frame.
+  uint32_t _flushInterval;
 
   //! Random number generator for coordinates (points or rectangles).
   BenchRandom _rndCoord;
@@ -222,6 +450,16 @@ struct BenchModule {
   BLImage _surface;
   //! Sprites.
   BLImage _sprites[kBenchNumSprites];
+  //! Soft mask used by `kBenchIdFillMasked` (PRGB32, see `initMask()`).
+  BLImage _mask;
+  //! The same mask as A8 (alpha only).
+  BLImage _maskA8;
+  //! Mesh used by `kBenchIdFillGouraudMesh` (see `initMesh()`).
+  BenchMesh _mesh;
+  //! Shapes of batch benchmarks (see `nextBatch()`).
+  BenchBatch _batch;
+  //! Paths used by `kBenchIdFillPathBuild` and `kBenchIdFillPathReuse` (see `initPaths()`).
+  BenchPathSet _paths;
 
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
@@ -234,7 +472,9 @@ struct BenchModule {
   // [Run]
   // --------------------------------------------------------------------------
 
-  void run(const BenchApp& app, const BenchParams& params);
+  //! Runs the benchmark given by `params` and stores its times, `sprites` are
+  //! `kBenchNumSprites` images scaled to the shape size by each run.
+  virtual void run(const BLImage* sprites, const BenchParams& params);
 
   // --------------------------------------------------------------------------
   // [Misc]
@@ -247,12 +487,33 @@ struct BenchModule {
     return i;
   };
 
+  //! Generates the next hairline shape of the given `mode`, see `BenchHairlineMode`.
+  void nextHairline(BenchHairline& dst, uint32_t mode);
+
+  //! Generates `quantity` shapes of the given `mode` into `_batch`, see `BenchBatchMode`.
+  void nextBatch(uint32_t mode);
+
+  //! Renders the world shape filled by a radial gradient that fades from
+  //! opaque to transparent into `_mask` and `_maskA8`, if not done already.
+  void initMask();
+
+  //! Builds `_mesh` of `shapeSize` pixels, if not done already.
+  void initMesh();
+
+  //! Builds `_paths` of `shapeSize` pixels, if not done already.
+  void initPaths();
+
+  //! Creates `_surface` of the screen size and format. Blend2D allocates it
+  //! unless the surface parameters ask for memory mapped by the harness.
+  void createSurface();
+
   // --------------------------------------------------------------------------
   // [Interface]
   // --------------------------------------------------------------------------
 
   virtual bool supportsCompOp(uint32_t compOp) const = 0;
   virtual bool supportsStyle(uint32_t style) const = 0;
+  virtual bool supportsFormat(uint32_t format) const = 0;
 
   virtual void onBeforeRun() = 0;
   virtual void onAfterRun() = 0;
@@ -264,6 +525,36 @@ struct BenchModule {
   virtual void onDoRoundRotated(bool stroke) = 0;
   virtual void onDoPolygon(uint32_t mode, uint32_t complexity) = 0;
   virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count) = 0;
+  //! Strokes 1px wide lines, see `BenchHairlineMode`.
+  virtual void onDoHairline(uint32_t mode) = 0;
+  //! Fills rounded rectangles through the soft mask (`_mask` or `_maskA8`),
+  //! each shape is multiplied by the mask at its screen position.
+  virtual void onDoMaskedFill() = 0;
+  //! Renders `_mesh` at random positions, colors are interpolated between
+  //! the vertices of each triangle (Gouraud shading). The style is ignored,
+  //! the test only runs with `kBenchStyleSolid`.
+  virtual void onDoGouraudMesh() = 0;
+  //! Fills all shapes of `nextBatch()` by a single style and a single call
+  //! if the library has one, see `BenchBatchMode`.
+  virtual void onDoBatch(uint32_t mode) = 0;
+  //! Fills `_paths` at random positions. Either builds a path object from the
+  //! points for each fill, or reuses path objects that are built once for all
+  //! runs of the same shape size (like paths cached across frames).
+  virtual void onDoPaths(bool reuse) = 0;
+  //! Fills rectangles with or without state changes, see `BenchStateMode`.
+  virtual void onDoStateChurn(uint32_t mode) = 0;
+
+  //! Called between frames if `_flushInterval` is set, does nothing by default.
+  virtual void onFlush();
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Resets module specific statistics and `_timing`, called before each table is run.
+  virtual void resetStats();
+  //! Prints module specific statistics collected since the last `resetStats()`.
+  virtual void printStats();
 };
 
 } // {blbench}
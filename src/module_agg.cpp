@@ -27,13 +27,25 @@
 #include "./module_agg.h"
 
 #include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+#include "agg_conv_adaptor_vcgen.h"
+#include "agg_conv_curve.h"
 #include "agg_conv_transform.h"
-#include "agg_conv_stroke.h"
 #include "agg_rounded_rect.h"
 #include "agg_trans_affine.h"
+#include "agg_vertex_block.h"
 
 namespace blbench {
 
+//! Gamma of `AGGModule::kOptionGamma` and `AGGModule::kOptionGammaSimd`.
+static const double aggGammaValue = 2.2;
+
+//! Dilation of Gouraud triangles, covers the seams between neighbors (the
+//! value used by AGG's gouraud example).
+static const double aggGouraudDilation = 0.175;
+
 // ============================================================================
 // [bench::AGGRectSource]
 // ============================================================================
@@ -83,6 +95,20 @@ public:
         return agg::path_cmd_stop;
     }
   }
+
+  inline unsigned vertices(double* xy, unsigned* cmd, unsigned maxCount) {
+    if (_index != 0 || maxCount < 5)
+      return agg::vertex_block_adaptor<AGGRectSource>(*this).vertices(xy, cmd, maxCount);
+
+    xy[0] = _box.x0; xy[1] = _box.y0; cmd[0] = agg::path_cmd_move_to;
+    xy[2] = _box.x1; xy[3] = _box.y0; cmd[1] = agg::path_cmd_line_to;
+    xy[4] = _box.x1; xy[5] = _box.y1; cmd[2] = agg::path_cmd_line_to;
+    xy[6] = _box.x0; xy[7] = _box.y1; cmd[3] = agg::path_cmd_line_to;
+    xy[8] = 0.0;     xy[9] = 0.0;     cmd[4] = agg::path_cmd_end_poly | agg::path_flags_close;
+
+    _index = 5;
+    return 5;
+  }
 };
 
 // ============================================================================
@@ -123,6 +149,29 @@ public:
     _remaining--;
     return cmd;
   }
+
+  inline unsigned vertices(double* xy, unsigned* cmd, unsigned maxCount) {
+    unsigned n = 0;
+
+    while (n < maxCount && _remaining > 1) {
+      xy[0] = _rnd.nextDouble(_tr.x, _tr.x + _wh);
+      xy[1] = _rnd.nextDouble(_tr.y, _tr.y + _wh);
+      cmd[n++] = _cmd;
+      xy += 2;
+
+      _cmd = agg::path_cmd_line_to;
+      _remaining--;
+    }
+
+    if (n < maxCount && _remaining == 1) {
+      xy[0] = 0.0;
+      xy[1] = 0.0;
+      cmd[n++] = agg::path_cmd_end_poly | agg::path_flags_close;
+      _remaining--;
+    }
+
+    return n;
+  }
 };
 
 // ============================================================================
@@ -166,36 +215,480 @@ public:
     _index++;
     return cmd;
   }
+
+  inline unsigned vertices(double* xy, unsigned* cmd, unsigned maxCount) {
+    unsigned n = 0;
+    double scale = _scale;
+
+    while (n < maxCount && _index < _size) {
+      const BLPoint& pt = _data[_index++];
+      if (pt.x == -1.0) {
+        xy[0] = 0.0;
+        xy[1] = 0.0;
+        cmd[n] = agg::path_cmd_end_poly;
+        _cmd = agg::path_cmd_move_to;
+      }
+      else {
+        xy[0] = pt.x * scale + _tr.x;
+        xy[1] = pt.y * scale + _tr.y;
+        cmd[n] = _cmd;
+        _cmd = agg::path_cmd_line_to;
+      }
+
+      xy += 2;
+      n++;
+    }
+
+    return n;
+  }
 };
 
+// ============================================================================
+// [bench::AGGHairlineSource]
+// ============================================================================
+
+class AGGHairlineSource {
+public:
+  const BenchHairline& _hairline;
+  uint32_t _index;
+  uint32_t _count;
+
+  inline explicit AGGHairlineSource(const BenchHairline& hairline)
+    : _hairline(hairline),
+      _index(0),
+      _count(hairline.polyCount * hairline.polySize) {}
+
+  inline void rewind(unsigned) { _index = 0; }
+  inline unsigned vertex(double* x, double* y) {
+    if (_index >= _count)
+      return agg::path_cmd_stop;
+
+    const BLPoint& pt = _hairline.points[_index];
+    *x = pt.x;
+    *y = pt.y;
+    return (_index++ % _hairline.polySize) == 0 ? agg::path_cmd_move_to : agg::path_cmd_line_to;
+  }
+};
+
+// ============================================================================
+// [bench::AGGMaskedSource]
+// ============================================================================
+
+// Scanline source that multiplies the covers of each swept scanline by an alpha
+// mask. `scanline_u8_am` does the same when a scanline is finalized, which is
+// before `kOptionGammaSimd` applies gamma, this applies the mask after it.
+template<typename ScanlineSource, typename AlphaMask>
+class AGGMaskedSource {
+public:
+  ScanlineSource& _src;
+  const AlphaMask& _alphaMask;
+
+  inline AGGMaskedSource(ScanlineSource& src, const AlphaMask& alphaMask)
+    : _src(src),
+      _alphaMask(alphaMask) {}
+
+  inline bool rewind_scanlines() { return _src.rewind_scanlines(); }
+  inline int min_x() const { return _src.min_x(); }
+  inline int min_y() const { return _src.min_y(); }
+  inline int max_x() const { return _src.max_x(); }
+  inline int max_y() const { return _src.max_y(); }
+
+  template<typename Scanline>
+  inline bool sweep_scanline(Scanline& sl) {
+    if (!_src.sweep_scanline(sl))
+      return false;
+
+    typename Scanline::iterator span = sl.begin();
+    for (unsigned n = sl.num_spans(); n; n--, ++span)
+      _alphaMask.combine_hspan(span->x, sl.y(), span->covers, span->len);
+    return true;
+  }
+};
+
+// ============================================================================
+// [bench::AGGCoverageCache]
+// ============================================================================
+
+size_t AGGCoverageCache::KeyHash::operator()(const Key& key) const noexcept {
+  std::hash<double> hd;
+  size_t h = std::hash<const void*>()(key.pathId);
+  h = h * 31u + hd(key.sx);
+  h = h * 31u + hd(key.shy);
+  h = h * 31u + hd(key.shx);
+  h = h * 31u + hd(key.sy);
+  h = h * 31u + hd(key.strokeWidth);
+  h = h * 31u + key.fillRule;
+  h = h * 31u + key.bucket;
+  return h;
+}
+
+AGGCoverageCache::AGGCoverageCache()
+  : _hits(0),
+    _misses(0),
+    _byteSize(0) {}
+AGGCoverageCache::~AGGCoverageCache() {}
+
+void AGGCoverageCache::reset() {
+  _map.clear();
+  _hits = 0;
+  _misses = 0;
+  _byteSize = 0;
+}
+
+const AGGCoverageCache::Data* AGGCoverageCache::find(const Key& key) {
+  Map::const_iterator it = _map.find(key);
+  if (it == _map.end()) {
+    _misses++;
+    return nullptr;
+  }
+
+  _hits++;
+  return &it->second;
+}
+
+// ============================================================================
+// [bench::AGGGradientCache]
+// ============================================================================
+
+bool AGGGradientCache::Key::operator==(const Key& other) const noexcept {
+  if (count != other.count)
+    return false;
+
+  for (uint32_t i = 0; i < count; i++)
+    if (offsets[i] != other.offsets[i] || colors[i] != other.colors[i])
+      return false;
+
+  return true;
+}
+
+AGGGradientCache::AGGGradientCache()
+  : _size(0),
+    _time(0),
+    _hits(0),
+    _misses(0) {}
+AGGGradientCache::~AGGGradientCache() {}
+
+void AGGGradientCache::reset() {
+  _size = 0;
+  _time = 0;
+  _hits = 0;
+  _misses = 0;
+}
+
+const agg::gradient_lut_rgba8& AGGGradientCache::get(const Key& key) {
+  uint32_t lruIndex = 0;
+  _time++;
+
+  for (uint32_t i = 0; i < _size; i++) {
+    Entry& entry = _entries[i];
+    if (entry.key == key) {
+      entry.lastUse = _time;
+      _hits++;
+      return entry.lut;
+    }
+
+    if (entry.lastUse < _entries[lruIndex].lastUse)
+      lruIndex = i;
+  }
+
+  // Not found - use a free entry or replace the least recently used one.
+  if (_size < kCapacity)
+    lruIndex = _size++;
+
+  Entry& entry = _entries[lruIndex];
+  entry.key = key;
+  entry.lastUse = _time;
+
+  agg::rgba8 colors[kMaxStops];
+  for (uint32_t i = 0; i < key.count; i++) {
+    BLRgba32 c(key.colors[i]);
+    colors[i] = agg::rgba8(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), uint8_t(c.a()));
+    colors[i].premultiply();
+  }
+
+  entry.lut.build(key.offsets, colors, key.count);
+  _misses++;
+  return entry.lut;
+}
+
+// ============================================================================
+// [bench::AGGLineProfileCache]
+// ============================================================================
+
+AGGLineProfileCache::AGGLineProfileCache() {}
+AGGLineProfileCache::~AGGLineProfileCache() {}
+
+agg::line_profile_aa& AGGLineProfileCache::get(double width) {
+  for (Entry& entry : _entries)
+    if (entry.width == width)
+      return *entry.profile;
+
+  Entry entry;
+  entry.width = width;
+  entry.profile.reset(new agg::line_profile_aa(width, agg::gamma_none()));
+
+  _entries.push_back(std::move(entry));
+  return *_entries.back().profile;
+}
+
 // ============================================================================
 // [bench::AGGModule - Construction / Destruction]
 // ============================================================================
 
-AGGModule::AGGModule() {
-  strcpy(_name, "AGG");
+AGGModule::AGGModule(uint32_t options)
+  : _gammaCovers(aggGammaValue),
+    _options(options) {
+  const char* option = optionName(options);
+
+  if (option)
+    snprintf(_name, sizeof(_name), "AGG [%s]", option);
+  else
+    strcpy(_name, "AGG");
+
+  _allocCountBefore = 0;
+  memset(_cacheStats, 0, sizeof(_cacheStats));
+  memset(_allocStats, 0, sizeof(_allocStats));
+  memset(&_gradientCacheStats, 0, sizeof(_gradientCacheStats));
+  _pathObjectsSize = 0;
+
+  _gammaRasterizer.gamma(agg::gamma_power(aggGammaValue));
 }
 AGGModule::~AGGModule() {}
 
+const char* AGGModule::optionName(uint32_t option) {
+  switch (option) {
+    case kOptionCoverageCache: return "Cache";
+    case kOptionBlockPipeline: return "Block";
+    case kOptionSimdGradient : return "Gradient";
+    case kOptionSimdImage    : return "Image";
+    case kOptionOutlineAA    : return "Outline";
+    case kOptionGamma        : return "Gamma";
+    case kOptionGammaSimd    : return "GammaSIMD";
+    case kOptionSimdMask     : return "MaskSIMD";
+    case kOptionIntegerPath  : return "Integer";
+    case kOptionSimdGouraud  : return "GouraudSIMD";
+    default:
+      return nullptr;
+  }
+}
+
 // ============================================================================
 // [bench::AGGModule - AGG]
 // ============================================================================
 
 void AGGModule::renderScanlines(const BLRect& rect, uint32_t style) {
+  renderScanlinesWith(_scanline, rect, style);
+}
+
+template<typename Scanline>
+void AGGModule::renderScanlinesWith(Scanline& sl, const BLRect& rect, uint32_t style) {
+  if (_options & kOptionGamma) {
+    renderScanlinesFrom(_gammaRasterizer, sl, rect, style);
+    _gammaRasterizer.reset();
+    return;
+  }
+
+  if (_options & kOptionGammaSimd) {
+    GammaCoversRasterizer gammaCovers(_rasterizer, _gammaCovers);
+    renderScanlinesFrom(gammaCovers, sl, rect, style);
+  }
+  else {
+    renderScanlinesFrom(_rasterizer, sl, rect, style);
+  }
+  _rasterizer.reset();
+}
+
+template<typename ScanlineSource, typename Scanline>
+void AGGModule::renderScanlinesFrom(ScanlineSource& src, Scanline& sl, const BLRect& rect, uint32_t style) {
   switch (style) {
     case kBenchStyleSolid: {
       BLRgba32 c(_rndColor.nextRgba32());
       agg::rgba8 color(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), uint8_t(c.a()));
       color.premultiply();
       _rendererSolid.color(color);
-      agg::render_scanlines(_rasterizer, _scanline, _rendererSolid);
+      agg::render_scanlines(src, sl, _rendererSolid);
+      break;
+    }
+
+    case kBenchStyleLinearPad:
+    case kBenchStyleLinearRepeat:
+    case kBenchStyleLinearReflect:
+    case kBenchStyleRadialPad:
+    case kBenchStyleRadialRepeat:
+    case kBenchStyleRadialReflect: {
+      renderGradient(src, sl, rect, style);
       break;
     }
+
+    case kBenchStylePatternNN:
+    case kBenchStylePatternBI: {
+      renderPattern(src, sl, rect, style);
+      break;
+    }
+  }
+}
+
+template<typename SpanGenerator>
+void AGGModule::renderSpans(SpanGenerator& spanGen) {
+  if (_options & kOptionGamma) {
+    agg::render_scanlines_aa(_gammaRasterizer, _scanline, _rendererBase, _spanAllocator, spanGen);
+    _gammaRasterizer.reset();
+    return;
   }
 
+  if (_options & kOptionGammaSimd) {
+    GammaCoversRasterizer gammaCovers(_rasterizer, _gammaCovers);
+    agg::render_scanlines_aa(gammaCovers, _scanline, _rendererBase, _spanAllocator, spanGen);
+  }
+  else {
+    agg::render_scanlines_aa(_rasterizer, _scanline, _rendererBase, _spanAllocator, spanGen);
+  }
   _rasterizer.reset();
 }
 
+template<typename ScanlineSource, typename Scanline>
+void AGGModule::renderGradient(ScanlineSource& src, Scanline& sl, const BLRect& rect, uint32_t style) {
+  static const double offsets[3] = { 0.0, 0.5, 1.0 };
+
+  BLRgba32 c[3];
+  for (uint32_t i = 0; i < 3; i++)
+    c[i] = _rndColor.nextRgba32();
+
+  // Pad, Repeat, and Reflect styles follow each other in both groups.
+  bool linear = style < kBenchStyleRadialPad;
+  agg::gradient_extend_e extend = agg::gradient_extend_e((style - kBenchStyleLinearPad) % 3);
+
+  double x0, y0, x1, y1, r;
+  if (linear) {
+    x0 = rect.x + rect.w * 0.2;
+    y0 = rect.y + rect.h * 0.2;
+    x1 = rect.x + rect.w * 0.8;
+    y1 = rect.y + rect.h * 0.8;
+    r = 0.0;
+  }
+  else {
+    // Center (x0, y0) and focal point (x1, y1).
+    r = (rect.w + rect.h) / 4.0;
+    x0 = rect.x + rect.w / 2.0;
+    y0 = rect.y + rect.h / 2.0;
+    x1 = x0 - r / 2.0;
+    y1 = y0 - r / 2.0;
+  }
+
+  if (_options & kOptionSimdGradient) {
+    AGGGradientCache::Key key;
+    key.count = 3;
+    for (uint32_t i = 0; i < 3; i++) {
+      key.offsets[i] = offsets[i];
+      key.colors[i] = c[i].value;
+    }
+
+    const agg::gradient_lut_rgba8& lut = _gradientCache.get(key);
+    if (linear) {
+      agg::span_gradient_linear_sse2 spanGen;
+      spanGen.init(lut, extend, x0, y0, x1, y1);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+    }
+    else {
+      agg::span_gradient_radial_sse2 spanGen;
+      spanGen.init(lut, extend, x0, y0, r, x1, y1);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+    }
+    return;
+  }
+
+  _gradientLut.remove_all();
+  for (uint32_t i = 0; i < 3; i++) {
+    agg::rgba8 color(uint8_t(c[i].r()), uint8_t(c[i].g()), uint8_t(c[i].b()), uint8_t(c[i].a()));
+    color.premultiply();
+    _gradientLut.add_color(offsets[i], color);
+  }
+  _gradientLut.build_lut();
+
+  if (linear) {
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+
+    agg::trans_affine matrix(agg::trans_affine_rotation(atan2(dy, dx)) * agg::trans_affine_translation(x0, y0));
+    matrix.invert();
+
+    Interpolator interpolator(matrix);
+    agg::gradient_x func;
+    renderSpanGradient(src, sl, interpolator, func, extend, sqrt(dx * dx + dy * dy));
+  }
+  else {
+    agg::trans_affine matrix(agg::trans_affine_translation(x0, y0));
+    matrix.invert();
+
+    Interpolator interpolator(matrix);
+    agg::gradient_radial_focus func(r, x1 - x0, y1 - y0);
+    renderSpanGradient(src, sl, interpolator, func, extend, r);
+  }
+}
+
+template<typename ScanlineSource, typename Scanline>
+void AGGModule::renderPattern(ScanlineSource& src, Scanline& sl, const BLRect& rect, uint32_t style) {
+  PixelFormat sprite(_aggSprites[nextSpriteId()]);
+
+  agg::trans_affine matrix(agg::trans_affine_translation(rect.x, rect.y));
+  matrix.invert();
+
+  if (_options & kOptionSimdImage) {
+    if (style == kBenchStylePatternNN) {
+      agg::span_image_filter_rgba_nn_sse2<PixelFormat> spanGen(sprite, matrix);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+    }
+    else {
+      agg::span_image_filter_rgba_bilinear_sse2<PixelFormat> spanGen(sprite, matrix);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+    }
+    return;
+  }
+
+  typedef agg::image_accessor_wrap<PixelFormat, agg::wrap_mode_repeat, agg::wrap_mode_repeat> ImageAccessor;
+
+  ImageAccessor accessor(sprite);
+  Interpolator interpolator(matrix);
+
+  if (style == kBenchStylePatternNN) {
+    agg::span_image_filter_rgba_nn<ImageAccessor, Interpolator> spanGen(accessor, interpolator);
+    agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+  }
+  else {
+    agg::span_image_filter_rgba_bilinear<ImageAccessor, Interpolator> spanGen(accessor, interpolator);
+    agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+  }
+}
+
+template<typename ScanlineSource, typename Scanline, typename GradientFunc>
+void AGGModule::renderSpanGradient(ScanlineSource& src, Scanline& sl, Interpolator& interpolator, GradientFunc& func, agg::gradient_extend_e extend, double d2) {
+  switch (extend) {
+    case agg::gradient_extend_pad: {
+      agg::span_gradient<agg::rgba8, Interpolator, GradientFunc, GradientLut> spanGen(interpolator, func, _gradientLut, 0.0, d2);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+      break;
+    }
+
+    case agg::gradient_extend_repeat: {
+      typedef agg::gradient_repeat_adaptor<GradientFunc> RepeatFunc;
+
+      RepeatFunc repeatFunc(func);
+      agg::span_gradient<agg::rgba8, Interpolator, RepeatFunc, GradientLut> spanGen(interpolator, repeatFunc, _gradientLut, 0.0, d2);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+      break;
+    }
+
+    case agg::gradient_extend_reflect: {
+      typedef agg::gradient_reflect_adaptor<GradientFunc> ReflectFunc;
+
+      ReflectFunc reflectFunc(func);
+      agg::span_gradient<agg::rgba8, Interpolator, ReflectFunc, GradientLut> spanGen(interpolator, reflectFunc, _gradientLut, 0.0, d2);
+      agg::render_scanlines_aa(src, sl, _rendererBase, _spanAllocator, spanGen);
+      break;
+    }
+  }
+}
+
 void AGGModule::fillRectAA(int x, int y, int w, int h, uint32_t style) {
   switch (style) {
     case kBenchStyleSolid: {
@@ -205,18 +698,77 @@ void AGGModule::fillRectAA(int x, int y, int w, int h, uint32_t style) {
       _rendererBase.blend_bar(x, y, x + w, y + h, color, 0xFFu);
       break;
     }
+
+    default: {
+      BLRect rect(x, y, w, h);
+      AGGRectSource r(rect);
+
+      addPath(r);
+      renderScanlines(rect, style);
+      break;
+    }
   }
 }
 
+void AGGModule::fillingRule(agg::filling_rule_e rule) {
+  if (_options & kOptionGamma)
+    _gammaRasterizer.filling_rule(rule);
+  else
+    _rasterizer.filling_rule(rule);
+}
+
+template<typename T>
+void AGGModule::addPath(T& path) {
+  if (_options & kOptionGamma)
+    _gammaRasterizer.add_path(path);
+  else
+    _rasterizer.add_path(path);
+}
+
+template<typename T>
+void AGGModule::addBlockPath(T& path) {
+  if (_options & kOptionGamma)
+    agg::add_path_block(_gammaRasterizer, path);
+  else
+    agg::add_path_block(_rasterizer, path);
+}
+
+void AGGModule::addIntegerPath(const IntegerVertex* vertices, unsigned count, int dx, int dy) {
+  if (_options & kOptionGamma)
+    agg::add_integer_vertices(_gammaRasterizer, vertices, count, dx, dy);
+  else
+    agg::add_integer_vertices(_rasterizer, vertices, count, dx, dy);
+}
+
 template<typename T>
 void AGGModule::rasterizePath(T& path, bool stroke) {
   if (stroke) {
-    agg::conv_stroke<T> strokedPath(path);
-    strokedPath.width(_params.strokeWidth);
-    _rasterizer.add_path(strokedPath);
+    agg::conv_adaptor_vcgen<T, agg::vcgen_ref<agg::vcgen_stroke>> strokedPath(path);
+    strokedPath.generator().attach(_stroker);
+    addPath(strokedPath);
   }
   else {
-    _rasterizer.add_path(path);
+    addPath(path);
+  }
+}
+
+template<typename T>
+void AGGModule::rasterizeBlockPath(T& path, bool stroke) {
+  if (stroke) {
+    // The stroker only understands the classic protocol, so the input is
+    // unpacked from blocks and its output is packed into blocks again.
+    typedef agg::vertex_source_block_adaptor<T> ClassicSource;
+    typedef agg::conv_adaptor_vcgen<ClassicSource, agg::vcgen_ref<agg::vcgen_stroke>> StrokedPath;
+
+    ClassicSource classicPath(path);
+    StrokedPath strokedPath(classicPath);
+    strokedPath.generator().attach(_stroker);
+
+    agg::vertex_block_adaptor<StrokedPath> strokedBlocks(strokedPath);
+    addBlockPath(strokedBlocks);
+  }
+  else {
+    addBlockPath(path);
   }
 }
 
@@ -231,7 +783,20 @@ bool AGGModule::supportsCompOp(uint32_t compOp) const {
 }
 
 bool AGGModule::supportsStyle(uint32_t style) const {
-  return style == kBenchStyleSolid;
+  return style == kBenchStyleSolid         ||
+         style == kBenchStyleLinearPad     ||
+         style == kBenchStyleLinearRepeat  ||
+         style == kBenchStyleLinearReflect ||
+         style == kBenchStyleRadialPad     ||
+         style == kBenchStyleRadialRepeat  ||
+         style == kBenchStyleRadialReflect ||
+         style == kBenchStylePatternNN     ||
+         style == kBenchStylePatternBI     ;
+}
+
+bool AGGModule::supportsFormat(uint32_t format) const {
+  // The pixel format is a compile-time type (`PixelFormat`) of all renderers.
+  return format == BL_FORMAT_PRGB32;
 }
 
 void AGGModule::onBeforeRun() {
@@ -240,30 +805,18 @@ void AGGModule::onBeforeRun() {
   uint32_t style = _params.style;
 
   // Initialize the sprites.
-
-  // TODO: Not supported yet,
-  /*
   for (uint32_t i = 0; i < kBenchNumSprites; i++) {
-    const BLImage& sprite = _sprites[i];
-
     BLImageData spriteData;
-    sprite.getData(&spriteData);
-
-    int stride = int(spriteData.stride);
-    int format = AGGUtils::toAGGFormat(spriteData.format);
-    unsigned char* pixels = static_cast<unsigned char*>(spriteData.pixelData);
-
-    cairo_surface_t* cairoSprite = cairo_image_surface_create_for_data(
-      pixels, cairo_format_t(format), spriteData.size.w, spriteData.size.h, stride);
+    _sprites[i].getData(&spriteData);
 
-    _cairoSprites[i] = cairoSprite;
+    _aggSprites[i].attach((unsigned char*)spriteData.pixelData,
+      unsigned(spriteData.size.w), unsigned(spriteData.size.h), int(spriteData.stride));
   }
-  */
 
   // Initialize AGG.
   {
     BLImageData surfaceData;
-    _surface.create(w, h, _params.format);
+    createSurface();
     _surface.makeMutable(&surfaceData);
 
     _aggSurface.attach((unsigned char*)surfaceData.pixelData, unsigned(w), unsigned(h), int(surfaceData.stride));
@@ -273,17 +826,46 @@ void AGGModule::onBeforeRun() {
 
     _aggSurface.clear(uint32_t(0));
     _rasterizer.clip_box(0, 0, w, h);
+    _gammaRasterizer.clip_box(0, 0, w, h);
+    _stroker.width(_params.strokeWidth);
   }
+
+  _coverageCache.reset();
+  _gradientCache.reset();
+
+#if defined(AGG_CUSTOM_ALLOCATOR)
+  _allocCountBefore = agg::allocation_count();
+#endif
 }
 
-void AGGModule::onAfterRun() {}
+void AGGModule::onAfterRun() {
+#if defined(AGG_CUSTOM_ALLOCATOR)
+  bool stroke = _params.benchId >= kBenchIdStrokeAlignedRect && _params.benchId <= kBenchIdStrokeShapeWorld;
+  AllocStats& allocStats = _allocStats[stroke];
+  allocStats.allocations += agg::allocation_count() - _allocCountBefore;
+  allocStats.shapes += _params.quantity;
+#endif
+
+  if (_options & kOptionCoverageCache) {
+    CacheStats& stats = _cacheStats[_params.benchId];
+    stats.hits += _coverageCache._hits;
+    stats.misses += _coverageCache._misses;
+    stats.byteSize = std::max(stats.byteSize, _coverageCache._byteSize);
+  }
+
+  if (_options & kOptionSimdGradient) {
+    _gradientCacheStats.hits += _gradientCache._hits;
+    _gradientCacheStats.misses += _gradientCache._misses;
+    _gradientCacheStats.byteSize = std::max(_gradientCacheStats.byteSize, size_t(_gradientCache._size) * sizeof(agg::gradient_lut_rgba8));
+  }
+}
 
 void AGGModule::onDoRectAligned(bool stroke) {
   BLSizeI bounds(_params.screenW, _params.screenH);
   uint32_t style = _params.style;
   int wh = _params.shapeSize;
 
-  _rasterizer.filling_rule(agg::fill_non_zero);
+  fillingRule(agg::fill_non_zero);
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
     BLRectI rect(_rndCoord.nextRectI(bounds, wh, wh));
@@ -294,7 +876,12 @@ void AGGModule::onDoRectAligned(bool stroke) {
     else {
       BLRect rectD(rect);
       AGGRectSource r(rectD);
-      rasterizePath(r, stroke);
+
+      if (_options & kOptionBlockPipeline)
+        rasterizeBlockPath(r, stroke);
+      else
+        rasterizePath(r, stroke);
+
       renderScanlines(rect, style);
     }
   }
@@ -305,12 +892,17 @@ void AGGModule::onDoRectSmooth(bool stroke) {
   uint32_t style = _params.style;
   double wh = _params.shapeSize;
 
-  _rasterizer.filling_rule(agg::fill_non_zero);
+  fillingRule(agg::fill_non_zero);
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
     BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
     AGGRectSource r(rect);
-    rasterizePath(r, stroke);
+
+    if (_options & kOptionBlockPipeline)
+      rasterizeBlockPath(r, stroke);
+    else
+      rasterizePath(r, stroke);
+
     renderScanlines(rect, style);
   }
 }
@@ -324,7 +916,7 @@ void AGGModule::onDoRectRotated(bool stroke) {
   double wh = _params.shapeSize;
   double angle = 0.0;
 
-  _rasterizer.filling_rule(agg::fill_non_zero);
+  fillingRule(agg::fill_non_zero);
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++, angle += 0.01) {
     BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
@@ -335,9 +927,15 @@ void AGGModule::onDoRectRotated(bool stroke) {
     affine.rotate(angle);
     affine.translate(cx, cy);
 
-    agg::conv_transform<AGGRectSource, agg::trans_affine> transformedRRect(r, affine);
+    if (_options & kOptionBlockPipeline) {
+      agg::conv_transform_block<AGGRectSource, agg::trans_affine> transformedRRect(r, affine);
+      rasterizeBlockPath(transformedRRect, stroke);
+    }
+    else {
+      agg::conv_transform<AGGRectSource, agg::trans_affine> transformedRRect(r, affine);
+      rasterizePath(transformedRRect, stroke);
+    }
 
-    rasterizePath(transformedRRect, stroke);
     renderScanlines(rect, style);
   }
 }
@@ -347,7 +945,7 @@ void AGGModule::onDoRoundSmooth(bool stroke) {
   uint32_t style = _params.style;
   double wh = _params.shapeSize;
 
-  _rasterizer.filling_rule(agg::fill_non_zero);
+  fillingRule(agg::fill_non_zero);
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
     BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
@@ -356,7 +954,14 @@ void AGGModule::onDoRoundSmooth(bool stroke) {
     agg::rounded_rect r(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, radius);
     r.normalize_radius();
 
-    rasterizePath(r, stroke);
+    if (_options & kOptionBlockPipeline) {
+      agg::vertex_block_adaptor<agg::rounded_rect> rBlocks(r);
+      rasterizeBlockPath(rBlocks, stroke);
+    }
+    else {
+      rasterizePath(r, stroke);
+    }
+
     renderScanlines(rect, style);
   }
 }
@@ -370,7 +975,7 @@ void AGGModule::onDoRoundRotated(bool stroke) {
   double wh = _params.shapeSize;
   double angle = 0.0;
 
-  _rasterizer.filling_rule(agg::fill_non_zero);
+  fillingRule(agg::fill_non_zero);
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++, angle += 0.01) {
     BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
@@ -384,9 +989,18 @@ void AGGModule::onDoRoundRotated(bool stroke) {
     affine.rotate(angle);
     affine.translate(cx, cy);
 
-    agg::conv_transform<agg::rounded_rect, agg::trans_affine> transformedRRect(r, affine);
+    if (_options & kOptionBlockPipeline) {
+      typedef agg::vertex_block_adaptor<agg::rounded_rect> RRectBlocks;
+
+      RRectBlocks rBlocks(r);
+      agg::conv_transform_block<RRectBlocks, agg::trans_affine> transformedRRect(rBlocks, affine);
+      rasterizeBlockPath(transformedRRect, stroke);
+    }
+    else {
+      agg::conv_transform<agg::rounded_rect, agg::trans_affine> transformedRRect(r, affine);
+      rasterizePath(transformedRRect, stroke);
+    }
 
-    rasterizePath(transformedRRect, stroke);
     renderScanlines(rect, style);
   }
 }
@@ -399,13 +1013,37 @@ void AGGModule::onDoPolygon(uint32_t mode, uint32_t complexity) {
   bool stroke = (mode == 2);
   double wh = _params.shapeSize;
 
-  _rasterizer.filling_rule(mode == 1 ? agg::fill_even_odd : agg::fill_non_zero);
+  fillingRule(mode == 1 ? agg::fill_even_odd : agg::fill_non_zero);
+
+  if ((_options & kOptionIntegerPath) && !stroke) {
+    // Random vertices are quantized as they are generated, the same way
+    // add_path() would do it, but they reach the rasterizer as integers.
+    std::vector<IntegerVertex> vertices(complexity);
+
+    for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+      BLPoint base(_rndCoord.nextPoint(bounds));
+
+      for (uint32_t j = 0; j < complexity; j++) {
+        int x = agg::iround(_rndCoord.nextDouble(base.x, base.x + wh) * agg::poly_subpixel_scale);
+        int y = agg::iround(_rndCoord.nextDouble(base.y, base.y + wh) * agg::poly_subpixel_scale);
+        vertices[j] = IntegerVertex(x, y, j == 0 ? IntegerVertex::cmd_move_to : IntegerVertex::cmd_line_to);
+      }
+
+      addIntegerPath(vertices.data(), complexity, 0, 0);
+      renderScanlines(BLRect(base.x, base.y, wh, wh), style);
+    }
+    return;
+  }
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
     BLPoint base(_rndCoord.nextPoint(bounds));
     AGGRandomPolySource path(base, wh, _rndCoord, complexity);
 
-    rasterizePath(path, stroke);
+    if (_options & kOptionBlockPipeline)
+      rasterizeBlockPath(path, stroke);
+    else
+      rasterizePath(path, stroke);
+
     renderScanlines(BLRect(base.x, base.y, wh, wh), style);
   }
 }
@@ -417,16 +1055,412 @@ void AGGModule::onDoShape(bool stroke, const BLPoint* pts, size_t count) {
   uint32_t style = _params.style;
   double wh = double(_params.shapeSize);
 
-  _rasterizer.filling_rule(agg::fill_non_zero);
+  fillingRule(agg::fill_non_zero);
+
+  if (_options & kOptionCoverageCache) {
+    AGGCoverageCache::Key key;
+    key.pathId = pts;
+    key.sx = wh;
+    key.shy = 0.0;
+    key.shx = 0.0;
+    key.sy = wh;
+    key.strokeWidth = stroke ? _params.strokeWidth : 0.0;
+    key.fillRule = agg::fill_non_zero;
+
+    agg::serialized_scanlines_adaptor_aa8 cached;
+    agg::serialized_scanlines_adaptor_aa8::embedded_scanline cachedScanline;
+
+    for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+      BLPoint tr(_rndCoord.nextPoint(bounds));
+
+      double ix = floor(tr.x);
+      double iy = floor(tr.y);
+      uint32_t bx = AGGCoverageCache::bucketOf(tr.x - ix);
+      uint32_t by = AGGCoverageCache::bucketOf(tr.y - iy);
+
+      key.bucket = by * AGGCoverageCache::kSubpixelBuckets + bx;
+      const AGGCoverageCache::Data* data = _coverageCache.find(key);
+
+      if (!data) {
+        // Rasterize at the origin displaced by the bucket center, without
+        // clipping, so the stored coverage can be replayed anywhere.
+        BLPoint sub(AGGCoverageCache::bucketCenter(bx), AGGCoverageCache::bucketCenter(by));
+        AGGShapeDataSource path(pts, count, sub, wh);
+
+        _rasterizer.reset_clipping();
+        rasterizePath(path, stroke);
+        data = _coverageCache.add(key, _rasterizer, _scanline);
+
+        _rasterizer.reset();
+        _rasterizer.clip_box(0, 0, _params.screenW, _params.screenH);
+      }
+
+      cached.init(data->data(), unsigned(data->size()), ix, iy);
+      renderScanlinesFrom(cached, cachedScanline, BLRect(tr.x, tr.y, wh, wh), style);
+    }
+    return;
+  }
+
+  if ((_options & kOptionIntegerPath) && !stroke) {
+    // Quantize the shape once, like map tiles that arrive already quantized,
+    // each instance is then only translated by whole subpixels.
+    IntegerPath shape;
+    bool start = true;
+
+    for (size_t i = 0; i < count; i++) {
+      if (pts[i].x == -1.0) {
+        start = true;
+        continue;
+      }
+
+      int x = agg::iround(pts[i].x * wh * agg::poly_subpixel_scale);
+      int y = agg::iround(pts[i].y * wh * agg::poly_subpixel_scale);
+
+      if (start)
+        shape.move_to(x, y);
+      else
+        shape.line_to(x, y);
+      start = false;
+    }
+
+    std::vector<IntegerVertex> vertices(shape.size());
+    shape.serialize(reinterpret_cast<agg::int8u*>(vertices.data()));
+
+    for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+      BLPoint tr(_rndCoord.nextPoint(bounds));
+
+      addIntegerPath(vertices.data(), unsigned(vertices.size()),
+                     agg::iround(tr.x * agg::poly_subpixel_scale),
+                     agg::iround(tr.y * agg::poly_subpixel_scale));
+      renderScanlines(BLRect(tr.x, tr.y, wh, wh), style);
+    }
+    return;
+  }
 
   for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
     BLPoint tr(_rndCoord.nextPoint(bounds));
     AGGShapeDataSource path(pts, count, tr, wh);
-    rasterizePath(path, stroke);
+
+    if (_options & kOptionBlockPipeline)
+      rasterizeBlockPath(path, stroke);
+    else
+      rasterizePath(path, stroke);
+
     renderScanlines(BLRect(tr.x, tr.y, wh, wh), style);
   }
 }
 
+void AGGModule::onDoHairline(uint32_t mode) {
+  uint32_t style = _params.style;
+  BenchHairline hairline;
+
+  if ((_options & kOptionOutlineAA) && style == kBenchStyleSolid) {
+    RendererOutline renderer(_rendererBase, _lineProfileCache.get(1.0));
+    RasterizerOutline rasterizer(renderer);
+
+    for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+      nextHairline(hairline, mode);
+
+      BLRgba32 c(_rndColor.nextRgba32());
+      agg::rgba8 color(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), uint8_t(c.a()));
+      color.premultiply();
+      renderer.color(color);
+
+      AGGHairlineSource path(hairline);
+      rasterizer.add_path(path);
+    }
+    return;
+  }
+
+  fillingRule(agg::fill_non_zero);
+  _stroker.width(1.0);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    nextHairline(hairline, mode);
+    AGGHairlineSource path(hairline);
+
+    if (_options & kOptionBlockPipeline) {
+      agg::vertex_block_adaptor<AGGHairlineSource> pathBlocks(path);
+      rasterizeBlockPath(pathBlocks, true);
+    }
+    else {
+      rasterizePath(path, true);
+    }
+
+    renderScanlines(hairline.bounds, style);
+  }
+
+  _stroker.width(_params.strokeWidth);
+}
+
+template<typename AlphaMask>
+static void AGGModule_onDoMaskedFillT(AGGModule* self, AlphaMask& alphaMask) {
+  BLSize bounds(self->_params.screenW, self->_params.screenH);
+  uint32_t style = self->_params.style;
+  double wh = self->_params.shapeSize;
+
+  // The mask must be applied after gamma as `kOptionGamma` applies gamma to the
+  // covers before they reach the scanline. `kOptionGammaSimd` applies it to the
+  // swept scanline, so the mask is applied by `AGGMaskedSource` after it.
+  agg::scanline_u8_am<AlphaMask> sl(alphaMask);
+  agg::scanline_u8 gammaSl;
+  self->fillingRule(agg::fill_non_zero);
+
+  for (uint32_t i = 0, quantity = self->_params.quantity; i < quantity; i++) {
+    BLRect rect(self->_rndCoord.nextRect(bounds, wh, wh));
+    double radius = self->_rndExtra.nextDouble(4.0, 40.0);
+
+    agg::rounded_rect r(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, radius);
+    r.normalize_radius();
+
+    if (self->_options & AGGModule::kOptionBlockPipeline) {
+      agg::vertex_block_adaptor<agg::rounded_rect> rBlocks(r);
+      self->rasterizeBlockPath(rBlocks, false);
+    }
+    else {
+      self->rasterizePath(r, false);
+    }
+
+    if (self->_options & AGGModule::kOptionGammaSimd) {
+      AGGModule::GammaCoversRasterizer gammaCovers(self->_rasterizer, self->_gammaCovers);
+      AGGMaskedSource<AGGModule::GammaCoversRasterizer, AlphaMask> masked(gammaCovers, alphaMask);
+      self->renderScanlinesFrom(masked, gammaSl, rect, style);
+      self->_rasterizer.reset();
+    }
+    else {
+      self->renderScanlinesWith(sl, rect, style);
+    }
+  }
+}
+
+void AGGModule::onDoMaskedFill() {
+  BLImageData maskData;
+  _maskA8.getData(&maskData);
+  _aggMask.attach(static_cast<agg::int8u*>(maskData.pixelData), unsigned(maskData.size.w), unsigned(maskData.size.h), int(maskData.stride));
+
+  if (_options & kOptionSimdMask) {
+    agg::alpha_mask_gray8_sse2 alphaMask(_aggMask);
+    AGGModule_onDoMaskedFillT(this, alphaMask);
+  }
+  else {
+    agg::alpha_mask_gray8 alphaMask(_aggMask);
+    AGGModule_onDoMaskedFillT(this, alphaMask);
+  }
+}
+
+template<typename SpanGenerator>
+static void AGGModule_onDoGouraudMeshT(AGGModule* self) {
+  const BenchMesh& mesh = self->_mesh;
+  BLSizeI bounds(self->_params.screenW - mesh.size, self->_params.screenH - mesh.size);
+
+  agg::rgba8 colors[3];
+  uint32_t triangleCount = mesh.triangleCount();
+
+  self->fillingRule(agg::fill_non_zero);
+
+  for (uint32_t i = 0, quantity = self->_params.quantity; i < quantity; i++) {
+    BLPoint base(self->_rndCoord.nextPoint(bounds));
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      uint32_t idx[3];
+      mesh.triangle(t, idx);
+
+      // Mesh colors are opaque, no need to premultiply.
+      for (uint32_t j = 0; j < 3; j++) {
+        BLRgba32 c(mesh.colors[idx[j]]);
+        colors[j] = agg::rgba8(uint8_t(c.r()), uint8_t(c.g()), uint8_t(c.b()), uint8_t(c.a()));
+      }
+
+      const BLPoint& p0 = mesh.points[idx[0]];
+      const BLPoint& p1 = mesh.points[idx[1]];
+      const BLPoint& p2 = mesh.points[idx[2]];
+
+      // The span generator is also the vertex source of the (dilated) triangle.
+      SpanGenerator spanGen(colors[0], colors[1], colors[2],
+                            base.x + p0.x, base.y + p0.y,
+                            base.x + p1.x, base.y + p1.y,
+                            base.x + p2.x, base.y + p2.y,
+                            aggGouraudDilation);
+      self->addPath(spanGen);
+      self->renderSpans(spanGen);
+    }
+  }
+}
+
+void AGGModule::onDoGouraudMesh() {
+  if (_options & kOptionSimdGouraud)
+    AGGModule_onDoGouraudMeshT<agg::span_gouraud_rgba8_sse2>(this);
+  else
+    AGGModule_onDoGouraudMeshT<agg::span_gouraud_rgba<agg::rgba8>>(this);
+}
+
+void AGGModule::onDoBatch(uint32_t mode) {
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  fillingRule(agg::fill_non_zero);
+  nextBatch(mode);
+
+  // All shapes are added to the rasterizer and rendered by a single style
+  // spanning the whole screen. Overlapping shapes are merged by the non-zero
+  // rule, so they are composited once.
+  switch (mode) {
+    case kBenchBatchAlignedRect: {
+      for (const BLRectI& rect : _batch.rectsI) {
+        BLRect rectD(rect);
+        AGGRectSource r(rectD);
+        rasterizePath(r, false);
+      }
+      break;
+    }
+
+    case kBenchBatchSmoothRect: {
+      for (const BLRect& rect : _batch.rects) {
+        AGGRectSource r(rect);
+        rasterizePath(r, false);
+      }
+      break;
+    }
+
+    case kBenchBatchPolygon: {
+      const BLPoint* p = _batch.points.data();
+      for (size_t i = 0, count = _batch.polygonCount(); i < count; i++, p += BenchBatch::kPolygonSize) {
+        agg::poly_plain_adaptor<double> poly(reinterpret_cast<const double*>(p), BenchBatch::kPolygonSize, true);
+        rasterizePath(poly, false);
+      }
+      break;
+    }
+  }
+
+  renderScanlines(screen, style);
+}
+
+static void AGGModule_buildPath(agg::path_storage& path, const BLPoint* p) {
+  path.move_to(p[0].x, p[0].y);
+  for (uint32_t i = 1; i < BenchPathSet::kPointCount; i += 3)
+    path.curve4(p[i].x, p[i].y, p[i + 1].x, p[i + 1].y, p[i + 2].x, p[i + 2].y);
+  path.close_polygon();
+}
+
+void AGGModule::onDoPaths(bool reuse) {
+  BLSizeI bounds(_params.screenW - _params.shapeSize,
+                 _params.screenH - _params.shapeSize);
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  if (reuse && _pathObjectsSize != _paths.size) {
+    for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+      _pathObjects[i].remove_all();
+      AGGModule_buildPath(_pathObjects[i], _paths.pathPoints(i));
+    }
+    _pathObjectsSize = _paths.size;
+  }
+
+  fillingRule(agg::fill_non_zero);
+
+  // Curves are flattened by `conv_curve` on each use in both modes, AGG has
+  // no way to keep a flattened path, so reuse only saves building the path.
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+    uint32_t pathId = i % BenchPathSet::kPathCount;
+    agg::trans_affine_translation affine(base.x, base.y);
+
+    if (reuse) {
+      agg::conv_curve<agg::path_storage> curve(_pathObjects[pathId]);
+      agg::conv_transform<agg::conv_curve<agg::path_storage>, agg::trans_affine> path(curve, affine);
+      rasterizePath(path, false);
+    }
+    else {
+      agg::path_storage storage;
+      AGGModule_buildPath(storage, _paths.pathPoints(pathId));
+
+      agg::conv_curve<agg::path_storage> curve(storage);
+      agg::conv_transform<agg::conv_curve<agg::path_storage>, agg::trans_affine> path(curve, affine);
+      rasterizePath(path, false);
+    }
+
+    renderScanlines(screen, style);
+  }
+}
+
+void AGGModule::onDoStateChurn(uint32_t mode) {
+  BLSize bounds(_params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+  double wh = _params.shapeSize;
+
+  fillingRule(agg::fill_non_zero);
+
+  // AGG has no graphics state, there is nothing to save, restore, or select,
+  // and span generators are built by each fill anyway. All modes render the
+  // same rectangles, the transform mode by transforming the vertices of a
+  // rectangle at the origin, which is how AGG applies transforms.
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+
+    if (mode == kBenchStateTransform) {
+      AGGRectSource r(BLRect(0, 0, rect.w, rect.h));
+      agg::trans_affine_translation affine(rect.x, rect.y);
+      agg::conv_transform<AGGRectSource, agg::trans_affine> transformedRect(r, affine);
+      rasterizePath(transformedRect, false);
+    }
+    else {
+      AGGRectSource r(rect);
+      rasterizePath(r, false);
+    }
+
+    renderScanlines(rect, style);
+  }
+}
+
+// ============================================================================
+// [bench::AGGModule - Statistics]
+// ============================================================================
+
+void AGGModule::resetStats() {
+  BenchModule::resetStats();
+  memset(_cacheStats, 0, sizeof(_cacheStats));
+  memset(_allocStats, 0, sizeof(_allocStats));
+  memset(&_gradientCacheStats, 0, sizeof(_gradientCacheStats));
+}
+
+void AGGModule::printStats() {
+#if defined(AGG_CUSTOM_ALLOCATOR)
+  printf("  Allocations per shape: fill %.3f, stroke %.3f\n",
+    double(_allocStats[0].allocations) / double(std::max<uint64_t>(_allocStats[0].shapes, 1)),
+    double(_allocStats[1].allocations) / double(std::max<uint64_t>(_allocStats[1].shapes, 1)));
+#endif
+
+  if (_options & kOptionSimdGradient) {
+    const CacheStats& stats = _gradientCacheStats;
+    uint64_t lookups = stats.hits + stats.misses;
+
+    if (lookups)
+      printf("  Gradient LUT cache: hit rate %5.1f%% (%llu hits, %llu misses), %llu KB stored\n",
+        double(stats.hits) * 100.0 / double(lookups),
+        (unsigned long long)stats.hits,
+        (unsigned long long)stats.misses,
+        (unsigned long long)(stats.byteSize + 1023) / 1024);
+  }
+
+  if (!(_options & kOptionCoverageCache))
+    return;
+
+  for (uint32_t benchId = 0; benchId < kBenchIdCount; benchId++) {
+    const CacheStats& stats = _cacheStats[benchId];
+    uint64_t lookups = stats.hits + stats.misses;
+
+    if (!lookups)
+      continue;
+
+    printf("  Coverage cache %-14s: hit rate %5.1f%% (%llu hits, %llu misses), %llu KB stored\n",
+      benchIdName(benchId),
+      double(stats.hits) * 100.0 / double(lookups),
+      (unsigned long long)stats.hits,
+      (unsigned long long)stats.misses,
+      (unsigned long long)(stats.byteSize + 1023) / 1024);
+  }
+}
+
 } // {blbench}
 
 #endif // BLBENCH_ENABLE_AGG
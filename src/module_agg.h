@@ -26,57 +26,348 @@
 
 #include "./module.h"
 
+#include "agg_alpha_mask_u8.h"
+#include "agg_alpha_mask_u8_sse2.h"
 #include "agg_basics.h"
+#include "agg_gamma_covers_sse2.h"
+#include "agg_gradient_lut.h"
+#include "agg_image_accessors.h"
 #include "agg_pixfmt_rgba.h"
+#include "agg_path_storage.h"
+#include "agg_path_storage_integer.h"
+#include "agg_rasterizer_integer_path.h"
+#include "agg_rasterizer_outline_aa.h"
+#include "agg_rasterizer_scanline_aa.h"
 #include "agg_rasterizer_scanline_aa_nogamma.h"
 #include "agg_renderer_base.h"
+#include "agg_renderer_outline_aa.h"
 #include "agg_renderer_scanline.h"
 #include "agg_scanline_p.h"
+#include "agg_scanline_storage_aa.h"
+#include "agg_scanline_u.h"
+#include "agg_span_allocator.h"
+#include "agg_span_gouraud_rgba.h"
+#include "agg_span_gouraud_rgba_sse2.h"
+#include "agg_span_gradient.h"
+#include "agg_span_gradient_sse2.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_span_image_filter_rgba_sse2.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_vcgen_stroke.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace blbench {
 
+// ============================================================================
+// [bench::AGGCoverageCache]
+// ============================================================================
+
+//! Coverage cache used to "rasterize once, blit many".
+//!
+//! Coverage of a path is stored as serialized AA scanlines keyed by the path
+//! identity, the transform without translation, and the sub-pixel offset of
+//! the translation quantized into `kSubpixelBuckets` buckets per axis. A hit
+//! replays the stored scanlines at an integer offset, so the output can differ
+//! from a direct rasterization by up to half a bucket (1/8 pixel).
+class AGGCoverageCache {
+public:
+  enum { kSubpixelBuckets = 4 };
+
+  struct Key {
+    const void* pathId;
+    double sx, shy, shx, sy;
+    double strokeWidth;
+    uint32_t fillRule;
+    uint32_t bucket;
+
+    inline bool operator==(const Key& other) const noexcept {
+      return pathId == other.pathId &&
+             sx == other.sx && shy == other.shy && shx == other.shx && sy == other.sy &&
+             strokeWidth == other.strokeWidth &&
+             fillRule == other.fillRule &&
+             bucket == other.bucket;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const noexcept;
+  };
+
+  typedef std::vector<agg::int8u> Data;
+  typedef std::unordered_map<Key, Data, KeyHash> Map;
+
+  Map _map;
+  agg::scanline_storage_aa8 _storage;
+
+  uint64_t _hits;
+  uint64_t _misses;
+  size_t _byteSize;
+
+  AGGCoverageCache();
+  ~AGGCoverageCache();
+
+  void reset();
+
+  //! Returns stored coverage for `key`, or null if it's not cached yet.
+  const Data* find(const Key& key);
+
+  //! Stores coverage produced by `ras` under `key`.
+  template<typename Rasterizer, typename Scanline>
+  const Data* add(const Key& key, Rasterizer& ras, Scanline& sl) {
+    _storage.prepare();
+    agg::render_scanlines(ras, sl, _storage);
+
+    Data& data = _map[key];
+    data.resize(_storage.byte_size());
+    if (!data.empty())
+      _storage.serialize(data.data());
+
+    _byteSize += data.size();
+    return &data;
+  }
+
+  static inline uint32_t bucketOf(double fraction) noexcept {
+    int b = int(fraction * double(kSubpixelBuckets));
+    return uint32_t(b < 0 ? 0 : b >= kSubpixelBuckets ? kSubpixelBuckets - 1 : b);
+  }
+
+  static inline double bucketCenter(uint32_t bucket) noexcept {
+    return (double(bucket) + 0.5) / double(kSubpixelBuckets);
+  }
+};
+
+// ============================================================================
+// [bench::AGGGradientCache]
+// ============================================================================
+
+//! Small LRU cache of gradient LUTs keyed by color stops.
+//!
+//! A LUT is only built when a gradient with the same stops isn't cached,
+//! which makes gradients that are recreated per shape with the same stops
+//! cheap.
+class AGGGradientCache {
+public:
+  enum {
+    kCapacity = 16,
+    kMaxStops = 4
+  };
+
+  struct Key {
+    uint32_t count;
+    double offsets[kMaxStops];
+    uint32_t colors[kMaxStops];
+
+    bool operator==(const Key& other) const noexcept;
+  };
+
+  struct Entry {
+    Key key;
+    uint64_t lastUse;
+    agg::gradient_lut_rgba8 lut;
+  };
+
+  Entry _entries[kCapacity];
+  uint32_t _size;
+  uint64_t _time;
+
+  uint64_t _hits;
+  uint64_t _misses;
+
+  AGGGradientCache();
+  ~AGGGradientCache();
+
+  void reset();
+
+  //! Returns a LUT of stops described by `key`, builds it if not cached.
+  const agg::gradient_lut_rgba8& get(const Key& key);
+};
+
+// ============================================================================
+// [bench::AGGLineProfileCache]
+// ============================================================================
+
+//! Line profiles of `agg::renderer_outline_aa` keyed by line width.
+//!
+//! Building a profile fills its gamma table and computes the profile itself,
+//! which costs more than rendering many short lines, so each width is only
+//! built once and kept for the lifetime of the module.
+class AGGLineProfileCache {
+public:
+  struct Entry {
+    double width;
+    std::unique_ptr<agg::line_profile_aa> profile;
+  };
+
+  std::vector<Entry> _entries;
+
+  AGGLineProfileCache();
+  ~AGGLineProfileCache();
+
+  //! Returns a profile of the given `width`, builds it if not cached.
+  agg::line_profile_aa& get(double width);
+};
+
 // ============================================================================
 // [bench::AGGModule]
 // ============================================================================
 
 struct AGGModule : public BenchModule {
+  enum Options : uint32_t {
+    //! Replays cached coverage of translated shapes, see `AGGCoverageCache`.
+    kOptionCoverageCache = 0x00000001u,
+    //! Moves vertices in blocks through the pipeline, see `agg_vertex_block.h`.
+    kOptionBlockPipeline = 0x00000002u,
+    //! Renders gradients by SSE2 span generators and caches their LUTs.
+    kOptionSimdGradient = 0x00000004u,
+    //! Renders patterns by SSE2 image filters instead of the classic ones.
+    kOptionSimdImage = 0x00000008u,
+    //! Renders solid hairlines by `agg::rasterizer_outline_aa` instead of stroking them.
+    kOptionOutlineAA = 0x00000010u,
+    //! Applies gamma by `agg::rasterizer_scanline_aa` and its per-cover gamma table.
+    kOptionGamma = 0x00000020u,
+    //! Applies the same gamma to swept scanlines in bulk, see `agg_gamma_covers_sse2.h`.
+    kOptionGammaSimd = 0x00000040u,
+    //! Combines covers with the alpha mask by SSE2, see `agg_alpha_mask_u8_sse2.h`.
+    kOptionSimdMask = 0x00000080u,
+    //! Fills polygons and shapes by integer vertices, see `agg_rasterizer_integer_path.h`.
+    kOptionIntegerPath = 0x00000100u,
+    //! Renders Gouraud shaded triangles by `agg::span_gouraud_rgba8_sse2`.
+    kOptionSimdGouraud = 0x00000200u,
+
+    kOptionAll = kOptionCoverageCache | kOptionBlockPipeline | kOptionSimdGradient | kOptionSimdImage | kOptionOutlineAA |
+                 kOptionGamma | kOptionGammaSimd | kOptionSimdMask | kOptionIntegerPath | kOptionSimdGouraud
+  };
+
+  struct CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t byteSize;
+  };
+
+  struct AllocStats {
+    uint64_t allocations;
+    uint64_t shapes;
+  };
+
   typedef agg::pixfmt_bgra32_pre PixelFormat;
   typedef agg::rasterizer_scanline_aa_nogamma<> Rasterizer;
+  typedef agg::rasterizer_scanline_aa<> GammaRasterizer;
+  typedef agg::rasterizer_gamma_covers<Rasterizer, agg::gamma_power_covers_sse2> GammaCoversRasterizer;
+  typedef agg::path_storage_integer<int, agg::poly_subpixel_shift> IntegerPath;
+  typedef IntegerPath::vertex_integer_type IntegerVertex;
   typedef agg::renderer_base<PixelFormat> RendererBase;
   typedef agg::renderer_scanline_aa_solid<RendererBase> RendererSolid;
+  typedef agg::span_allocator<agg::rgba8> SpanAllocator;
+  typedef agg::span_interpolator_linear<> Interpolator;
+  typedef agg::gradient_lut<agg::color_interpolator<agg::rgba8>, 256> GradientLut;
+  typedef agg::renderer_outline_aa<RendererBase> RendererOutline;
+  typedef agg::rasterizer_outline_aa<RendererOutline> RasterizerOutline;
 
   agg::rendering_buffer _aggSurface;
+  agg::rendering_buffer _aggSprites[kBenchNumSprites];
+  //! Attached to `_maskA8` by `onDoMaskedFill()`.
+  agg::rendering_buffer _aggMask;
   agg::scanline_p8 _scanline;
 
   PixelFormat _pixfmt;
   Rasterizer _rasterizer;
 
+  //! Rasterizer used instead of `_rasterizer` by `kOptionGamma`.
+  GammaRasterizer _gammaRasterizer;
+  //! Gamma applied to covers swept by `_rasterizer` by `kOptionGammaSimd`.
+  agg::gamma_power_covers_sse2 _gammaCovers;
+
   RendererBase _rendererBase;
   RendererSolid _rendererSolid;
 
+  SpanAllocator _spanAllocator;
+  GradientLut _gradientLut;
+
+  //! Stroke generator shared by all stroked paths, so its vertex storage is
+  //! only allocated once and not for each path.
+  agg::vcgen_stroke _stroker;
+
+  uint32_t _options;
+  AGGCoverageCache _coverageCache;
+  CacheStats _cacheStats[kBenchIdCount];
+
+  AGGGradientCache _gradientCache;
+  CacheStats _gradientCacheStats;
+
+  AGGLineProfileCache _lineProfileCache;
+
+  //! Path objects of `_paths` reused by `onDoPaths()`, built for the shape
+  //! size `_pathObjectsSize` (0 if not built yet).
+  agg::path_storage _pathObjects[BenchPathSet::kPathCount];
+  uint32_t _pathObjectsSize;
+
+  uint64_t _allocCountBefore;
+  //! Allocation statistics of fills [0] and strokes [1], only `Stroke*` benchmarks
+  //! are strokes, everything else (including hairlines) counts as fills.
+  AllocStats _allocStats[2];
+
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
 
-  AGGModule();
+  explicit AGGModule(uint32_t options = 0);
   virtual ~AGGModule();
 
+  static const char* optionName(uint32_t option);
+
   // --------------------------------------------------------------------------
   // [AGG]
   // --------------------------------------------------------------------------
 
   void renderScanlines(const BLRect& rect, uint32_t style);
+
+  template<typename Scanline>
+  void renderScanlinesWith(Scanline& sl, const BLRect& rect, uint32_t style);
+
+  template<typename ScanlineSource, typename Scanline>
+  void renderScanlinesFrom(ScanlineSource& src, Scanline& sl, const BLRect& rect, uint32_t style);
+
+  //! Renders the rasterized path by `spanGen`, independent of the style.
+  template<typename SpanGenerator>
+  void renderSpans(SpanGenerator& spanGen);
+
+  template<typename ScanlineSource, typename Scanline>
+  void renderGradient(ScanlineSource& src, Scanline& sl, const BLRect& rect, uint32_t style);
+
+  template<typename ScanlineSource, typename Scanline>
+  void renderPattern(ScanlineSource& src, Scanline& sl, const BLRect& rect, uint32_t style);
+
+  template<typename ScanlineSource, typename Scanline, typename GradientFunc>
+  void renderSpanGradient(ScanlineSource& src, Scanline& sl, Interpolator& interpolator, GradientFunc& func, agg::gradient_extend_e extend, double d2);
+
   void fillRectAA(int x, int y, int w, int h, uint32_t style);
+  void fillingRule(agg::filling_rule_e rule);
+
+  template<typename T>
+  void addPath(T& path);
+
+  template<typename T>
+  void addBlockPath(T& path);
+
+  //! Adds integer vertices translated by `dx`, `dy` subpixels (`kOptionIntegerPath`).
+  void addIntegerPath(const IntegerVertex* vertices, unsigned count, int dx, int dy);
 
   template<typename T>
   void rasterizePath(T& path, bool stroke);
 
+  template<typename T>
+  void rasterizeBlockPath(T& path, bool stroke);
+
   // --------------------------------------------------------------------------
   // [Interface]
   // --------------------------------------------------------------------------
 
   virtual bool supportsCompOp(uint32_t compOp) const;
   virtual bool supportsStyle(uint32_t style) const;
+  virtual bool supportsFormat(uint32_t format) const;
 
   virtual void onBeforeRun();
   virtual void onAfterRun();
@@ -88,6 +379,15 @@ struct AGGModule : public BenchModule {
   virtual void onDoRoundRotated(bool stroke);
   virtual void onDoPolygon(uint32_t mode, uint32_t complexity);
   virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count);
+  virtual void onDoHairline(uint32_t mode);
+  virtual void onDoMaskedFill();
+  virtual void onDoGouraudMesh();
+  virtual void onDoBatch(uint32_t mode);
+  virtual void onDoPaths(bool reuse);
+  virtual void onDoStateChurn(uint32_t mode);
+
+  virtual void resetStats();
+  virtual void printStats();
 };
 
 } // {blbench}
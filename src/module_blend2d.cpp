@@ -24,7 +24,15 @@
 #include "./app.h"
 #include "./module_blend2d.h"
 
+#include <algorithm>
+#include <chrono>
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+  #include <unistd.h>
+#endif
 
 namespace blbench {
 
@@ -32,9 +40,21 @@ namespace blbench {
 // [bench::Blend2DModule - Construction / Destruction]
 // ============================================================================
 
-Blend2DModule::Blend2DModule(uint32_t threadCount, uint32_t cpuFeatures) {
+Blend2DModule::Blend2DModule(uint32_t threadCount, uint32_t cpuFeatures, bool persistent,
+                             bool tuning, uint32_t commandQueueLimit, uint32_t flushInterval) {
   _threadCount = threadCount;
   _cpuFeatures = cpuFeatures;
+  _tuning = tuning;
+  _commandQueueLimit = commandQueueLimit;
+  _flushInterval = flushInterval;
+  _persistent = persistent;
+  _contextActive = false;
+
+  memset(&_beginStats, 0, sizeof(_beginStats));
+  _residentBase = 0;
+  _residentPeak = 0;
+  _residentHighWater = false;
+  _pathObjectsSize = 0;
 
   const char* feature = nullptr;
 
@@ -46,17 +66,105 @@ Blend2DModule::Blend2DModule(uint32_t threadCount, uint32_t cpuFeatures) {
   if (_cpuFeatures & BL_RUNTIME_CPU_FEATURE_X86_AVX   ) feature = "[AVX]";
   if (_cpuFeatures & BL_RUNTIME_CPU_FEATURE_X86_AVX2  ) feature = "[AVX2]";
 
+  // Tuning parameters are appended as "Q<commandQueueLimit>" ("Qdef" if it's
+  // the default) and "F<flushInterval>".
+  char mode[32];
+  int modeSize = snprintf(mode, sizeof(mode), "%s", _persistent ? " Steady" : "");
+
+  if (_tuning) {
+    if (_commandQueueLimit)
+      modeSize += snprintf(mode + modeSize, sizeof(mode) - size_t(modeSize), " Q%u", _commandQueueLimit);
+    else
+      modeSize += snprintf(mode + modeSize, sizeof(mode) - size_t(modeSize), " Qdef");
+  }
+
+  if (_flushInterval)
+    snprintf(mode + modeSize, sizeof(mode) - size_t(modeSize), " F%u", _flushInterval);
+
   if (!_threadCount)
-    snprintf(_name, sizeof(_name), "Blend2D ST%s%s", feature ? " " : "", feature ? feature : "");
+    snprintf(_name, sizeof(_name), "Blend2D ST%s%s%s", mode, feature ? " " : "", feature ? feature : "");
   else
-    snprintf(_name, sizeof(_name), "Blend2D %uT%s%s", _threadCount, feature ? " " : "", feature ? feature : "");
+    snprintf(_name, sizeof(_name), "Blend2D %uT%s%s%s", _threadCount, mode, feature ? " " : "", feature ? feature : "");
+}
+
+Blend2DModule::~Blend2DModule() {
+  if (_contextActive)
+    _context.end();
 }
-Blend2DModule::~Blend2DModule() {}
 
 // ============================================================================
 // [bench::Blend2DModule - Helpers]
 // ============================================================================
 
+// Returns the resident memory of the process in bytes, 0 if not available.
+static size_t BlendUtil_residentMemory() {
+#if defined(__linux__)
+  FILE* f = fopen("/proc/self/statm", "r");
+  if (!f)
+    return 0;
+
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int n = fscanf(f, "%lu %lu", &size, &resident);
+  fclose(f);
+
+  return n == 2 ? size_t(resident) * size_t(sysconf(_SC_PAGESIZE)) : size_t(0);
+#else
+  return 0;
+#endif
+}
+
+// Returns the highest resident memory of the process (VmHWM) in bytes, 0 if
+// not available.
+static size_t BlendUtil_residentHighWater() {
+#if defined(__linux__)
+  FILE* f = fopen("/proc/self/status", "r");
+  if (!f)
+    return 0;
+
+  char line[128];
+  unsigned long kb = 0;
+
+  while (fgets(line, sizeof(line), f))
+    if (sscanf(line, "VmHWM: %lu", &kb) == 1)
+      break;
+  fclose(f);
+
+  return size_t(kb) * 1024u;
+#else
+  return 0;
+#endif
+}
+
+// Resets the high water mark of the resident memory to the current resident
+// memory, returns false if not supported (Linux 4.0+ only).
+static bool BlendUtil_resetResidentHighWater() {
+#if defined(__linux__)
+  FILE* f = fopen("/proc/self/clear_refs", "w");
+  if (!f)
+    return false;
+
+  bool ok = fputs("5", f) >= 0;
+  ok &= fclose(f) == 0;
+  return ok;
+#else
+  return false;
+#endif
+}
+
+// Returns whether the rendering context of the linked Blend2D can render into
+// A8 images, older versions only render into 32-bit ones.
+static bool BlendUtil_supportsA8() {
+  static int supported = -1;
+  if (supported == -1) {
+    BLImage image(1, 1, BL_FORMAT_A8);
+    BLContext ctx;
+    supported = ctx.begin(image) == BL_SUCCESS;
+    ctx.end();
+  }
+  return supported == 1;
+}
+
 template<typename RectT>
 static void BlendUtil_setupGradient(Blend2DModule* self, BLGradient& gradient, uint32_t style, const RectT& rect) {
   switch (style) {
@@ -115,6 +223,56 @@ static void BlendUtil_setupGradient(Blend2DModule* self, BLGradient& gradient, u
   }
 }
 
+// Sets a fill style of the current benchmark style that spans the whole screen.
+static void BlendUtil_setupScreenStyle(Blend2DModule* self, BLGradient& gradient, BLPattern& pattern) {
+  BLRect screen(0, 0, self->_params.screenW, self->_params.screenH);
+  uint32_t style = self->_params.style;
+
+  switch (style) {
+    case kBenchStyleSolid: {
+      self->_context.setFillStyle(self->_rndColor.nextRgba32());
+      break;
+    }
+
+    case kBenchStylePatternNN:
+    case kBenchStylePatternBI: {
+      pattern.create(self->_sprites[self->nextSpriteId()]);
+      self->_context.setFillStyle(pattern);
+      break;
+    }
+
+    default: {
+      gradient.setExtendMode(self->_gradientExtend);
+      BlendUtil_setupGradient<BLRect>(self, gradient, style, screen);
+      self->_context.setFillStyle(gradient);
+      break;
+    }
+  }
+}
+
+// Builds a path of `BenchPathSet` from its points.
+static void BlendUtil_buildPath(BLPath& path, const BLPoint* p) {
+  path.moveTo(p[0].x, p[0].y);
+  for (uint32_t i = 1; i < BenchPathSet::kPointCount; i += 3)
+    path.cubicTo(p[i].x, p[i].y, p[i + 1].x, p[i + 1].y, p[i + 2].x, p[i + 2].y);
+  path.close();
+}
+
+// ============================================================================
+// [bench::Blend2DModule - Run]
+// ============================================================================
+
+void Blend2DModule::run(const BLImage* sprites, const BenchParams& params) {
+  BenchModule::run(sprites, params);
+
+  // Sampled after the run so it's not part of the measured time. The high
+  // water mark includes the command queue and jobs that `end()` released.
+  if (_tuning) {
+    size_t resident = _residentHighWater ? BlendUtil_residentHighWater() : BlendUtil_residentMemory();
+    _residentPeak = std::max(_residentPeak, resident);
+  }
+}
+
 // ============================================================================
 // [bench::Blend2DModule - Interface]
 // ============================================================================
@@ -136,6 +294,14 @@ bool Blend2DModule::supportsStyle(uint32_t style) const {
          style == kBenchStylePatternBI     ;
 }
 
+bool Blend2DModule::supportsFormat(uint32_t format) const {
+  if (format == BL_FORMAT_A8)
+    return BlendUtil_supportsA8();
+
+  return format == BL_FORMAT_PRGB32 ||
+         format == BL_FORMAT_XRGB32 ;
+}
+
 void Blend2DModule::onBeforeRun() {
   int w = int(_params.screenW);
   int h = int(_params.screenH);
@@ -143,6 +309,7 @@ void Blend2DModule::onBeforeRun() {
 
   BLContextCreateInfo createInfo {};
   createInfo.threadCount = _threadCount;
+  createInfo.commandQueueLimit = _commandQueueLimit;
 
   if (_cpuFeatures) {
     createInfo.flags = BL_CONTEXT_CREATE_FLAG_ISOLATED_JIT_RUNTIME |
@@ -150,8 +317,31 @@ void Blend2DModule::onBeforeRun() {
     createInfo.cpuFeatures = _cpuFeatures;
   }
 
-  _surface.create(w, h, _params.format);
-  _context.begin(_surface, &createInfo);
+  // A persistent context is only created once (or when the surface changes)
+  // and reset to its initial state by restore() before each run.
+  if (_contextActive && _surface.width() == w && _surface.height() == h && _surface.format() == uint32_t(_params.format)) {
+    _context.restore(_contextCookie);
+  }
+  else {
+    if (_contextActive) {
+      _context.end();
+      _contextActive = false;
+    }
+
+    // Mapping and touching the surface memory is not part of the begin() time.
+    createSurface();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    _context.begin(_surface, &createInfo);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    _beginStats.count++;
+    _beginStats.duration += uint64_t(std::chrono::duration<double>(end - start).count() * 1000000);
+    _contextActive = _persistent;
+  }
+
+  if (_persistent)
+    _context.save(_contextCookie);
 
   _context.setCompOp(BL_COMP_OP_SRC_COPY);
   _context.setFillStyle(BLRgba32(0x00000000));
@@ -181,7 +371,17 @@ void Blend2DModule::onBeforeRun() {
 }
 
 void Blend2DModule::onAfterRun() {
-  _context.end();
+  // Both are timed, a persistent context only waits for the rendering to
+  // finish, `end()` also releases the context and its worker threads.
+  if (_persistent)
+    _context.flush(BL_CONTEXT_FLUSH_SYNC);
+  else
+    _context.end();
+}
+
+void Blend2DModule::onFlush() {
+  // A frame boundary, the next frame starts when this one is rendered.
+  _context.flush(BL_CONTEXT_FLUSH_SYNC);
 }
 
 void Blend2DModule::onDoRectAligned(bool stroke) {
@@ -745,4 +945,384 @@ void Blend2DModule::onDoShape(bool stroke, const BLPoint* pts, size_t count) {
   }
 }
 
+void Blend2DModule::onDoHairline(uint32_t mode) {
+  uint32_t style = _params.style;
+
+  BenchHairline hairline;
+  BLPath path;
+  BLGradient gradient(_gradientType);
+  BLPattern pattern;
+
+  gradient.setExtendMode(_gradientExtend);
+  _context.setStrokeWidth(1.0);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    nextHairline(hairline, mode);
+
+    path.clear();
+    for (uint32_t p = 0; p < hairline.polyCount; p++) {
+      const BLPoint* pts = hairline.points + p * hairline.polySize;
+      path.moveTo(pts[0].x, pts[0].y);
+      for (uint32_t j = 1; j < hairline.polySize; j++)
+        path.lineTo(pts[j].x, pts[j].y);
+    }
+
+    _context.save();
+
+    switch (style) {
+      case kBenchStyleSolid: {
+        _context.setStrokeStyle(_rndColor.nextRgba32());
+        break;
+      }
+
+      case kBenchStyleLinearPad:
+      case kBenchStyleLinearRepeat:
+      case kBenchStyleLinearReflect:
+      case kBenchStyleRadialPad:
+      case kBenchStyleRadialRepeat:
+      case kBenchStyleRadialReflect:
+      case kBenchStyleConical: {
+        BlendUtil_setupGradient<BLRect>(this, gradient, style, hairline.bounds);
+        _context.setStrokeStyle(gradient);
+        break;
+      }
+
+      case kBenchStylePatternNN:
+      case kBenchStylePatternBI: {
+        pattern.create(_sprites[nextSpriteId()]);
+        pattern.setMatrix(BLMatrix2D::makeTranslation(hairline.bounds.x, hairline.bounds.y));
+        _context.setStrokeStyle(pattern);
+        break;
+      }
+    }
+
+    _context.strokePath(path);
+    _context.restore();
+  }
+
+  _context.setStrokeWidth(_params.strokeWidth);
+}
+
+void Blend2DModule::onDoMaskedFill() {
+  BLSize bounds(_params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+  double wh = _params.shapeSize;
+
+  BLGradient gradient(_gradientType);
+  gradient.setExtendMode(_gradientExtend);
+
+  BLPattern pattern;
+
+  // There is no soft mask in Blend2D, each shape is rendered into a layer,
+  // multiplied by the mask (DST_IN), and blitted. Layers are slots of a single
+  // image used round-robin. `_context` may be asynchronous and read a slot
+  // after the blit was submitted, so it's flushed before a slot is reused.
+  const uint32_t kLayerCount = 16;
+  int layerSize = int(wh) + 2;
+  BLImage layer(layerSize, layerSize * int(kLayerCount), BL_FORMAT_PRGB32);
+  BLContext layerContext(layer);
+
+  layerContext.setPatternQuality(
+    style == kBenchStylePatternNN
+      ? BL_PATTERN_QUALITY_NEAREST
+      : BL_PATTERN_QUALITY_BILINEAR);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    double radius = _rndExtra.nextDouble(4.0, 40.0);
+
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+    BLRoundRect round(rect, radius);
+
+    int x0 = int(floor(rect.x));
+    int y0 = int(floor(rect.y));
+    BLRectI area(x0, y0, int(ceil(rect.x + rect.w)) - x0, int(ceil(rect.y + rect.h)) - y0);
+
+    uint32_t slot = i % kLayerCount;
+    if (slot == 0 && i != 0)
+      _context.flush(BL_CONTEXT_FLUSH_SYNC);
+    BLRectI slotArea(0, int(slot) * layerSize, area.w, area.h);
+
+    layerContext.resetMatrix();
+    layerContext.setCompOp(BL_COMP_OP_SRC_OVER);
+    layerContext.clearRect(slotArea);
+    layerContext.translate(slotArea.x - area.x, slotArea.y - area.y);
+
+    switch (style) {
+      case kBenchStyleSolid: {
+        layerContext.setFillStyle(_rndColor.nextRgba32());
+        break;
+      }
+
+      case kBenchStyleLinearPad:
+      case kBenchStyleLinearRepeat:
+      case kBenchStyleLinearReflect:
+      case kBenchStyleRadialPad:
+      case kBenchStyleRadialRepeat:
+      case kBenchStyleRadialReflect:
+      case kBenchStyleConical: {
+        BlendUtil_setupGradient<BLRect>(this, gradient, style, rect);
+        layerContext.setFillStyle(gradient);
+        break;
+      }
+
+      case kBenchStylePatternNN:
+      case kBenchStylePatternBI: {
+        pattern.create(_sprites[nextSpriteId()]);
+        pattern.setMatrix(BLMatrix2D::makeTranslation(rect.x, rect.y));
+        layerContext.setFillStyle(pattern);
+        break;
+      }
+    }
+
+    layerContext.fillRoundRect(round);
+    layerContext.setCompOp(BL_COMP_OP_DST_IN);
+    layerContext.blitImage(BLPointI(area.x, area.y), _mask, area);
+
+    // The slot must be rendered before it's used by `_context`.
+    layerContext.flush(BL_CONTEXT_FLUSH_SYNC);
+    _context.blitImage(BLPointI(area.x, area.y), layer, slotArea);
+  }
+
+  // The last blits still read the layer, which is released on return.
+  layerContext.end();
+  _context.flush(BL_CONTEXT_FLUSH_SYNC);
+}
+
+void Blend2DModule::onDoGouraudMesh() {
+  const BenchMesh& mesh = _mesh;
+  BLSizeI bounds(_params.screenW - mesh.size, _params.screenH - mesh.size);
+  uint32_t triangleCount = mesh.triangleCount();
+
+  // Blend2D has no per-vertex colors, triangles are flat shaded.
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      uint32_t idx[3];
+      mesh.triangle(t, idx);
+
+      const BLPoint& p0 = mesh.points[idx[0]];
+      const BLPoint& p1 = mesh.points[idx[1]];
+      const BLPoint& p2 = mesh.points[idx[2]];
+
+      _context.setFillStyle(mesh.flatColors[t]);
+      _context.fillTriangle(base.x + p0.x, base.y + p0.y,
+                            base.x + p1.x, base.y + p1.y,
+                            base.x + p2.x, base.y + p2.y);
+    }
+  }
+}
+
+void Blend2DModule::onDoBatch(uint32_t mode) {
+  // A single style spanning the whole screen is used by all shapes.
+  BLGradient gradient(_gradientType);
+  BLPattern pattern;
+  BlendUtil_setupScreenStyle(this, gradient, pattern);
+
+  nextBatch(mode);
+
+  switch (mode) {
+    case kBenchBatchAlignedRect: {
+      _context.fillRectArray(_batch.rectsI.data(), _batch.rectsI.size());
+      break;
+    }
+
+    case kBenchBatchSmoothRect: {
+      _context.fillRectArray(_batch.rects.data(), _batch.rects.size());
+      break;
+    }
+
+    case kBenchBatchPolygon: {
+      size_t count = _batch.polygonCount();
+      const BLPoint* p = _batch.points.data();
+
+      BLPath path;
+      path.reserve(count * (BenchBatch::kPolygonSize + 1));
+
+      for (size_t i = 0; i < count; i++, p += BenchBatch::kPolygonSize) {
+        path.moveTo(p[0].x, p[0].y);
+        path.polyTo(p + 1, BenchBatch::kPolygonSize - 1);
+        path.close();
+      }
+
+      _context.setFillRule(BL_FILL_RULE_NON_ZERO);
+      _context.fillPath(path);
+      break;
+    }
+  }
+}
+
+void Blend2DModule::onDoPaths(bool reuse) {
+  BLSizeI bounds(_params.screenW - _params.shapeSize,
+                 _params.screenH - _params.shapeSize);
+
+  BLGradient gradient(_gradientType);
+  BLPattern pattern;
+  BlendUtil_setupScreenStyle(this, gradient, pattern);
+
+  if (reuse && _pathObjectsSize != _paths.size) {
+    for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+      _pathObjects[i].clear();
+      BlendUtil_buildPath(_pathObjects[i], _paths.pathPoints(i));
+    }
+    _pathObjectsSize = _paths.size;
+  }
+
+  _context.setFillRule(BL_FILL_RULE_NON_ZERO);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+    uint32_t pathId = i % BenchPathSet::kPathCount;
+
+    _context.save();
+    _context.translate(base);
+
+    if (reuse) {
+      _context.fillPath(_pathObjects[pathId]);
+    }
+    else {
+      BLPath path;
+      BlendUtil_buildPath(path, _paths.pathPoints(pathId));
+      _context.fillPath(path);
+    }
+
+    _context.restore();
+  }
+}
+
+void Blend2DModule::onDoStateChurn(uint32_t mode) {
+  BLSize bounds(_params.screenW, _params.screenH);
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+
+  uint32_t style = _params.style;
+  double wh = _params.shapeSize;
+
+  // Styles are created once and span the whole screen, fills only select them.
+  BLRgba32 colors[kBenchStateStyles];
+  BLGradient gradients[kBenchStateStyles];
+  BLPattern patterns[kBenchStateStyles];
+
+  for (uint32_t i = 0; i < kBenchStateStyles; i++) {
+    switch (style) {
+      case kBenchStyleSolid:
+        colors[i] = _rndColor.nextRgba32();
+        break;
+
+      case kBenchStylePatternNN:
+      case kBenchStylePatternBI:
+        patterns[i].create(_sprites[i % kBenchNumSprites]);
+        break;
+
+      default:
+        gradients[i] = BLGradient(_gradientType);
+        gradients[i].setExtendMode(_gradientExtend);
+        BlendUtil_setupGradient<BLRect>(this, gradients[i], style, screen);
+        break;
+    }
+  }
+
+  auto setStyle = [&](uint32_t i) {
+    if (style == kBenchStyleSolid)
+      _context.setFillStyle(colors[i]);
+    else if (style == kBenchStylePatternNN || style == kBenchStylePatternBI)
+      _context.setFillStyle(patterns[i]);
+    else
+      _context.setFillStyle(gradients[i]);
+  };
+
+  setStyle(0);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+
+    switch (mode) {
+      case kBenchStateNone: {
+        _context.fillRect(rect);
+        break;
+      }
+
+      case kBenchStateSave: {
+        uint32_t depth = 1 + i % kBenchStateMaxDepth;
+        for (uint32_t d = 0; d < depth; d++)
+          _context.save();
+
+        _context.fillRect(rect);
+
+        for (uint32_t d = 0; d < depth; d++)
+          _context.restore();
+        break;
+      }
+
+      case kBenchStateStyle: {
+        setStyle(i % kBenchStateStyles);
+        _context.fillRect(rect);
+        break;
+      }
+
+      case kBenchStateTransform: {
+        _context.save();
+        _context.translate(rect.x, rect.y);
+        _context.fillRect(BLRect(0, 0, rect.w, rect.h));
+        _context.restore();
+        break;
+      }
+    }
+  }
+}
+
+// ============================================================================
+// [bench::Blend2DModule - Statistics]
+// ============================================================================
+
+void Blend2DModule::resetStats() {
+  BenchModule::resetStats();
+  memset(&_beginStats, 0, sizeof(_beginStats));
+
+  _residentBase = 0;
+  _residentPeak = 0;
+  _residentHighWater = false;
+
+  if (_tuning) {
+    _residentBase = BlendUtil_residentMemory();
+    _residentPeak = _residentBase;
+    _residentHighWater = BlendUtil_resetResidentHighWater();
+  }
+}
+
+void Blend2DModule::printStats() {
+  const BenchTiming& timing = _timing;
+
+  if (timing.runs) {
+    double runs = double(timing.runs);
+    double total = double(timing.submit + timing.flush);
+
+    // Submit is the time the calling thread is busy, during flush it only
+    // waits for the workers (or renders itself if there are none).
+    printf("  Time per run: submit %9.1f us, %s %9.1f us, total %9.1f us, submit %5.1f%%\n",
+      double(timing.submit) / runs,
+      _persistent ? "flush(SYNC)" : "end()      ",
+      double(timing.flush) / runs,
+      total / runs,
+      total > 0.0 ? double(timing.submit) * 100.0 / total : 0.0);
+
+    if (_threadCount)
+      printf("  Worker CPU time per run: %9.1f us (%.2f workers busy on average)\n",
+        double(timing.workerCpu) / runs,
+        total > 0.0 ? double(timing.workerCpu) / total : 0.0);
+  }
+
+  if (_beginStats.count)
+    printf("  Context setup: %llu begin() calls, %.1f us per call (not measured)\n",
+      (unsigned long long)_beginStats.count,
+      double(_beginStats.duration) / double(_beginStats.count));
+
+  // Includes everything the process allocated during the table, which is
+  // mostly the context (command queue, jobs, and its zone memory).
+  if (_residentBase)
+    printf("  Resident memory: %llu KB peak %s, %+lld KB from the start of the table\n",
+      (unsigned long long)(_residentPeak / 1024u),
+      _residentHighWater ? "during runs" : "after runs ",
+      (long long)(_residentPeak / 1024u) - (long long)(_residentBase / 1024u));
+}
+
 } // {blbench}
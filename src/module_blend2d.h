@@ -35,11 +35,43 @@ namespace blbench {
 
 class Blend2DModule : public BenchModule {
 public:
+  struct ContextStats {
+    uint64_t count;
+    uint64_t duration;
+  };
 
   BLContext _context;
   uint32_t _threadCount;
   uint32_t _cpuFeatures;
 
+  //! Tuning module (command queue limit and frame flush sweep), which also
+  //! samples the resident memory after each run.
+  bool _tuning;
+  //! `BLContextCreateInfo::commandQueueLimit`, zero means the default.
+  uint32_t _commandQueueLimit;
+
+  //! Keeps `_context` and `_surface` alive across runs, see `onBeforeRun()`.
+  bool _persistent;
+  //! True if `_context` is attached to `_surface` (persistent mode).
+  bool _contextActive;
+  //! State of `_context` right after `begin()`, restored before each run.
+  BLContextCookie _contextCookie;
+
+  //! Time spent in `begin()`, which is not part of the measured time.
+  ContextStats _beginStats;
+  //! Resident memory of the process at the beginning of the table and the
+  //! highest one sampled after runs (0 if not available), only tuning modules.
+  size_t _residentBase;
+  size_t _residentPeak;
+  //! True if the high water mark of the process was reset by `resetStats()`,
+  //! in that case `_residentPeak` includes memory released by `end()`.
+  bool _residentHighWater;
+
+  //! Path objects of `_paths` reused by `onDoPaths()`, built for the shape
+  //! size `_pathObjectsSize` (0 if not built yet).
+  BLPath _pathObjects[BenchPathSet::kPathCount];
+  uint32_t _pathObjectsSize;
+
   // Initialized by onBeforeRun().
   BLGradientType _gradientType;
   BLExtendMode _gradientExtend;
@@ -48,15 +80,23 @@ public:
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
 
-  explicit Blend2DModule(uint32_t threadCount = 0, uint32_t cpuFeatures = 0);
+  explicit Blend2DModule(uint32_t threadCount = 0, uint32_t cpuFeatures = 0, bool persistent = false,
+                         bool tuning = false, uint32_t commandQueueLimit = 0, uint32_t flushInterval = 0);
   virtual ~Blend2DModule();
 
+  // --------------------------------------------------------------------------
+  // [Run]
+  // --------------------------------------------------------------------------
+
+  virtual void run(const BLImage* sprites, const BenchParams& params);
+
   // --------------------------------------------------------------------------
   // [Interface]
   // --------------------------------------------------------------------------
 
   virtual bool supportsCompOp(uint32_t compOp) const;
   virtual bool supportsStyle(uint32_t style) const;
+  virtual bool supportsFormat(uint32_t format) const;
 
   virtual void onBeforeRun();
   virtual void onAfterRun();
@@ -68,6 +108,16 @@ public:
   virtual void onDoRoundRotated(bool stroke);
   virtual void onDoPolygon(uint32_t mode, uint32_t complexity);
   virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count);
+  virtual void onDoHairline(uint32_t mode);
+  virtual void onDoMaskedFill();
+  virtual void onDoGouraudMesh();
+  virtual void onDoBatch(uint32_t mode);
+  virtual void onDoPaths(bool reuse);
+  virtual void onDoStateChurn(uint32_t mode);
+  virtual void onFlush();
+
+  virtual void resetStats();
+  virtual void printStats();
 };
 
 } // {blbench}
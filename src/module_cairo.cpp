@@ -122,8 +122,14 @@ CairoModule::CairoModule() {
   _cairoSurface = NULL;
   _cairoContext = NULL;
   memset(_cairoSprites, 0, sizeof(_cairoSprites));
+  memset(_pathObjects, 0, sizeof(_pathObjects));
+  _pathObjectsSize = 0;
+}
+CairoModule::~CairoModule() {
+  for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++)
+    if (_pathObjects[i])
+      cairo_path_destroy(_pathObjects[i]);
 }
-CairoModule::~CairoModule() {}
 
 // ============================================================================
 // [bench::CairoModule - Helpers]
@@ -222,6 +228,10 @@ bool CairoModule::supportsStyle(uint32_t style) const {
          style == kBenchStylePatternBI     ;
 }
 
+bool CairoModule::supportsFormat(uint32_t format) const {
+  return CairoUtils::toCairoFormat(format) != 0xFFFFFFFFu;
+}
+
 void CairoModule::onBeforeRun() {
   int w = int(_params.screenW);
   int h = int(_params.screenH);
@@ -247,7 +257,7 @@ void CairoModule::onBeforeRun() {
   // Initialize the surface and the context.
   {
     BLImageData surfaceData;
-    _surface.create(w, h, _params.format);
+    createSurface();
     _surface.makeMutable(&surfaceData);
 
     int stride = int(surfaceData.stride);
@@ -505,6 +515,247 @@ void CairoModule::onDoShape(bool stroke, const BLPoint* pts, size_t count) {
   cairo_path_destroy(path);
 }
 
+void CairoModule::onDoHairline(uint32_t mode) {
+  uint32_t style = _params.style;
+  BenchHairline hairline;
+
+  cairo_set_line_width(_cairoContext, 1.0);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    nextHairline(hairline, mode);
+
+    for (uint32_t p = 0; p < hairline.polyCount; p++) {
+      const BLPoint* pts = hairline.points + p * hairline.polySize;
+      cairo_move_to(_cairoContext, pts[0].x, pts[0].y);
+      for (uint32_t j = 1; j < hairline.polySize; j++)
+        cairo_line_to(_cairoContext, pts[j].x, pts[j].y);
+    }
+
+    setupStyle<BLRect>(style, hairline.bounds);
+    cairo_stroke(_cairoContext);
+  }
+
+  cairo_set_line_width(_cairoContext, _params.strokeWidth);
+}
+
+void CairoModule::onDoMaskedFill() {
+  BLSize bounds(_params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  double wh = _params.shapeSize;
+
+  BLImageData maskData;
+  _maskA8.getData(&maskData);
+
+  cairo_surface_t* mask = cairo_image_surface_create_for_data(
+    static_cast<unsigned char*>(maskData.pixelData), CAIRO_FORMAT_A8,
+    maskData.size.w, maskData.size.h, int(maskData.stride));
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+    double radius = _rndExtra.nextDouble(4.0, 40.0);
+
+    // The shape is the clip, the mask is painted through it by the source.
+    setupStyle<BLRect>(style, rect);
+    CairoUtils::roundRect(_cairoContext, rect, radius);
+    cairo_clip(_cairoContext);
+    cairo_mask_surface(_cairoContext, mask, 0.0, 0.0);
+    cairo_reset_clip(_cairoContext);
+  }
+
+  cairo_surface_destroy(mask);
+}
+
+void CairoModule::onDoGouraudMesh() {
+  const BenchMesh& mesh = _mesh;
+  BLSizeI bounds(_params.screenW - mesh.size, _params.screenH - mesh.size);
+  uint32_t triangleCount = mesh.triangleCount();
+  double wh = double(mesh.size);
+
+  // Cairo renders Gouraud shaded triangles as mesh pattern patches that have
+  // 3 sides, the pattern is built once and translated for each instance.
+  cairo_pattern_t* pattern = cairo_pattern_create_mesh();
+
+  for (uint32_t t = 0; t < triangleCount; t++) {
+    uint32_t idx[3];
+    mesh.triangle(t, idx);
+
+    cairo_mesh_pattern_begin_patch(pattern);
+    cairo_mesh_pattern_move_to(pattern, mesh.points[idx[0]].x, mesh.points[idx[0]].y);
+    cairo_mesh_pattern_line_to(pattern, mesh.points[idx[1]].x, mesh.points[idx[1]].y);
+    cairo_mesh_pattern_line_to(pattern, mesh.points[idx[2]].x, mesh.points[idx[2]].y);
+
+    for (uint32_t j = 0; j < 3; j++) {
+      BLRgba32 c(mesh.colors[idx[j]]);
+      cairo_mesh_pattern_set_corner_color_rgb(pattern, j, u8ToUnit(c.r()), u8ToUnit(c.g()), u8ToUnit(c.b()));
+    }
+
+    cairo_mesh_pattern_end_patch(pattern);
+  }
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+
+    cairo_save(_cairoContext);
+    cairo_translate(_cairoContext, base.x, base.y);
+    cairo_set_source(_cairoContext, pattern);
+    cairo_rectangle(_cairoContext, 0.0, 0.0, wh, wh);
+    cairo_fill(_cairoContext);
+    cairo_restore(_cairoContext);
+  }
+
+  cairo_pattern_destroy(pattern);
+}
+
+void CairoModule::onDoBatch(uint32_t mode) {
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  // All shapes form a single path filled by a single style.
+  setupStyle<BLRect>(style, screen);
+  cairo_set_fill_rule(_cairoContext, CAIRO_FILL_RULE_WINDING);
+  nextBatch(mode);
+
+  switch (mode) {
+    case kBenchBatchAlignedRect: {
+      for (const BLRectI& rect : _batch.rectsI)
+        cairo_rectangle(_cairoContext, rect.x, rect.y, rect.w, rect.h);
+      break;
+    }
+
+    case kBenchBatchSmoothRect: {
+      for (const BLRect& rect : _batch.rects)
+        cairo_rectangle(_cairoContext, rect.x, rect.y, rect.w, rect.h);
+      break;
+    }
+
+    case kBenchBatchPolygon: {
+      const BLPoint* p = _batch.points.data();
+      for (size_t i = 0, count = _batch.polygonCount(); i < count; i++, p += BenchBatch::kPolygonSize) {
+        cairo_move_to(_cairoContext, p[0].x, p[0].y);
+        for (uint32_t j = 1; j < BenchBatch::kPolygonSize; j++)
+          cairo_line_to(_cairoContext, p[j].x, p[j].y);
+        cairo_close_path(_cairoContext);
+      }
+      break;
+    }
+  }
+
+  cairo_fill(_cairoContext);
+}
+
+static void CairoModule_buildPath(cairo_t* ctx, const BLPoint* p) {
+  cairo_move_to(ctx, p[0].x, p[0].y);
+  for (uint32_t i = 1; i < BenchPathSet::kPointCount; i += 3)
+    cairo_curve_to(ctx, p[i].x, p[i].y, p[i + 1].x, p[i + 1].y, p[i + 2].x, p[i + 2].y);
+  cairo_close_path(ctx);
+}
+
+void CairoModule::onDoPaths(bool reuse) {
+  BLSizeI bounds(_params.screenW - _params.shapeSize,
+                 _params.screenH - _params.shapeSize);
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  // Paths are copied out of the context, which has no transform here, so
+  // they hold coordinates relative to the box and are appended translated.
+  if (reuse && _pathObjectsSize != _paths.size) {
+    for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+      if (_pathObjects[i])
+        cairo_path_destroy(_pathObjects[i]);
+
+      cairo_new_path(_cairoContext);
+      CairoModule_buildPath(_cairoContext, _paths.pathPoints(i));
+      _pathObjects[i] = cairo_copy_path(_cairoContext);
+    }
+    cairo_new_path(_cairoContext);
+    _pathObjectsSize = _paths.size;
+  }
+
+  // The source keeps the transform it was set with, so it spans the screen
+  // regardless of the translation of each path.
+  setupStyle<BLRect>(style, screen);
+  cairo_set_fill_rule(_cairoContext, CAIRO_FILL_RULE_WINDING);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+    uint32_t pathId = i % BenchPathSet::kPathCount;
+
+    cairo_save(_cairoContext);
+    cairo_translate(_cairoContext, base.x, base.y);
+
+    if (reuse)
+      cairo_append_path(_cairoContext, _pathObjects[pathId]);
+    else
+      CairoModule_buildPath(_cairoContext, _paths.pathPoints(pathId));
+
+    cairo_fill(_cairoContext);
+    cairo_restore(_cairoContext);
+  }
+}
+
+void CairoModule::onDoStateChurn(uint32_t mode) {
+  BLSize bounds(_params.screenW, _params.screenH);
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+
+  uint32_t style = _params.style;
+  double wh = _params.shapeSize;
+
+  // Styles are created once and span the whole screen, setupStyle() sets the
+  // source, which is kept (solid colors are patterns in Cairo as well).
+  cairo_pattern_t* patterns[kBenchStateStyles];
+  for (uint32_t i = 0; i < kBenchStateStyles; i++) {
+    setupStyle<BLRect>(style, screen);
+    patterns[i] = cairo_pattern_reference(cairo_get_source(_cairoContext));
+  }
+
+  cairo_set_source(_cairoContext, patterns[0]);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+
+    switch (mode) {
+      case kBenchStateNone: {
+        cairo_rectangle(_cairoContext, rect.x, rect.y, rect.w, rect.h);
+        cairo_fill(_cairoContext);
+        break;
+      }
+
+      case kBenchStateSave: {
+        uint32_t depth = 1 + i % kBenchStateMaxDepth;
+        for (uint32_t d = 0; d < depth; d++)
+          cairo_save(_cairoContext);
+
+        cairo_rectangle(_cairoContext, rect.x, rect.y, rect.w, rect.h);
+        cairo_fill(_cairoContext);
+
+        for (uint32_t d = 0; d < depth; d++)
+          cairo_restore(_cairoContext);
+        break;
+      }
+
+      case kBenchStateStyle: {
+        cairo_set_source(_cairoContext, patterns[i % kBenchStateStyles]);
+        cairo_rectangle(_cairoContext, rect.x, rect.y, rect.w, rect.h);
+        cairo_fill(_cairoContext);
+        break;
+      }
+
+      case kBenchStateTransform: {
+        cairo_save(_cairoContext);
+        cairo_translate(_cairoContext, rect.x, rect.y);
+        cairo_rectangle(_cairoContext, 0.0, 0.0, rect.w, rect.h);
+        cairo_fill(_cairoContext);
+        cairo_restore(_cairoContext);
+        break;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < kBenchStateStyles; i++)
+    cairo_pattern_destroy(patterns[i]);
+}
+
 } // {blbench}
 
 #endif // BLBENCH_ENABLE_CAIRO
@@ -50,6 +50,11 @@ struct CairoModule : public BenchModule {
   cairo_surface_t* _cairoSprites[kBenchNumSprites];
   cairo_t* _cairoContext;
 
+  //! Path objects of `_paths` reused by `onDoPaths()`, built for the shape
+  //! size `_pathObjectsSize` (0 if not built yet).
+  cairo_path_t* _pathObjects[BenchPathSet::kPathCount];
+  uint32_t _pathObjectsSize;
+
   // Initialized by onBeforeRun().
   uint32_t _patternExtend;
   uint32_t _patternFilter;
@@ -74,6 +79,7 @@ struct CairoModule : public BenchModule {
 
   virtual bool supportsCompOp(uint32_t compOp) const;
   virtual bool supportsStyle(uint32_t style) const;
+  virtual bool supportsFormat(uint32_t format) const;
 
   virtual void onBeforeRun();
   virtual void onAfterRun();
@@ -85,6 +91,12 @@ struct CairoModule : public BenchModule {
   virtual void onDoRoundRotated(bool stroke);
   virtual void onDoPolygon(uint32_t mode, uint32_t complexity);
   virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count);
+  virtual void onDoHairline(uint32_t mode);
+  virtual void onDoMaskedFill();
+  virtual void onDoGouraudMesh();
+  virtual void onDoBatch(uint32_t mode);
+  virtual void onDoPaths(bool reuse);
+  virtual void onDoStateChurn(uint32_t mode);
 };
 
 } // {blbench}
@@ -0,0 +1,164 @@
+// Blend2D - 2D Vector Graphics Powered by a JIT Compiler
+//
+//  * Official Blend2D Home Page: https://blend2d.com
+//  * Official Github Repository: https://github.com/blend2d/blend2d
+//
+// Copyright (c) 2017-2020 The Blend2D Authors
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "./module_plugin.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace blbench {
+
+// ============================================================================
+// [bench::PluginLibrary]
+// ============================================================================
+
+PluginLibrary::PluginLibrary()
+  : _handle(nullptr),
+    _api(nullptr) {}
+
+PluginLibrary::~PluginLibrary() {
+  if (_handle)
+    dlclose(_handle);
+}
+
+bool PluginLibrary::load(const char* path) {
+  // Each plugin links its own Blend2D, which must not be resolved to the one
+  // of `bl_bench` or of a plugin loaded before.
+  int flags = RTLD_NOW | RTLD_LOCAL;
+#if defined(RTLD_DEEPBIND)
+  flags |= RTLD_DEEPBIND;
+#endif
+
+  _handle = dlopen(path, flags);
+  if (!_handle) {
+    printf("ERROR: Failed to load plugin '%s': %s\n", path, dlerror());
+    return false;
+  }
+
+  BenchPluginQueryFunc query = reinterpret_cast<BenchPluginQueryFunc>(dlsym(_handle, BLBENCH_PLUGIN_QUERY));
+  if (!query) {
+    printf("ERROR: Plugin '%s' doesn't export %s()\n", path, BLBENCH_PLUGIN_QUERY);
+    return false;
+  }
+
+  _api = query();
+  if (!_api || _api->version != BLBENCH_PLUGIN_VERSION) {
+    printf("ERROR: Plugin '%s' has an incompatible version [%u], expected [%u]\n",
+      path, _api ? _api->version : 0u, unsigned(BLBENCH_PLUGIN_VERSION));
+    _api = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+// ============================================================================
+// [bench::PluginModule - Construction / Destruction]
+// ============================================================================
+
+PluginModule::PluginModule(const PluginLibrary& library, uint32_t moduleIndex, const char* label)
+  : _api(library._api),
+    _module(nullptr) {
+  if (_api && moduleIndex < _api->moduleCount)
+    _module = _api->create(moduleIndex);
+
+  snprintf(_name, sizeof(_name), "%s %s", label, _module ? _api->name(_module) : "<none>");
+}
+
+PluginModule::~PluginModule() {
+  // The surface may reference memory of the plugin module.
+  _surface.reset();
+
+  if (_module)
+    _api->destroy(_module);
+}
+
+// ============================================================================
+// [bench::PluginModule - Run]
+// ============================================================================
+
+void PluginModule::run(const BLImage* sprites, const BenchParams& params) {
+  _params = params;
+
+  BenchPluginParams pluginParams;
+  pluginParams.screenW = params.screenW;
+  pluginParams.screenH = params.screenH;
+  pluginParams.format = params.format;
+  pluginParams.quantity = params.quantity;
+  pluginParams.benchId = params.benchId;
+  pluginParams.compOp = params.compOp;
+  pluginParams.style = params.style;
+  pluginParams.shapeSize = params.shapeSize;
+  pluginParams.strokeWidth = params.strokeWidth;
+  pluginParams.surfaceMemory = params.surfaceMemory;
+  pluginParams.surfaceNode = params.surfaceNode;
+  pluginParams.surfacePadding = params.surfacePadding;
+
+  BenchPluginResult result;
+  _api->run(_module, &pluginParams, &result);
+
+  _duration = result.duration;
+  _submitDuration = result.submitDuration;
+  _flushDuration = result.flushDuration;
+
+  // Wraps the pixels of the plugin without a copy, so the surface can be saved.
+  BenchPluginSurface surface;
+  _api->surface(_module, &surface);
+
+  if (surface.pixelData)
+    _surface.createFromData(int(surface.w), int(surface.h), surface.format, surface.pixelData, surface.stride);
+  else
+    _surface.reset();
+}
+
+// ============================================================================
+// [bench::PluginModule - Interface]
+// ============================================================================
+
+bool PluginModule::supportsCompOp(uint32_t compOp) const {
+  return _api->supportsCompOp(_module, compOp) != 0;
+}
+
+bool PluginModule::supportsStyle(uint32_t style) const {
+  return _api->supportsStyle(_module, style) != 0;
+}
+
+bool PluginModule::supportsFormat(uint32_t format) const {
+  return _api->supportsFormat(_module, format) != 0;
+}
+
+// ============================================================================
+// [bench::PluginModule - Statistics]
+// ============================================================================
+
+void PluginModule::resetStats() {
+  BenchModule::resetStats();
+  _api->resetStats(_module);
+}
+
+void PluginModule::printStats() {
+  _api->printStats(_module);
+}
+
+} // {blbench}
@@ -0,0 +1,111 @@
+// Blend2D - 2D Vector Graphics Powered by a JIT Compiler
+//
+//  * Official Blend2D Home Page: https://blend2d.com
+//  * Official Github Repository: https://github.com/blend2d/blend2d
+//
+// Copyright (c) 2017-2020 The Blend2D Authors
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef BLBENCH_MODULE_PLUGIN_H
+#define BLBENCH_MODULE_PLUGIN_H
+
+#include "./module.h"
+#include "./plugin.h"
+
+namespace blbench {
+
+// ============================================================================
+// [bench::PluginLibrary]
+// ============================================================================
+
+//! A shared library with modules, see `plugin.h`.
+struct PluginLibrary {
+  void* _handle;
+  const BenchPluginApi* _api;
+
+  PluginLibrary();
+  ~PluginLibrary();
+
+  //! Loads the plugin at `path`, prints the reason and returns false if it
+  //! can't be loaded.
+  bool load(const char* path);
+};
+
+// ============================================================================
+// [bench::PluginModule]
+// ============================================================================
+
+//! A module of a plugin. The plugin does the whole run, including measuring
+//! it, so the `onDo*()` functions of this module are never called.
+struct PluginModule : public BenchModule {
+  const BenchPluginApi* _api;
+  void* _module;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Creates the module `moduleIndex` of `library`, named `label` followed by
+  //! the name of the module. Check `isValid()` before use.
+  PluginModule(const PluginLibrary& library, uint32_t moduleIndex, const char* label);
+  virtual ~PluginModule();
+
+  inline bool isValid() const { return _module != nullptr; }
+
+  // --------------------------------------------------------------------------
+  // [Run]
+  // --------------------------------------------------------------------------
+
+  virtual void run(const BLImage* sprites, const BenchParams& params);
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  virtual bool supportsCompOp(uint32_t compOp) const;
+  virtual bool supportsStyle(uint32_t style) const;
+  virtual bool supportsFormat(uint32_t format) const;
+
+  virtual void onBeforeRun() {}
+  virtual void onAfterRun() {}
+
+  virtual void onDoRectAligned(bool stroke) {}
+  virtual void onDoRectSmooth(bool stroke) {}
+  virtual void onDoRectRotated(bool stroke) {}
+  virtual void onDoRoundSmooth(bool stroke) {}
+  virtual void onDoRoundRotated(bool stroke) {}
+  virtual void onDoPolygon(uint32_t mode, uint32_t complexity) {}
+  virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count) {}
+  virtual void onDoHairline(uint32_t mode) {}
+  virtual void onDoMaskedFill() {}
+  virtual void onDoGouraudMesh() {}
+  virtual void onDoBatch(uint32_t mode) {}
+  virtual void onDoPaths(bool reuse) {}
+  virtual void onDoStateChurn(uint32_t mode) {}
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  virtual void resetStats();
+  virtual void printStats();
+};
+
+} // {blbench}
+
+#endif // BLBENCH_MODULE_PLUGIN_H
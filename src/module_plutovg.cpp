@@ -92,9 +92,15 @@ PlutovgModule::PlutovgModule() {
 	_PlutovgSurface = NULL;
 	_PlutovgContext = NULL;
 	memset(_PlutovgSprites, 0, sizeof(_PlutovgSprites));
+	memset(_pathObjects, 0, sizeof(_pathObjects));
+	_pathObjectsSize = 0;
 }
 
-PlutovgModule::~PlutovgModule() {}
+PlutovgModule::~PlutovgModule() {
+	for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++)
+		if (_pathObjects[i])
+			plutovg_path_destroy(_pathObjects[i]);
+}
 
 // ============================================================================
 // [bench::PlutovgModule - Helpers]
@@ -213,6 +219,11 @@ bool PlutovgModule::supportsStyle(uint32_t style) const {
 	return false;
 }
 
+bool PlutovgModule::supportsFormat(uint32_t format) const {
+	// Plutovg surfaces are always premultiplied ARGB32.
+	return format == BL_FORMAT_PRGB32;
+}
+
 void PlutovgModule::onBeforeRun() {
 	int w = int(_params.screenW);
 	int h = int(_params.screenH);
@@ -238,7 +249,7 @@ void PlutovgModule::onBeforeRun() {
 	// Initialize the surface and the context.
 	{
 		BLImageData surfaceData;
-		_surface.create(w, h, _params.format);
+		createSurface();
 		_surface.makeMutable(&surfaceData);
 
 		int stride = int(surfaceData.stride);
@@ -482,6 +493,283 @@ void PlutovgModule::onDoShape(bool stroke, const BLPoint* pts, size_t count) {
 	plutovg_path_destroy(path);
 }
 
+void PlutovgModule::onDoHairline(uint32_t mode) {
+	uint32_t style = _params.style;
+	BenchHairline hairline;
+
+	plutovg_set_line_width(_PlutovgContext, 1.0);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		nextHairline(hairline, mode);
+
+		for (uint32_t p = 0; p < hairline.polyCount; p++) {
+			const BLPoint* pts = hairline.points + p * hairline.polySize;
+			plutovg_move_to(_PlutovgContext, pts[0].x, pts[0].y);
+			for (uint32_t j = 1; j < hairline.polySize; j++)
+				plutovg_line_to(_PlutovgContext, pts[j].x, pts[j].y);
+		}
+
+		setupStyle<BLRect>(style, hairline.bounds);
+		plutovg_stroke(_PlutovgContext);
+	}
+
+	plutovg_set_line_width(_PlutovgContext, _params.strokeWidth);
+}
+
+void PlutovgModule::onDoMaskedFill() {
+	BLSize bounds(_params.screenW, _params.screenH);
+	uint32_t style = _params.style;
+
+	double wh = _params.shapeSize;
+
+	BLImageData maskData;
+	_mask.getData(&maskData);
+
+	plutovg_surface_t* mask = plutovg_surface_create_for_data(
+		static_cast<unsigned char*>(maskData.pixelData), maskData.size.w, maskData.size.h, int(maskData.stride));
+
+	// There is no soft mask in Plutovg, each shape is rendered into a layer
+	// that is large enough for any shape, multiplied by the mask (dst_in), and
+	// composited. The layer uses its own coordinates, shapes are moved there.
+	int layerSize = int(wh) + 2;
+
+	BLImage layerImage;
+	BLImageData layerData;
+	layerImage.create(layerSize, layerSize, BL_FORMAT_PRGB32);
+	layerImage.makeMutable(&layerData);
+
+	plutovg_surface_t* layer = plutovg_surface_create_for_data(
+		static_cast<unsigned char*>(layerData.pixelData), layerSize, layerSize, int(layerData.stride));
+	plutovg_t* layerContext = plutovg_create(layer);
+	plutovg_t* context = _PlutovgContext;
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+		double radius = _rndExtra.nextDouble(4.0, 40.0);
+
+		int x0 = int(rect.x);
+		int y0 = int(rect.y);
+		BLRect local(rect.x - x0, rect.y - y0, rect.w, rect.h);
+
+		plutovg_set_operator(layerContext, plutovg_operator_src);
+		plutovg_set_source_rgba(layerContext, 0, 0, 0, 0);
+		plutovg_rect(layerContext, 0, 0, layerSize, layerSize);
+		plutovg_fill(layerContext);
+
+		// setupStyle() sets the source of _PlutovgContext.
+		_PlutovgContext = layerContext;
+		plutovg_set_operator(layerContext, plutovg_operator_src_over);
+		setupStyle<BLRect>(style, local);
+		roundRect(layerContext, local, radius);
+		plutovg_fill(layerContext);
+		_PlutovgContext = context;
+
+		plutovg_matrix_t matrix;
+		plutovg_matrix_init_translate(&matrix, x0, y0);
+
+		plutovg_texture_t* texture = plutovg_texture_create(mask);
+		plutovg_texture_set_matrix(texture, &matrix);
+		plutovg_set_operator(layerContext, plutovg_operator_dst_in);
+		plutovg_set_source_texture(layerContext, texture);
+		plutovg_texture_destroy(texture);
+		plutovg_rect(layerContext, 0, 0, layerSize, layerSize);
+		plutovg_fill(layerContext);
+
+		plutovg_matrix_init_translate(&matrix, -x0, -y0);
+
+		texture = plutovg_texture_create(layer);
+		plutovg_texture_set_matrix(texture, &matrix);
+		plutovg_set_source_texture(context, texture);
+		plutovg_texture_destroy(texture);
+		plutovg_rect(context, x0, y0, layerSize, layerSize);
+		plutovg_fill(context);
+	}
+
+	plutovg_destroy(layerContext);
+	plutovg_surface_destroy(layer);
+	plutovg_surface_destroy(mask);
+}
+
+void PlutovgModule::onDoGouraudMesh() {
+	const BenchMesh& mesh = _mesh;
+	BLSizeI bounds(_params.screenW - mesh.size, _params.screenH - mesh.size);
+	uint32_t triangleCount = mesh.triangleCount();
+
+	// There is no per-vertex color in PlutoVG, triangles are flat shaded.
+	plutovg_set_fill_rule(_PlutovgContext, plutovg_fill_rule_non_zero);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLPoint base(_rndCoord.nextPoint(bounds));
+
+		for (uint32_t t = 0; t < triangleCount; t++) {
+			uint32_t idx[3];
+			mesh.triangle(t, idx);
+
+			const BLPoint& p0 = mesh.points[idx[0]];
+			const BLPoint& p1 = mesh.points[idx[1]];
+			const BLPoint& p2 = mesh.points[idx[2]];
+
+			plutovg_move_to(_PlutovgContext, base.x + p0.x, base.y + p0.y);
+			plutovg_line_to(_PlutovgContext, base.x + p1.x, base.y + p1.y);
+			plutovg_line_to(_PlutovgContext, base.x + p2.x, base.y + p2.y);
+			plutovg_close_path(_PlutovgContext);
+
+			BLRgba32 c(mesh.flatColors[t]);
+			plutovg_set_source_rgba(_PlutovgContext, u8ToUnit(c.r()), u8ToUnit(c.g()), u8ToUnit(c.b()), 1.0);
+			plutovg_fill(_PlutovgContext);
+		}
+	}
+}
+
+void PlutovgModule::onDoBatch(uint32_t mode) {
+	BLRect screen(0, 0, _params.screenW, _params.screenH);
+	uint32_t style = _params.style;
+
+	// All shapes form a single path filled by a single style.
+	setupStyle<BLRect>(style, screen);
+	plutovg_set_fill_rule(_PlutovgContext, plutovg_fill_rule_non_zero);
+	nextBatch(mode);
+
+	switch (mode) {
+		case kBenchBatchAlignedRect: {
+			for (const BLRectI& rect : _batch.rectsI)
+				plutovg_rect(_PlutovgContext, rect.x, rect.y, rect.w, rect.h);
+			break;
+		}
+
+		case kBenchBatchSmoothRect: {
+			for (const BLRect& rect : _batch.rects)
+				plutovg_rect(_PlutovgContext, rect.x, rect.y, rect.w, rect.h);
+			break;
+		}
+
+		case kBenchBatchPolygon: {
+			const BLPoint* p = _batch.points.data();
+			for (size_t i = 0, count = _batch.polygonCount(); i < count; i++, p += BenchBatch::kPolygonSize) {
+				plutovg_move_to(_PlutovgContext, p[0].x, p[0].y);
+				for (uint32_t j = 1; j < BenchBatch::kPolygonSize; j++)
+					plutovg_line_to(_PlutovgContext, p[j].x, p[j].y);
+				plutovg_close_path(_PlutovgContext);
+			}
+			break;
+		}
+	}
+
+	plutovg_fill(_PlutovgContext);
+}
+
+void PlutovgModule::onDoPaths(bool reuse) {
+	BLSizeI bounds(_params.screenW - _params.shapeSize,
+	               _params.screenH - _params.shapeSize);
+	BLRect screen(0, 0, _params.screenW, _params.screenH);
+	uint32_t style = _params.style;
+
+	if (reuse && _pathObjectsSize != _paths.size) {
+		for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+			const BLPoint* p = _paths.pathPoints(i);
+
+			if (_pathObjects[i])
+				plutovg_path_destroy(_pathObjects[i]);
+
+			plutovg_path_t* path = plutovg_path_create();
+			plutovg_path_move_to(path, p[0].x, p[0].y);
+			for (uint32_t j = 1; j < BenchPathSet::kPointCount; j += 3)
+				plutovg_path_cubic_to(path, p[j].x, p[j].y, p[j + 1].x, p[j + 1].y, p[j + 2].x, p[j + 2].y);
+			plutovg_path_close(path);
+			_pathObjects[i] = path;
+		}
+		_pathObjectsSize = _paths.size;
+	}
+
+	setupStyle<BLRect>(style, screen);
+	plutovg_set_fill_rule(_PlutovgContext, plutovg_fill_rule_non_zero);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLPoint base(_rndCoord.nextPoint(bounds));
+		uint32_t pathId = i % BenchPathSet::kPathCount;
+
+		plutovg_save(_PlutovgContext);
+		plutovg_translate(_PlutovgContext, base.x, base.y);
+
+		if (reuse) {
+			plutovg_add_path(_PlutovgContext, _pathObjects[pathId]);
+		}
+		else {
+			const BLPoint* p = _paths.pathPoints(pathId);
+			plutovg_move_to(_PlutovgContext, p[0].x, p[0].y);
+			for (uint32_t j = 1; j < BenchPathSet::kPointCount; j += 3)
+				plutovg_cubic_to(_PlutovgContext, p[j].x, p[j].y, p[j + 1].x, p[j + 1].y, p[j + 2].x, p[j + 2].y);
+			plutovg_close_path(_PlutovgContext);
+		}
+
+		plutovg_fill(_PlutovgContext);
+		plutovg_restore(_PlutovgContext);
+	}
+}
+
+void PlutovgModule::onDoStateChurn(uint32_t mode) {
+	BLSize bounds(_params.screenW, _params.screenH);
+	BLRect screen(0, 0, _params.screenW, _params.screenH);
+
+	uint32_t style = _params.style;
+	double wh = _params.shapeSize;
+
+	// Styles are created once and span the whole screen, setupStyle() sets the
+	// source, which is kept (solid colors are paints in PlutoVG as well).
+	plutovg_paint_t* paints[kBenchStateStyles];
+	for (uint32_t i = 0; i < kBenchStateStyles; i++) {
+		setupStyle<BLRect>(style, screen);
+		paints[i] = plutovg_paint_reference(plutovg_get_source(_PlutovgContext));
+	}
+
+	plutovg_set_fill_rule(_PlutovgContext, plutovg_fill_rule_non_zero);
+	plutovg_set_source(_PlutovgContext, paints[0]);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+
+		switch (mode) {
+			case kBenchStateNone: {
+				plutovg_rect(_PlutovgContext, rect.x, rect.y, rect.w, rect.h);
+				plutovg_fill(_PlutovgContext);
+				break;
+			}
+
+			case kBenchStateSave: {
+				uint32_t depth = 1 + i % kBenchStateMaxDepth;
+				for (uint32_t d = 0; d < depth; d++)
+					plutovg_save(_PlutovgContext);
+
+				plutovg_rect(_PlutovgContext, rect.x, rect.y, rect.w, rect.h);
+				plutovg_fill(_PlutovgContext);
+
+				for (uint32_t d = 0; d < depth; d++)
+					plutovg_restore(_PlutovgContext);
+				break;
+			}
+
+			case kBenchStateStyle: {
+				plutovg_set_source(_PlutovgContext, paints[i % kBenchStateStyles]);
+				plutovg_rect(_PlutovgContext, rect.x, rect.y, rect.w, rect.h);
+				plutovg_fill(_PlutovgContext);
+				break;
+			}
+
+			case kBenchStateTransform: {
+				plutovg_save(_PlutovgContext);
+				plutovg_translate(_PlutovgContext, rect.x, rect.y);
+				plutovg_rect(_PlutovgContext, 0, 0, rect.w, rect.h);
+				plutovg_fill(_PlutovgContext);
+				plutovg_restore(_PlutovgContext);
+				break;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < kBenchStateStyles; i++)
+		plutovg_paint_destroy(paints[i]);
+}
+
 } // {blbench}
 
 // #endif // BLBENCH_ENABLE_Plutovg
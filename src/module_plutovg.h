@@ -35,6 +35,11 @@ struct PlutovgModule : public BenchModule {
 	plutovg_surface_t* _PlutovgSurface;
 	plutovg_surface_t* _PlutovgSprites[kBenchNumSprites];
 	plutovg_t* _PlutovgContext;
+
+	//! Path objects of `_paths` reused by `onDoPaths()`, built for the shape
+	//! size `_pathObjectsSize` (0 if not built yet).
+	plutovg_path_t* _pathObjects[BenchPathSet::kPathCount];
+	uint32_t _pathObjectsSize;
 	
 	// --------------------------------------------------------------------------
 	// [Construction / Destruction]
@@ -52,6 +57,7 @@ struct PlutovgModule : public BenchModule {
 
 	virtual bool supportsCompOp(uint32_t compOp) const;
 	virtual bool supportsStyle(uint32_t style) const;
+	virtual bool supportsFormat(uint32_t format) const;
 
 	virtual void onBeforeRun();
 	virtual void onAfterRun();
@@ -63,6 +69,12 @@ struct PlutovgModule : public BenchModule {
 	virtual void onDoRoundRotated(bool stroke);
 	virtual void onDoPolygon(uint32_t mode, uint32_t complexity);
 	virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count);
+	virtual void onDoHairline(uint32_t mode);
+	virtual void onDoMaskedFill();
+	virtual void onDoGouraudMesh();
+	virtual void onDoBatch(uint32_t mode);
+	virtual void onDoPaths(bool reuse);
+	virtual void onDoStateChurn(uint32_t mode);
 };
 
 } // {blbench}
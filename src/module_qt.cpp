@@ -36,6 +36,7 @@ uint32_t QtUtil::toQtFormat(uint32_t format) {
   switch (format) {
     case BL_FORMAT_PRGB32: return QImage::Format_ARGB32_Premultiplied;
     case BL_FORMAT_XRGB32: return QImage::Format_RGB32;
+    case BL_FORMAT_A8    : return QImage::Format_Alpha8;
 
     default:
       return 0xFFFFFFFFu;
@@ -147,6 +148,7 @@ QtModule::QtModule() {
   _qtSurface = NULL;
   _qtContext = NULL;
   memset(_qtSprites, 0, sizeof(_qtSprites));
+  _pathObjectsSize = 0;
 }
 QtModule::~QtModule() {}
 
@@ -171,6 +173,10 @@ bool QtModule::supportsStyle(uint32_t style) const {
          style == kBenchStylePatternBI      ;
 }
 
+bool QtModule::supportsFormat(uint32_t format) const {
+  return QtUtil::toQtFormat(format) != 0xFFFFFFFFu;
+}
+
 void QtModule::onBeforeRun() {
   int w = int(_params.screenW);
   int h = int(_params.screenH);
@@ -194,7 +200,7 @@ void QtModule::onBeforeRun() {
 
   // Initialize the surface and the context.
   BLImageData surfaceData;
-  _surface.create(w, h, _params.format);
+  createSurface();
   _surface.makeMutable(&surfaceData);
 
   int stride = int(surfaceData.stride);
@@ -595,6 +601,269 @@ void QtModule::onDoShape(bool stroke, const BLPoint* pts, size_t count) {
   }
 }
 
+void QtModule::onDoHairline(uint32_t mode) {
+  uint32_t style = _params.style;
+  BenchHairline hairline;
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    nextHairline(hairline, mode);
+
+    QPainterPath path;
+    for (uint32_t p = 0; p < hairline.polyCount; p++) {
+      const BLPoint* pts = hairline.points + p * hairline.polySize;
+      path.moveTo(pts[0].x, pts[0].y);
+      for (uint32_t j = 1; j < hairline.polySize; j++)
+        path.lineTo(pts[j].x, pts[j].y);
+    }
+
+    // Zero width makes a cosmetic pen, which Qt strokes as a hairline.
+    if (style == kBenchStyleSolid) {
+      QColor color(QtUtil::toQColor(_rndColor.nextRgba32()));
+      _qtContext->strokePath(path, QPen(color, qreal(0)));
+    }
+    else {
+      QBrush brush(setupStyle<BLRect>(style, hairline.bounds));
+      _qtContext->strokePath(path, QPen(brush, qreal(0)));
+    }
+  }
+}
+
+void QtModule::onDoMaskedFill() {
+  BLSize bounds(_params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+  double wh = _params.shapeSize;
+
+  BLImageData maskData;
+  _mask.getData(&maskData);
+
+  QImage mask(
+    static_cast<unsigned char*>(maskData.pixelData), maskData.size.w, maskData.size.h,
+    int(maskData.stride), QImage::Format_ARGB32_Premultiplied);
+
+  // There is no soft mask in Qt, each shape is rendered into a layer that is
+  // large enough for any shape, multiplied by the mask, and drawn.
+  int layerSize = int(wh) + 2;
+  QImage layer(layerSize, layerSize, QImage::Format_ARGB32_Premultiplied);
+  QPainter layerContext;
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+    double radius = _rndExtra.nextDouble(4.0, 40.0);
+
+    int x0 = int(rect.x);
+    int y0 = int(rect.y);
+
+    layer.fill(Qt::transparent);
+    layerContext.begin(&layer);
+    layerContext.setRenderHint(QPainter::Antialiasing, true);
+    layerContext.setRenderHint(QPainter::SmoothPixmapTransform, style != kBenchStylePatternNN);
+    layerContext.translate(qreal(-x0), qreal(-y0));
+    layerContext.setPen(QPen(Qt::NoPen));
+
+    if (style == kBenchStyleSolid)
+      layerContext.setBrush(QBrush(QtUtil::toQColor(_rndColor.nextRgba32())));
+    else
+      layerContext.setBrush(setupStyle<BLRect>(style, rect));
+
+    layerContext.drawRoundedRect(
+      QRectF(rect.x, rect.y, rect.w, rect.h),
+      std::min(rect.w * 0.5, radius),
+      std::min(rect.h * 0.5, radius));
+
+    layerContext.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    layerContext.drawImage(QPoint(x0, y0), mask, QRect(x0, y0, layerSize, layerSize));
+    layerContext.end();
+
+    _qtContext->drawImage(QPoint(x0, y0), layer);
+  }
+}
+
+void QtModule::onDoGouraudMesh() {
+  const BenchMesh& mesh = _mesh;
+  BLSizeI bounds(_params.screenW - mesh.size, _params.screenH - mesh.size);
+  uint32_t triangleCount = mesh.triangleCount();
+
+  // There is no per-vertex color in QPainter, triangles are flat shaded.
+  _qtContext->setPen(QPen(Qt::NoPen));
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      uint32_t idx[3];
+      mesh.triangle(t, idx);
+
+      QPointF points[3];
+      for (uint32_t j = 0; j < 3; j++)
+        points[j] = QPointF(base.x + mesh.points[idx[j]].x, base.y + mesh.points[idx[j]].y);
+
+      _qtContext->setBrush(QBrush(QtUtil::toQColor(mesh.flatColors[t])));
+      _qtContext->drawConvexPolygon(points, 3);
+    }
+  }
+}
+
+void QtModule::onDoBatch(uint32_t mode) {
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  // Rectangles are drawn by a single drawRects() call, polygons form a single
+  // path. All shapes are filled by the same brush spanning the whole screen.
+  if (style == kBenchStyleSolid)
+    _qtContext->setBrush(QBrush(QtUtil::toQColor(_rndColor.nextRgba32())));
+  else
+    _qtContext->setBrush(setupStyle<BLRect>(style, screen));
+
+  _qtContext->setPen(QPen(Qt::NoPen));
+  nextBatch(mode);
+
+  switch (mode) {
+    case kBenchBatchAlignedRect: {
+      std::vector<QRect> rects(_batch.rectsI.size());
+      for (size_t i = 0; i < rects.size(); i++) {
+        const BLRectI& rect = _batch.rectsI[i];
+        rects[i] = QRect(rect.x, rect.y, rect.w, rect.h);
+      }
+      _qtContext->drawRects(rects.data(), int(rects.size()));
+      break;
+    }
+
+    case kBenchBatchSmoothRect: {
+      std::vector<QRectF> rects(_batch.rects.size());
+      for (size_t i = 0; i < rects.size(); i++) {
+        const BLRect& rect = _batch.rects[i];
+        rects[i] = QRectF(rect.x, rect.y, rect.w, rect.h);
+      }
+      _qtContext->drawRects(rects.data(), int(rects.size()));
+      break;
+    }
+
+    case kBenchBatchPolygon: {
+      QPainterPath path;
+      path.setFillRule(Qt::WindingFill);
+
+      const BLPoint* p = _batch.points.data();
+      for (size_t i = 0, count = _batch.polygonCount(); i < count; i++, p += BenchBatch::kPolygonSize) {
+        path.moveTo(p[0].x, p[0].y);
+        for (uint32_t j = 1; j < BenchBatch::kPolygonSize; j++)
+          path.lineTo(p[j].x, p[j].y);
+        path.closeSubpath();
+      }
+
+      _qtContext->drawPath(path);
+      break;
+    }
+  }
+}
+
+static void QtModule_buildPath(QPainterPath& path, const BLPoint* p) {
+  path.moveTo(p[0].x, p[0].y);
+  for (uint32_t i = 1; i < BenchPathSet::kPointCount; i += 3)
+    path.cubicTo(p[i].x, p[i].y, p[i + 1].x, p[i + 1].y, p[i + 2].x, p[i + 2].y);
+  path.closeSubpath();
+}
+
+void QtModule::onDoPaths(bool reuse) {
+  BLSizeI bounds(_params.screenW - _params.shapeSize,
+                 _params.screenH - _params.shapeSize);
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+  uint32_t style = _params.style;
+
+  if (reuse && _pathObjectsSize != _paths.size) {
+    for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+      _pathObjects[i] = QPainterPath();
+      _pathObjects[i].setFillRule(Qt::WindingFill);
+      QtModule_buildPath(_pathObjects[i], _paths.pathPoints(i));
+    }
+    _pathObjectsSize = _paths.size;
+  }
+
+  if (style == kBenchStyleSolid)
+    _qtContext->setBrush(QBrush(QtUtil::toQColor(_rndColor.nextRgba32())));
+  else
+    _qtContext->setBrush(setupStyle<BLRect>(style, screen));
+
+  _qtContext->setPen(QPen(Qt::NoPen));
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLPoint base(_rndCoord.nextPoint(bounds));
+    uint32_t pathId = i % BenchPathSet::kPathCount;
+
+    _qtContext->save();
+    _qtContext->translate(qreal(base.x), qreal(base.y));
+
+    if (reuse) {
+      _qtContext->drawPath(_pathObjects[pathId]);
+    }
+    else {
+      QPainterPath path;
+      path.setFillRule(Qt::WindingFill);
+      QtModule_buildPath(path, _paths.pathPoints(pathId));
+      _qtContext->drawPath(path);
+    }
+
+    _qtContext->restore();
+  }
+}
+
+void QtModule::onDoStateChurn(uint32_t mode) {
+  BLSize bounds(_params.screenW, _params.screenH);
+  BLRect screen(0, 0, _params.screenW, _params.screenH);
+
+  uint32_t style = _params.style;
+  double wh = _params.shapeSize;
+
+  // Styles are created once and span the whole screen, fills use the brush
+  // of the painter so selecting a style is a state change.
+  QBrush brushes[kBenchStateStyles];
+  for (uint32_t i = 0; i < kBenchStateStyles; i++) {
+    if (style == kBenchStyleSolid)
+      brushes[i] = QBrush(QtUtil::toQColor(_rndColor.nextRgba32()));
+    else
+      brushes[i] = setupStyle<BLRect>(style, screen);
+  }
+
+  _qtContext->setPen(QPen(Qt::NoPen));
+  _qtContext->setBrush(brushes[0]);
+
+  for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+    BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+
+    switch (mode) {
+      case kBenchStateNone: {
+        _qtContext->drawRect(QRectF(rect.x, rect.y, rect.w, rect.h));
+        break;
+      }
+
+      case kBenchStateSave: {
+        uint32_t depth = 1 + i % kBenchStateMaxDepth;
+        for (uint32_t d = 0; d < depth; d++)
+          _qtContext->save();
+
+        _qtContext->drawRect(QRectF(rect.x, rect.y, rect.w, rect.h));
+
+        for (uint32_t d = 0; d < depth; d++)
+          _qtContext->restore();
+        break;
+      }
+
+      case kBenchStateStyle: {
+        _qtContext->setBrush(brushes[i % kBenchStateStyles]);
+        _qtContext->drawRect(QRectF(rect.x, rect.y, rect.w, rect.h));
+        break;
+      }
+
+      case kBenchStateTransform: {
+        _qtContext->save();
+        _qtContext->translate(qreal(rect.x), qreal(rect.y));
+        _qtContext->drawRect(QRectF(0, 0, rect.w, rect.h));
+        _qtContext->restore();
+        break;
+      }
+    }
+  }
+}
+
 } // {blbench}
 
 #endif // BLBENCH_ENABLE_QT
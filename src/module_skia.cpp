@@ -27,6 +27,7 @@
 #include "./module_skia.h"
 #include <skia/core/SkBlendMode.h>
 #include <skia/core/SkImage.h>
+#include <skia/core/SkVertices.h>
 #include <skia/effects/SkGradientShader.h>
 
 #include <algorithm>
@@ -48,9 +49,12 @@ static SkColorType toSkiaFormat(uint32_t format, SkAlphaType* at) {
 			//printf("SkColorType::kRGBA_8888_SkColorType\n");
 			return SkColorType::kRGBA_8888_SkColorType;
 		case BL_FORMAT_XRGB32:
-			*at = kUnpremul_SkAlphaType;
+			*at = kOpaque_SkAlphaType;
 			//printf("SkColorType::kRGB_888x_SkColorType\n");
 			return SkColorType::kRGB_888x_SkColorType;
+		case BL_FORMAT_A8:
+			*at = kPremul_SkAlphaType;
+			return SkColorType::kAlpha_8_SkColorType;
 		default:
 			return SkColorType::kUnknown_SkColorType;
 	}
@@ -75,6 +79,7 @@ SkiaModule::SkiaModule() {
 	strcpy(_name, "Skia");
 	_SkiaContext = nullptr;
 	memset(_SkiaSprites, 0, sizeof(_SkiaSprites));
+	_pathObjectsSize = 0;
 }
 SkiaModule::~SkiaModule() {}
 
@@ -207,6 +212,11 @@ bool SkiaModule::supportsStyle(uint32_t style) const {
 					style == kBenchStylePatternBI      ;
 }
 
+bool SkiaModule::supportsFormat(uint32_t format) const {
+	SkAlphaType alpha;
+	return toSkiaFormat(format, &alpha) != SkColorType::kUnknown_SkColorType;
+}
+
 void SkiaModule::onBeforeRun() {
 	int w = int(_params.screenW);
 	int h = int(_params.screenH);
@@ -239,7 +249,7 @@ void SkiaModule::onBeforeRun() {
 	// Initialize the surface and the context.
 	{
 		BLImageData surfaceData;
-		_surface.create(w, h, _params.format);
+		createSurface();
 		_surface.makeMutable(&surfaceData);
 
 		int stride = int(surfaceData.stride);
@@ -474,6 +484,274 @@ void SkiaModule::onDoShape(bool stroke, const BLPoint* pts, size_t count) {//pri
 	PRINTF("\n");
 }
 
+void SkiaModule::onDoHairline(uint32_t mode) {
+	uint32_t style = _params.style;
+	BenchHairline hairline;
+
+	// Zero width selects Skia's dedicated hairline renderer.
+	_Paint.setStrokeWidth(0);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		nextHairline(hairline, mode);
+
+		SkPath path;
+		for (uint32_t p = 0; p < hairline.polyCount; p++) {
+			const BLPoint* pts = hairline.points + p * hairline.polySize;
+			path.moveTo(pts[0].x, pts[0].y);
+			for (uint32_t j = 1; j < hairline.polySize; j++)
+				path.lineTo(pts[j].x, pts[j].y);
+		}
+
+		if (setupStyle<BLRect>(style, hairline.bounds, true))
+			_SkiaContext->drawPath(path, _Paint);
+	}
+
+	_Paint.setStrokeWidth(_params.strokeWidth);
+}
+
+void SkiaModule::onDoMaskedFill() {
+	BLSize bounds(_params.screenW, _params.screenH);
+	uint32_t style = _params.style;
+
+	double wh = _params.shapeSize;
+
+	BLImageData maskData;
+	_mask.getData(&maskData);
+
+	SkAlphaType maskAlpha;
+	SkColorType maskFormat = toSkiaFormat(maskData.format, &maskAlpha);
+
+	SkBitmap maskBitmap;
+	maskBitmap.installPixels(SkImageInfo::Make(maskData.size.w, maskData.size.h, maskFormat, maskAlpha), maskData.pixelData, maskData.stride);
+	sk_sp<SkImage> mask = SkImage::MakeFromBitmap(maskBitmap);
+
+	// There is no soft mask in Skia, each shape is rendered into a layer that
+	// is multiplied by the mask (kDstIn) and composited by restore().
+	SkPaint layerPaint;
+	layerPaint.setBlendMode(toSkiaOperator(_params.compOp));
+
+	SkPaint maskPaint;
+	maskPaint.setBlendMode(SkBlendMode::kDstIn);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+		double radius = _rndExtra.nextDouble(4.0, 40.0);
+
+		SkRect skRect = SkRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h);
+		_SkiaContext->saveLayer(&skRect, &layerPaint);
+
+		if (setupStyle<BLRect>(style, rect, false, radius)) {
+			SkRRect rrect = SkRRect::MakeRectXY(skRect, radius, radius);
+			_SkiaContext->drawRRect(rrect, _Paint);
+		}
+
+		_SkiaContext->drawImageRect(mask.get(), skRect, skRect, SkSamplingOptions(), &maskPaint, SkCanvas::kFast_SrcRectConstraint);
+		_SkiaContext->restore();
+	}
+}
+
+void SkiaModule::onDoGouraudMesh() {
+	const BenchMesh& mesh = _mesh;
+	BLSizeI bounds(_params.screenW - mesh.size, _params.screenH - mesh.size);
+	uint32_t triangleCount = mesh.triangleCount();
+
+	// Vertices are built once and translated for each instance. The mesh has
+	// at most 33 * 33 points, so 16-bit indexes are enough.
+	std::vector<SkPoint> positions(mesh.points.size());
+	std::vector<SkColor> colors(mesh.colors.size());
+	std::vector<uint16_t> indexes(triangleCount * 3);
+
+	for (size_t i = 0; i < mesh.points.size(); i++) {
+		positions[i] = SkPoint::Make(SkScalar(mesh.points[i].x), SkScalar(mesh.points[i].y));
+		colors[i] = SkColor(mesh.colors[i].value);
+	}
+
+	for (uint32_t t = 0; t < triangleCount; t++) {
+		uint32_t idx[3];
+		mesh.triangle(t, idx);
+		for (uint32_t j = 0; j < 3; j++)
+			indexes[t * 3 + j] = uint16_t(idx[j]);
+	}
+
+	sk_sp<SkVertices> vertices = SkVertices::MakeCopy(
+		SkVertices::kTriangles_VertexMode, int(positions.size()), positions.data(), nullptr, colors.data(),
+		int(indexes.size()), indexes.data());
+
+	// Without a shader kDst keeps the interpolated vertex colors.
+	_Paint.setShader(nullptr);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLPoint base(_rndCoord.nextPoint(bounds));
+
+		_SkiaContext->save();
+		_SkiaContext->translate(SkScalar(base.x), SkScalar(base.y));
+		_SkiaContext->drawVertices(vertices, SkBlendMode::kDst, _Paint);
+		_SkiaContext->restore();
+	}
+}
+
+// Sets up `_Paint` to fill by a style spanning the whole screen, patterns are
+// repeated as the screen is larger than a sprite.
+static void SkiaModule_setupScreenStyle(SkiaModule* self, uint32_t style) {
+	BLRect screen(0, 0, self->_params.screenW, self->_params.screenH);
+
+	if (style == kBenchStylePatternNN || style == kBenchStylePatternBI) {
+		SkFilterMode filter = style == kBenchStylePatternNN ? SkFilterMode::kNearest : SkFilterMode::kLinear;
+		self->_Paint.setStyle(SkPaint::kFill_Style);
+		self->_Paint.setShader(self->_SkiaSprites[self->nextSpriteId()]->makeShader(
+			SkTileMode::kRepeat, SkTileMode::kRepeat, SkSamplingOptions(filter, SkMipmapMode::kNone)));
+	}
+	else {
+		self->setupStyle<BLRect>(style, screen, false);
+	}
+}
+
+void SkiaModule::onDoBatch(uint32_t mode) {
+	uint32_t style = _params.style;
+
+	// SkCanvas has no call that draws an array of rectangles, all shapes form
+	// a single path filled by a single paint spanning the whole screen.
+	SkiaModule_setupScreenStyle(this, style);
+	nextBatch(mode);
+
+	SkPath path;
+	path.setFillType(SkPathFillType::kWinding);
+
+	switch (mode) {
+		case kBenchBatchAlignedRect: {
+			for (const BLRectI& rect : _batch.rectsI)
+				path.addRect(SkRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h));
+			break;
+		}
+
+		case kBenchBatchSmoothRect: {
+			for (const BLRect& rect : _batch.rects)
+				path.addRect(SkRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h));
+			break;
+		}
+
+		case kBenchBatchPolygon: {
+			const BLPoint* p = _batch.points.data();
+			for (size_t i = 0, count = _batch.polygonCount(); i < count; i++, p += BenchBatch::kPolygonSize) {
+				path.moveTo(SkScalar(p[0].x), SkScalar(p[0].y));
+				for (uint32_t j = 1; j < BenchBatch::kPolygonSize; j++)
+					path.lineTo(SkScalar(p[j].x), SkScalar(p[j].y));
+				path.close();
+			}
+			break;
+		}
+	}
+
+	_SkiaContext->drawPath(path, _Paint);
+}
+
+static void SkiaModule_buildPath(SkPath& path, const BLPoint* p) {
+	path.moveTo(SkScalar(p[0].x), SkScalar(p[0].y));
+	for (uint32_t i = 1; i < BenchPathSet::kPointCount; i += 3)
+		path.cubicTo(SkScalar(p[i].x), SkScalar(p[i].y), SkScalar(p[i + 1].x), SkScalar(p[i + 1].y), SkScalar(p[i + 2].x), SkScalar(p[i + 2].y));
+	path.close();
+}
+
+void SkiaModule::onDoPaths(bool reuse) {
+	BLSizeI bounds(_params.screenW - _params.shapeSize,
+	               _params.screenH - _params.shapeSize);
+	uint32_t style = _params.style;
+
+	if (reuse && _pathObjectsSize != _paths.size) {
+		for (uint32_t i = 0; i < BenchPathSet::kPathCount; i++) {
+			_pathObjects[i].reset();
+			_pathObjects[i].setFillType(SkPathFillType::kWinding);
+			SkiaModule_buildPath(_pathObjects[i], _paths.pathPoints(i));
+		}
+		_pathObjectsSize = _paths.size;
+	}
+
+	SkiaModule_setupScreenStyle(this, style);
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLPoint base(_rndCoord.nextPoint(bounds));
+		uint32_t pathId = i % BenchPathSet::kPathCount;
+
+		_SkiaContext->save();
+		_SkiaContext->translate(SkScalar(base.x), SkScalar(base.y));
+
+		if (reuse) {
+			_SkiaContext->drawPath(_pathObjects[pathId], _Paint);
+		}
+		else {
+			SkPath path;
+			path.setFillType(SkPathFillType::kWinding);
+			SkiaModule_buildPath(path, _paths.pathPoints(pathId));
+			_SkiaContext->drawPath(path, _Paint);
+		}
+
+		_SkiaContext->restore();
+	}
+}
+
+void SkiaModule::onDoStateChurn(uint32_t mode) {
+	BLSize bounds(_params.screenW, _params.screenH);
+	BLRect screen(0, 0, _params.screenW, _params.screenH);
+
+	uint32_t style = _params.style;
+	double wh = _params.shapeSize;
+
+	// Styles are created once and span the whole screen. Skia keeps styles in
+	// paints instead of the canvas, selecting a style means passing another
+	// paint, save/restore only covers the matrix and the clip.
+	SkPaint paints[kBenchStateStyles];
+	for (uint32_t i = 0; i < kBenchStateStyles; i++) {
+		if (style == kBenchStylePatternNN || style == kBenchStylePatternBI) {
+			SkFilterMode filter = style == kBenchStylePatternNN ? SkFilterMode::kNearest : SkFilterMode::kLinear;
+			paints[i] = _Paint;
+			paints[i].setStyle(SkPaint::kFill_Style);
+			paints[i].setShader(_SkiaSprites[i % kBenchNumSprites]->makeShader(
+				SkTileMode::kRepeat, SkTileMode::kRepeat, SkSamplingOptions(filter, SkMipmapMode::kNone)));
+		}
+		else {
+			setupStyle<BLRect>(style, screen, false);
+			paints[i] = _Paint;
+		}
+	}
+
+	for (uint32_t i = 0, quantity = _params.quantity; i < quantity; i++) {
+		BLRect rect(_rndCoord.nextRect(bounds, wh, wh));
+		SkRect skRect(SkRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h));
+
+		switch (mode) {
+			case kBenchStateNone: {
+				_SkiaContext->drawRect(skRect, paints[0]);
+				break;
+			}
+
+			case kBenchStateSave: {
+				uint32_t depth = 1 + i % kBenchStateMaxDepth;
+				for (uint32_t d = 0; d < depth; d++)
+					_SkiaContext->save();
+
+				_SkiaContext->drawRect(skRect, paints[0]);
+
+				for (uint32_t d = 0; d < depth; d++)
+					_SkiaContext->restore();
+				break;
+			}
+
+			case kBenchStateStyle: {
+				_SkiaContext->drawRect(skRect, paints[i % kBenchStateStyles]);
+				break;
+			}
+
+			case kBenchStateTransform: {
+				_SkiaContext->save();
+				_SkiaContext->translate(SkScalar(rect.x), SkScalar(rect.y));
+				_SkiaContext->drawRect(SkRect::MakeWH(rect.w, rect.h), paints[0]);
+				_SkiaContext->restore();
+				break;
+			}
+		}
+	}
+}
+
 } // {blbench}
 
 // #endif // BLBENCH_ENABLE_SKIA
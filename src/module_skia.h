@@ -40,6 +40,11 @@ struct SkiaModule : public BenchModule {
 	SkCanvas* _SkiaContext;
 	SkPaint  _Paint;
 
+	//! Path objects of `_paths` reused by `onDoPaths()`, built for the shape
+	//! size `_pathObjectsSize` (0 if not built yet).
+	SkPath _pathObjects[BenchPathSet::kPathCount];
+	uint32_t _pathObjectsSize;
+
 	// --------------------------------------------------------------------------
 	// [Construction / Destruction]
 	// --------------------------------------------------------------------------
@@ -56,6 +61,7 @@ struct SkiaModule : public BenchModule {
 
 	virtual bool supportsCompOp(uint32_t compOp) const;
 	virtual bool supportsStyle(uint32_t style) const;
+	virtual bool supportsFormat(uint32_t format) const;
 
 	virtual void onBeforeRun();
 	virtual void onAfterRun();
@@ -67,6 +73,12 @@ struct SkiaModule : public BenchModule {
 	virtual void onDoRoundRotated(bool stroke);
 	virtual void onDoPolygon(uint32_t mode, uint32_t complexity);
 	virtual void onDoShape(bool stroke, const BLPoint* pts, size_t count);
+	virtual void onDoHairline(uint32_t mode);
+	virtual void onDoMaskedFill();
+	virtual void onDoGouraudMesh();
+	virtual void onDoBatch(uint32_t mode);
+	virtual void onDoPaths(bool reuse);
+	virtual void onDoStateChurn(uint32_t mode);
 };
 
 } // {blbench}
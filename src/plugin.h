@@ -0,0 +1,109 @@
+// Blend2D - 2D Vector Graphics Powered by a JIT Compiler
+//
+//  * Official Blend2D Home Page: https://blend2d.com
+//  * Official Github Repository: https://github.com/blend2d/blend2d
+//
+// Copyright (c) 2017-2020 The Blend2D Authors
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef BLBENCH_PLUGIN_H
+#define BLBENCH_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// [bench::Plugin]
+// ============================================================================
+
+//! Interface between `bl_bench` and a module built as a shared library.
+//!
+//! Each plugin links its own copy of the library it benchmarks (and of the
+//! module code), so only plain C types cross the boundary. A plugin exports
+//! `blbench_plugin_query()`, which returns `BenchPluginApi`.
+
+//! Version of `BenchPluginApi`, plugins of other versions are refused.
+#define BLBENCH_PLUGIN_VERSION 1
+//! Name of the exported `BenchPluginQueryFunc`.
+#define BLBENCH_PLUGIN_QUERY "blbench_plugin_query"
+
+#define BLBENCH_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+
+extern "C" {
+
+//! Parameters of a run, the same as `BenchParams`.
+struct BenchPluginParams {
+  uint32_t screenW;
+  uint32_t screenH;
+  uint32_t format;
+  uint32_t quantity;
+  uint32_t benchId;
+  uint32_t compOp;
+  uint32_t style;
+  uint32_t shapeSize;
+  double strokeWidth;
+  uint32_t surfaceMemory;
+  int32_t surfaceNode;
+  uint32_t surfacePadding;
+};
+
+//! Measured times of a run in microseconds.
+struct BenchPluginResult {
+  uint64_t duration;
+  uint64_t submitDuration;
+  uint64_t flushDuration;
+};
+
+//! Surface rendered by the last run, valid until the next run.
+struct BenchPluginSurface {
+  void* pixelData;
+  intptr_t stride;
+  uint32_t w;
+  uint32_t h;
+  uint32_t format;
+};
+
+struct BenchPluginApi {
+  //! Must be `BLBENCH_PLUGIN_VERSION`.
+  uint32_t version;
+  //! Number of modules (configurations) the plugin provides.
+  uint32_t moduleCount;
+
+  //! Describes the library built into the plugin (name and version).
+  const char* (*library)(void);
+
+  void* (*create)(uint32_t moduleIndex);
+  void (*destroy)(void* module);
+  const char* (*name)(void* module);
+
+  int (*supportsCompOp)(void* module, uint32_t compOp);
+  int (*supportsStyle)(void* module, uint32_t style);
+  int (*supportsFormat)(void* module, uint32_t format);
+
+  void (*run)(void* module, const BenchPluginParams* params, BenchPluginResult* result);
+  void (*surface)(void* module, BenchPluginSurface* surface);
+
+  void (*resetStats)(void* module);
+  void (*printStats)(void* module);
+};
+
+typedef const BenchPluginApi* (*BenchPluginQueryFunc)(void);
+
+} // extern "C"
+
+#endif // BLBENCH_PLUGIN_H
@@ -0,0 +1,170 @@
+// Blend2D - 2D Vector Graphics Powered by a JIT Compiler
+//
+//  * Official Blend2D Home Page: https://blend2d.com
+//  * Official Github Repository: https://github.com/blend2d/blend2d
+//
+// Copyright (c) 2017-2020 The Blend2D Authors
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+// A plugin with the Blend2D module, see `plugin.h`. Built once per Blend2D
+// build to compare them in a single process (--ab=A,B).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "./images_data.h"
+#include "./module_blend2d.h"
+#include "./plugin.h"
+
+namespace blbench {
+
+// ============================================================================
+// [bench::Blend2DPlugin]
+// ============================================================================
+
+// The same configurations as the built-in Blend2D modules.
+static const uint32_t blend2dPluginThreadCounts[] = { 0, 2, 4 };
+
+struct Blend2DPluginModule {
+  Blend2DModule module;
+  BLImage sprites[kBenchNumSprites];
+
+  explicit Blend2DPluginModule(uint32_t threadCount)
+    : module(threadCount) {}
+};
+
+static const char* Blend2DPlugin_library(void) {
+  static char info[128];
+
+  BLRuntimeBuildInfo buildInfo;
+  BLRuntime::queryBuildInfo(&buildInfo);
+
+  snprintf(info, sizeof(info), "Blend2D %u.%u.%u (%s)",
+    buildInfo.majorVersion,
+    buildInfo.minorVersion,
+    buildInfo.patchVersion,
+    buildInfo.buildType == BL_RUNTIME_BUILD_TYPE_DEBUG ? "Debug" : "Release");
+  return info;
+}
+
+static void* Blend2DPlugin_create(uint32_t moduleIndex) {
+  if (moduleIndex >= sizeof(blend2dPluginThreadCounts) / sizeof(blend2dPluginThreadCounts[0]))
+    return nullptr;
+
+  // Sprites are decoded by the Blend2D of the plugin, images can't be shared
+  // with `bl_bench` as it may link a different Blend2D.
+  Blend2DPluginModule* self = new Blend2DPluginModule(blend2dPluginThreadCounts[moduleIndex]);
+  if (self->sprites[0].readFromData(_resource_babelfish_png, sizeof(_resource_babelfish_png)) != BL_SUCCESS ||
+      self->sprites[1].readFromData(_resource_ksplash_png  , sizeof(_resource_ksplash_png  )) != BL_SUCCESS ||
+      self->sprites[2].readFromData(_resource_ktip_png     , sizeof(_resource_ktip_png     )) != BL_SUCCESS ||
+      self->sprites[3].readFromData(_resource_firewall_png , sizeof(_resource_firewall_png )) != BL_SUCCESS) {
+    delete self;
+    return nullptr;
+  }
+
+  return self;
+}
+
+static void Blend2DPlugin_destroy(void* module) {
+  delete static_cast<Blend2DPluginModule*>(module);
+}
+
+static const char* Blend2DPlugin_name(void* module) {
+  return static_cast<Blend2DPluginModule*>(module)->module._name;
+}
+
+static int Blend2DPlugin_supportsCompOp(void* module, uint32_t compOp) {
+  return static_cast<Blend2DPluginModule*>(module)->module.supportsCompOp(compOp);
+}
+
+static int Blend2DPlugin_supportsStyle(void* module, uint32_t style) {
+  return static_cast<Blend2DPluginModule*>(module)->module.supportsStyle(style);
+}
+
+static int Blend2DPlugin_supportsFormat(void* module, uint32_t format) {
+  return static_cast<Blend2DPluginModule*>(module)->module.supportsFormat(format);
+}
+
+static void Blend2DPlugin_run(void* module, const BenchPluginParams* pluginParams, BenchPluginResult* result) {
+  Blend2DPluginModule* self = static_cast<Blend2DPluginModule*>(module);
+
+  BenchParams params;
+  memset(&params, 0, sizeof(params));
+
+  params.screenW = pluginParams->screenW;
+  params.screenH = pluginParams->screenH;
+  params.format = BLFormat(pluginParams->format);
+  params.quantity = pluginParams->quantity;
+  params.benchId = pluginParams->benchId;
+  params.compOp = BLCompOp(pluginParams->compOp);
+  params.style = pluginParams->style;
+  params.shapeSize = pluginParams->shapeSize;
+  params.strokeWidth = pluginParams->strokeWidth;
+  params.surfaceMemory = pluginParams->surfaceMemory;
+  params.surfaceNode = pluginParams->surfaceNode;
+  params.surfacePadding = pluginParams->surfacePadding;
+
+  self->module.run(self->sprites, params);
+
+  result->duration = self->module._duration;
+  result->submitDuration = self->module._submitDuration;
+  result->flushDuration = self->module._flushDuration;
+}
+
+static void Blend2DPlugin_surface(void* module, BenchPluginSurface* surface) {
+  BLImageData data;
+  static_cast<Blend2DPluginModule*>(module)->module._surface.getData(&data);
+
+  surface->pixelData = data.pixelData;
+  surface->stride = data.stride;
+  surface->w = uint32_t(data.size.w);
+  surface->h = uint32_t(data.size.h);
+  surface->format = data.format;
+}
+
+static void Blend2DPlugin_resetStats(void* module) {
+  static_cast<Blend2DPluginModule*>(module)->module.resetStats();
+}
+
+static void Blend2DPlugin_printStats(void* module) {
+  static_cast<Blend2DPluginModule*>(module)->module.printStats();
+}
+
+} // {blbench}
+
+BLBENCH_PLUGIN_EXPORT const BenchPluginApi* blbench_plugin_query(void) {
+  using namespace blbench;
+
+  static const BenchPluginApi api = {
+    BLBENCH_PLUGIN_VERSION,
+    uint32_t(sizeof(blend2dPluginThreadCounts) / sizeof(blend2dPluginThreadCounts[0])),
+    Blend2DPlugin_library,
+    Blend2DPlugin_create,
+    Blend2DPlugin_destroy,
+    Blend2DPlugin_name,
+    Blend2DPlugin_supportsCompOp,
+    Blend2DPlugin_supportsStyle,
+    Blend2DPlugin_supportsFormat,
+    Blend2DPlugin_run,
+    Blend2DPlugin_surface,
+    Blend2DPlugin_resetStats,
+    Blend2DPlugin_printStats
+  };
+  return &api;
+}